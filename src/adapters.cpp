@@ -0,0 +1,184 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Input adapters bind parameter types GetParameterInfo doesn't know about -- numpy scalars, uuid.UUID, and types
+// registered with Connection.add_input_adapter -- without the caller converting every value in Python first.
+//
+// Each connection keeps a small array mapping exact Python types to an adapter, like the output converters.  Types are
+// examined once and the result, including "no adapter", is added to the array, so binding a value is a pointer
+// comparison against the last type matched or a short scan.  numpy and uuid are recognized by name so neither has to
+// be imported.  All changes are made while holding the GIL.
+
+#include "pyodbc.h"
+#include "adapters.h"
+#include "connection.h"
+#include "wrapper.h"
+
+// Types without an adapter are remembered too, so they don't have to be examined again, but only this many so
+// programs binding many distinct classes can't grow the array without bound.
+static const int cMaxAdapters = 256;
+
+static bool HasBaseNamed(PyTypeObject* type, const char* name)
+{
+    // Returns true if `type` or one of its bases has the type name `name`, such as "numpy.integer".
+
+    PyObject* mro = type->tp_mro;
+    if (mro == 0 || !PyTuple_Check(mro))
+        return strcmp(type->tp_name, name) == 0;
+
+    for (Py_ssize_t i = 0, c = PyTuple_GET_SIZE(mro); i < c; i++)
+    {
+        PyObject* base = PyTuple_GET_ITEM(mro, i);
+        if (PyType_Check(base) && strcmp(((PyTypeObject*)base)->tp_name, name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static bool IsUUIDType(PyTypeObject* type)
+{
+    if (strcmp(type->tp_name, "UUID") != 0)
+        return false;
+
+    Object module(PyObject_GetAttrString((PyObject*)type, "__module__"));
+    if (!module)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+#if PY_MAJOR_VERSION >= 3
+    return PyUnicode_Check(module) && PyUnicode_CompareWithASCIIString(module, "uuid") == 0;
+#else
+    return PyString_Check(module) && strcmp(PyString_AS_STRING(module.Get()), "uuid") == 0;
+#endif
+}
+
+static int GetAdapterKind(PyTypeObject* type)
+{
+    if (HasBaseNamed(type, "numpy.generic"))
+    {
+        // numpy 2 renamed bool_ to bool.
+        if (strcmp(type->tp_name, "numpy.bool_") == 0 || strcmp(type->tp_name, "numpy.bool") == 0)
+            return ADAPTER_BOOLEAN;
+        if (HasBaseNamed(type, "numpy.integer"))
+            return ADAPTER_INTEGER;
+        if (HasBaseNamed(type, "numpy.floating"))
+            return ADAPTER_FLOAT;
+        return ADAPTER_NONE;
+    }
+
+    if (IsUUIDType(type))
+        return ADAPTER_GUID;
+
+    return ADAPTER_NONE;
+}
+
+static bool AppendAdapter(Connection* cnxn, PyTypeObject* type, int kind, PyObject* func)
+{
+    if (cnxn->adapter_count == cnxn->adapter_capacity)
+    {
+        int newcapacity = cnxn->adapter_capacity ? cnxn->adapter_capacity * 2 : 8;
+        InputAdapter* newadapters = (InputAdapter*)pyodbc_malloc(sizeof(InputAdapter) * newcapacity);
+        if (newadapters == 0)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        if (cnxn->adapter_count)
+            memcpy(newadapters, cnxn->adapters, sizeof(InputAdapter) * cnxn->adapter_count);
+        pyodbc_free(cnxn->adapters);
+
+        cnxn->adapters         = newadapters;
+        cnxn->adapter_capacity = newcapacity;
+    }
+
+    InputAdapter& adapter = cnxn->adapters[cnxn->adapter_count];
+    adapter.type = type;
+    adapter.kind = kind;
+    adapter.func = func;
+    Py_INCREF(type);
+    Py_XINCREF(func);
+
+    cnxn->adapter_last = cnxn->adapter_count;
+    cnxn->adapter_count++;
+    return true;
+}
+
+bool InputAdapters_Lookup(Connection* cnxn, PyTypeObject* type, InputAdapter& adapter)
+{
+    if (cnxn->adapter_count && cnxn->adapters[cnxn->adapter_last].type == type)
+    {
+        adapter = cnxn->adapters[cnxn->adapter_last];
+        return true;
+    }
+
+    for (int i = 0; i < cnxn->adapter_count; i++)
+    {
+        if (cnxn->adapters[i].type == type)
+        {
+            cnxn->adapter_last = i;
+            adapter = cnxn->adapters[i];
+            return true;
+        }
+    }
+
+    adapter.type = type;
+    adapter.kind = GetAdapterKind(type);
+    adapter.func = 0;
+
+    if (adapter.kind == ADAPTER_NONE && cnxn->adapter_count >= cMaxAdapters)
+        return true;
+
+    return AppendAdapter(cnxn, type, adapter.kind, 0);
+}
+
+bool InputAdapters_Add(Connection* cnxn, PyTypeObject* type, PyObject* func)
+{
+    for (int i = 0; i < cnxn->adapter_count; i++)
+    {
+        InputAdapter& adapter = cnxn->adapters[i];
+        if (adapter.type == type)
+        {
+            PyObject* old = adapter.func;
+            adapter.kind = ADAPTER_CALLABLE;
+            adapter.func = func;
+            Py_INCREF(func);
+            Py_XDECREF(old);
+            return true;
+        }
+    }
+
+    return AppendAdapter(cnxn, type, ADAPTER_CALLABLE, func);
+}
+
+void InputAdapters_Clear(Connection* cnxn)
+{
+    // The array is detached first since releasing a type or function can run arbitrary code.
+
+    InputAdapter* adapters = cnxn->adapters;
+    int           count    = cnxn->adapter_count;
+
+    cnxn->adapters         = 0;
+    cnxn->adapter_count    = 0;
+    cnxn->adapter_capacity = 0;
+    cnxn->adapter_last     = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        Py_DECREF(adapters[i].type);
+        Py_XDECREF(adapters[i].func);
+    }
+
+    pyodbc_free(adapters);
+}
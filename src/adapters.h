@@ -0,0 +1,54 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef ADAPTERS_H
+#define ADAPTERS_H
+
+struct Connection;
+
+// How parameters of a type GetParameterInfo doesn't recognize are bound.
+enum
+{
+    ADAPTER_NONE,               // not adapted; bound as a buffer or stream if possible, otherwise rejected
+    ADAPTER_INTEGER,            // numpy integers, bound as SQL_C_SBIGINT using __index__
+    ADAPTER_FLOAT,              // numpy floats, bound as SQL_C_DOUBLE using __float__
+    ADAPTER_BOOLEAN,            // numpy.bool_, bound as SQL_C_BIT
+    ADAPTER_GUID,               // uuid.UUID, bound as SQL_C_GUID from its 16 bytes
+    ADAPTER_CALLABLE            // registered with add_input_adapter; func converts values to a type that can be bound
+};
+
+struct InputAdapter
+{
+    PyTypeObject* type;
+    int kind;
+    PyObject* func;             // only for ADAPTER_CALLABLE
+};
+
+/*
+ * Finds the adapter for parameters of exactly `type`, examining the type and remembering the result the first time it
+ * is seen.  The adapter is copied into `adapter` since running Python code, such as the adapter's function, can change
+ * the connection's array; the caller must take its own reference to adapter.func before calling it.
+ *
+ * If an error occurs, an exception is set and false is returned.
+ */
+bool InputAdapters_Lookup(Connection* cnxn, PyTypeObject* type, InputAdapter& adapter);
+
+/*
+ * Registers `func` as the adapter for parameters of exactly `type`, replacing any earlier one.
+ */
+bool InputAdapters_Add(Connection* cnxn, PyTypeObject* type, PyObject* func);
+
+/*
+ * Removes the registered adapters and forgets the types that have been examined.
+ */
+void InputAdapters_Clear(Connection* cnxn);
+
+#endif // ADAPTERS_H
@@ -0,0 +1,143 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "pyodbc.h"
+#include "arena.h"
+
+struct ArenaBlock
+{
+    ArenaBlock* next;
+    size_t size;                // bytes available after the header
+};
+
+// Every allocation is rounded up to this, which is enough for the largest types bound (doubles, 64-bit integers, and
+// the ODBC date and time structures).
+static const size_t cbAlign = 16;
+
+// The size of the block header, rounded up so the data after it is aligned.
+static const size_t cbHeader = (sizeof(ArenaBlock) + cbAlign - 1) & ~(cbAlign - 1);
+
+// The smallest block allocated.  This holds the ParamInfos and buffers for a typical statement.
+static const size_t cbMinBlock = 4096;
+
+// Arena_Reset frees the blocks instead of keeping them if they add up to more than this.  Statements with very large
+// parameters or executemany batches shouldn't leave that memory tied up in every cursor that ran them.
+static const size_t cbMaxRetained = 1024 * 1024;
+
+inline char* BlockData(ArenaBlock* block)
+{
+    return (char*)block + cbHeader;
+}
+
+static ArenaBlock* NewBlock(size_t cb)
+{
+    ArenaBlock* block = (ArenaBlock*)pyodbc_malloc(cbHeader + cb);
+    if (block)
+    {
+        block->next = 0;
+        block->size = cb;
+    }
+    return block;
+}
+
+void Arena_Init(Arena& arena)
+{
+    arena.blocks    = 0;
+    arena.offset    = 0;
+    arena.used      = 0;
+    arena.highwater = 0;
+    arena.capacity  = 0;
+    arena.mark      = 0;
+}
+
+void* Arena_Alloc(Arena& arena, size_t cb)
+{
+    cb = (max(cb, (size_t)1) + cbAlign - 1) & ~(cbAlign - 1);
+
+    if (arena.blocks == 0 || arena.blocks->size - arena.offset < cb)
+    {
+        // Double the arena each time it fills so a growing statement needs only a few blocks.  The space left in the
+        // previous block is abandoned until the next reset.
+        ArenaBlock* block = NewBlock(max(cb, max(cbMinBlock, arena.capacity)));
+        if (block == 0)
+            return 0;
+
+        block->next     = arena.blocks;
+        arena.blocks    = block;
+        arena.offset    = 0;
+        arena.capacity += block->size;
+    }
+
+    void* p = BlockData(arena.blocks) + arena.offset;
+    arena.offset   += cb;
+    arena.used     += cb;
+    arena.highwater = max(arena.highwater, arena.used);
+    return p;
+}
+
+void Arena_Rewind(Arena& arena, void* p)
+{
+    if (arena.blocks == 0)
+        return;
+
+    char* pch  = (char*)p;
+    char* data = BlockData(arena.blocks);
+    if (pch < data || pch >= data + arena.offset)
+        return;
+
+    size_t offset = (size_t)(pch - data);
+    arena.used  -= arena.offset - offset;
+    arena.offset = offset;
+}
+
+static void FreeBlocks(Arena& arena)
+{
+    ArenaBlock* block = arena.blocks;
+    while (block)
+    {
+        ArenaBlock* next = block->next;
+        pyodbc_free(block);
+        block = next;
+    }
+
+    arena.blocks   = 0;
+    arena.capacity = 0;
+}
+
+void Arena_Reset(Arena& arena)
+{
+    if (arena.capacity > cbMaxRetained)
+    {
+        FreeBlocks(arena);
+    }
+    else if (arena.blocks && arena.blocks->next)
+    {
+        // Replace the blocks with one that holds everything so the next fill doesn't need more.  If it can't be
+        // allocated, the next Arena_Alloc will try again.
+        size_t cb = arena.capacity;
+        FreeBlocks(arena);
+        arena.blocks = NewBlock(cb);
+        if (arena.blocks)
+            arena.capacity = cb;
+    }
+
+    arena.offset = 0;
+    arena.used   = 0;
+    arena.mark   = 0;
+}
+
+void Arena_Free(Arena& arena)
+{
+    FreeBlocks(arena);
+    arena.offset = 0;
+    arena.used   = 0;
+    arena.mark   = 0;
+}
@@ -0,0 +1,74 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+struct ArenaBlock;
+
+// A bump pointer allocator.  Memory is handed out from large blocks and is never freed individually; everything is
+// released at once by Arena_Reset.  The blocks are kept for the next use, so an arena that is reset and filled the
+// same way again does not call malloc.
+//
+// Cursors use one for their parameter bindings, which are all released together by FreeParameterData.
+struct Arena
+{
+    // The blocks, the one being allocated from first.
+    ArenaBlock* blocks;
+
+    // The number of bytes allocated from the first block.
+    size_t offset;
+
+    // The number of bytes allocated since the last reset and the most that have been allocated between resets.
+    size_t used;
+    size_t highwater;
+
+    // The total size of the blocks.
+    size_t capacity;
+
+    // The value of `used` when Arena_Mark was last called.
+    size_t mark;
+};
+
+void Arena_Init(Arena& arena);
+
+/*
+ * Returns `cb` bytes, aligned for any ODBC value type, or zero if out of memory.  Like pyodbc_malloc, no exception is
+ * set.
+ */
+void* Arena_Alloc(Arena& arena, size_t cb);
+
+/*
+ * Gives back `p`, which must have come from Arena_Alloc, and everything allocated after it.  Nothing is released if
+ * the arena had to start a new block since `p` was allocated.
+ */
+void Arena_Rewind(Arena& arena, void* p);
+
+/*
+ * Records the number of bytes currently allocated in arena.mark.
+ */
+inline void Arena_Mark(Arena& arena)
+{
+    arena.mark = arena.used;
+}
+
+/*
+ * Releases everything allocated.  If the allocations needed more than one block, the blocks are replaced by a single
+ * one large enough for all of them, unless that would keep more memory than an idle cursor should hold.
+ */
+void Arena_Reset(Arena& arena);
+
+/*
+ * Frees the blocks.  The arena can still be used afterwards.
+ */
+void Arena_Free(Arena& arena);
+
+#endif // ARENA_H
@@ -0,0 +1,569 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Binding Arrow columns as ODBC parameter arrays for Cursor.executemany_arrow.
+//
+// Fixed width numbers have the same layout in both, so they are bound in place and only the validity bitmap has to be
+// expanded into an indicator array.  Everything else is converted one chunk of rows at a time into buffers in the
+// cursor's paramarena: booleans are unpacked into bytes, dates and timestamps are converted to the ODBC structs, and
+// strings are copied from Arrow's offsets and data into fixed width elements (decoded to SQLWCHAR unless the
+// connection's encoding is UTF-8).
+
+#include "pyodbc.h"
+#include "arrow.h"
+#include "cursor.h"
+#include "connection.h"
+#include "pyodbcmodule.h"
+#include "errors.h"
+#include "wrapper.h"
+
+#if PY_VERSION_HEX >= 0x02070000
+
+enum ArrowKind
+{
+    KIND_UNSUPPORTED,
+    KIND_FIXED,                 // integers and floats, bound in place
+    KIND_BOOL,
+    KIND_DATE32,
+    KIND_DATE64,
+    KIND_TIMESTAMP,
+    KIND_TEXT,                  // utf8 and large_utf8
+    KIND_BINARY,                // binary and large_binary
+};
+
+static ArrowKind GetKind(const ArrowSchema* schema, int& cbOffset, INT64& unitsPerSecond)
+{
+    // Determines how a field is converted from its format string.  cbOffset is set to the size of the offsets of the
+    // variable length types and unitsPerSecond to the resolution of timestamps.
+
+    cbOffset       = 4;
+    unitsPerSecond = 1;
+
+    const char* fmt = schema->format;
+
+    if (fmt == 0 || schema->dictionary != 0)
+        return KIND_UNSUPPORTED;
+
+    if (fmt[0] != 0 && fmt[1] == 0)
+    {
+        switch (fmt[0])
+        {
+        case 'c': case 'C': case 's': case 'S': case 'i': case 'I': case 'l': case 'L': case 'f': case 'g':
+            return KIND_FIXED;
+        case 'b':
+            return KIND_BOOL;
+        case 'u':
+            return KIND_TEXT;
+        case 'U':
+            cbOffset = 8;
+            return KIND_TEXT;
+        case 'z':
+            return KIND_BINARY;
+        case 'Z':
+            cbOffset = 8;
+            return KIND_BINARY;
+        }
+        return KIND_UNSUPPORTED;
+    }
+
+    if (strcmp(fmt, "tdD") == 0)
+        return KIND_DATE32;
+
+    if (strcmp(fmt, "tdm") == 0)
+        return KIND_DATE64;
+
+    // Timestamps are "ts" followed by the unit and a colon, then the time zone, if any.  Values with a time zone are
+    // UTC, so they are sent as UTC.
+    if (fmt[0] == 't' && fmt[1] == 's' && fmt[2] != 0 && fmt[3] == ':')
+    {
+        switch (fmt[2])
+        {
+        case 's': unitsPerSecond = 1;          return KIND_TIMESTAMP;
+        case 'm': unitsPerSecond = 1000;       return KIND_TIMESTAMP;
+        case 'u': unitsPerSecond = 1000000;    return KIND_TIMESTAMP;
+        case 'n': unitsPerSecond = 1000000000; return KIND_TIMESTAMP;
+        }
+    }
+
+    return KIND_UNSUPPORTED;
+}
+
+static void SetFixedType(char code, ParamInfo& info)
+{
+    // Unsigned values are given the next larger SQL type so they always fit, as executemany_columns does, which for
+    // 64-bit values is a NUMERIC(20).
+
+    switch (code)
+    {
+    case 'c':
+        info.ValueType = SQL_C_STINYINT; info.ParameterType = SQL_SMALLINT; info.ColumnSize = 3;  info.BufferLength = 1;
+        break;
+    case 'C':
+        info.ValueType = SQL_C_UTINYINT; info.ParameterType = SQL_TINYINT;  info.ColumnSize = 3;  info.BufferLength = 1;
+        break;
+    case 's':
+        info.ValueType = SQL_C_SSHORT;   info.ParameterType = SQL_SMALLINT; info.ColumnSize = 5;  info.BufferLength = 2;
+        break;
+    case 'S':
+        info.ValueType = SQL_C_USHORT;   info.ParameterType = SQL_INTEGER;  info.ColumnSize = 10; info.BufferLength = 2;
+        break;
+    case 'i':
+        info.ValueType = SQL_C_SLONG;    info.ParameterType = SQL_INTEGER;  info.ColumnSize = 10; info.BufferLength = 4;
+        break;
+    case 'I':
+        info.ValueType = SQL_C_ULONG;    info.ParameterType = SQL_BIGINT;   info.ColumnSize = 19; info.BufferLength = 4;
+        break;
+    case 'l':
+        info.ValueType = SQL_C_SBIGINT;  info.ParameterType = SQL_BIGINT;   info.ColumnSize = 19; info.BufferLength = 8;
+        break;
+    case 'L':
+        info.ValueType = SQL_C_UBIGINT;  info.ParameterType = SQL_NUMERIC;  info.ColumnSize = 20; info.BufferLength = 8;
+        break;
+    case 'f':
+        info.ValueType = SQL_C_FLOAT;    info.ParameterType = SQL_REAL;     info.ColumnSize = 7;  info.BufferLength = 4;
+        break;
+    case 'g':
+        info.ValueType = SQL_C_DOUBLE;   info.ParameterType = SQL_DOUBLE;   info.ColumnSize = 15; info.BufferLength = 8;
+        break;
+    }
+}
+
+PyObject* Arrow_GetStreamCapsule(PyObject* obj)
+{
+    if (PyCapsule_IsValid(obj, "arrow_array_stream"))
+    {
+        Py_INCREF(obj);
+        return obj;
+    }
+
+    if (PyObject_HasAttrString(obj, "__arrow_c_stream__"))
+    {
+        Object capsule(PyObject_CallMethod(obj, "__arrow_c_stream__", 0));
+        if (!capsule)
+            return 0;
+
+        if (!PyCapsule_IsValid(capsule, "arrow_array_stream"))
+        {
+            PyErr_SetString(PyExc_TypeError, "__arrow_c_stream__ did not return an arrow_array_stream capsule");
+            return 0;
+        }
+
+        return capsule.Detach();
+    }
+
+    PyErr_SetString(PyExc_TypeError, "The second argument to executemany_arrow must have an __arrow_c_stream__ method or be an arrow_array_stream capsule.");
+    return 0;
+}
+
+bool Arrow_RaiseStreamError(ArrowArrayStream* stream, const char* szFunction, int err)
+{
+    const char* szMessage = stream->get_last_error ? stream->get_last_error(stream) : 0;
+    RaiseErrorV(0, Error, "The Arrow stream's %s failed (error %d): %s", szFunction, err, szMessage ? szMessage : "no message");
+    return false;
+}
+
+bool Arrow_SetColumnType(Connection* cnxn, Py_ssize_t index, const ArrowSchema* schema, ParamInfo& info)
+{
+    int   cbOffset;
+    INT64 unitsPerSecond;
+
+    info.InputOutputType = SQL_PARAM_INPUT;
+    info.DecimalDigits   = 0;
+
+    switch (GetKind(schema, cbOffset, unitsPerSecond))
+    {
+    case KIND_FIXED:
+        SetFixedType(schema->format[0], info);
+        return true;
+
+    case KIND_BOOL:
+        info.ValueType     = SQL_C_BIT;
+        info.ParameterType = SQL_BIT;
+        info.ColumnSize    = 1;
+        info.BufferLength  = 1;
+        return true;
+
+    case KIND_DATE32:
+    case KIND_DATE64:
+        info.ValueType     = SQL_C_TYPE_DATE;
+        info.ParameterType = SQL_TYPE_DATE;
+        info.ColumnSize    = 10;
+        info.BufferLength  = sizeof(DATE_STRUCT);
+        return true;
+
+    case KIND_TIMESTAMP:
+    {
+        // As GetDateTimeInfo, the fraction is limited to what the database supports.
+        int precision = cnxn->datetime_precision - 20;
+        info.ValueType     = SQL_C_TIMESTAMP;
+        info.ParameterType = SQL_TIMESTAMP;
+        info.ColumnSize    = (SQLULEN)cnxn->datetime_precision;
+        info.DecimalDigits = (SQLSMALLINT)max(precision, 0);
+        info.BufferLength  = sizeof(TIMESTAMP_STRUCT);
+        return true;
+    }
+
+    case KIND_TEXT:
+        // The SQL type and sizes depend on the longest value in each chunk and are set by Arrow_FillColumn.
+        info.ValueType = cnxn->utf8 ? SQL_C_CHAR : SQL_C_WCHAR;
+        return true;
+
+    case KIND_BINARY:
+        info.ValueType = SQL_C_BINARY;
+        return true;
+
+    case KIND_UNSUPPORTED:
+        break;
+    }
+
+    RaiseErrorV(0, NotSupportedError, "executemany_arrow column %zd ('%s') has an unsupported Arrow format '%s'",
+                index, schema->name ? schema->name : "", schema->format ? schema->format : "");
+    return false;
+}
+
+inline bool IsValid(const unsigned char* pValidity, INT64 i)
+{
+    return pValidity == 0 || ((pValidity[i >> 3] >> (i & 7)) & 1) != 0;
+}
+
+inline INT64 GetOffset(const void* pOffsets, int cbOffset, INT64 i)
+{
+    return (cbOffset == 4) ? (INT64)((const int*)pOffsets)[i] : ((const INT64*)pOffsets)[i];
+}
+
+inline INT64 FloorDiv(INT64 a, INT64 b)
+{
+    INT64 q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static void DateFromDays(INT64 days, SQLSMALLINT& year, SQLUSMALLINT& month, SQLUSMALLINT& day)
+{
+    // Converts days since 1970-01-01 to a proleptic Gregorian date.  This is Howard Hinnant's civil_from_days, which
+    // works in 400 year eras starting on March 1st so leap days fall at the end of the year.
+
+    INT64    z   = days + 719468;
+    INT64    era = FloorDiv(z, 146097);
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp  = (5 * doy + 2) / 153;
+    unsigned d   = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m   = mp < 10 ? mp + 3 : mp - 9;
+
+    year  = (SQLSMALLINT)((INT64)yoe + era * 400 + (m <= 2 ? 1 : 0));
+    month = (SQLUSMALLINT)m;
+    day   = (SQLUSMALLINT)d;
+}
+
+static Py_ssize_t DecodeUTF8(const unsigned char* pb, Py_ssize_t cb, SQLWCHAR* pch)
+{
+    // Decodes UTF-8 into `pch`, which must have room for `cb` characters, and returns the number written.  Arrow
+    // requires valid UTF-8, but anything malformed is replaced by U+FFFD rather than overrunning.
+
+    Py_ssize_t cch = 0;
+    Py_ssize_t i   = 0;
+
+    while (i < cb)
+    {
+        unsigned int c = pb[i++];
+        int cTrail;
+
+        if (c < 0x80)
+        {
+            cTrail = 0;
+        }
+        else if ((c & 0xE0) == 0xC0)
+        {
+            c &= 0x1F;
+            cTrail = 1;
+        }
+        else if ((c & 0xF0) == 0xE0)
+        {
+            c &= 0x0F;
+            cTrail = 2;
+        }
+        else if ((c & 0xF8) == 0xF0)
+        {
+            c &= 0x07;
+            cTrail = 3;
+        }
+        else
+        {
+            c = 0xFFFD;
+            cTrail = 0;
+        }
+
+        for (; cTrail > 0; cTrail--)
+        {
+            if (i == cb || (pb[i] & 0xC0) != 0x80)
+            {
+                c = 0xFFFD;
+                break;
+            }
+            c = (c << 6) | (pb[i++] & 0x3F);
+        }
+
+        if (sizeof(SQLWCHAR) == 2 && c >= 0x10000)
+        {
+            // A 4 byte sequence becomes a surrogate pair, so it still fits.
+            c -= 0x10000;
+            pch[cch++] = (SQLWCHAR)(0xD800 + (c >> 10));
+            pch[cch++] = (SQLWCHAR)(0xDC00 + (c & 0x3FF));
+        }
+        else
+        {
+            pch[cch++] = (SQLWCHAR)c;
+        }
+    }
+
+    return cch;
+}
+
+static void* AllocChunk(Cursor* cur, size_t cb)
+{
+    void* p = Arena_Alloc(cur->paramarena, max(cb, (size_t)1));
+    if (p == 0)
+        PyErr_NoMemory();
+    return p;
+}
+
+// The largest buffer a chunk of strings or binary values is converted into, unless a single value is larger.  The
+// buffer holds cRows elements the size of the longest value, so one long value could otherwise make it enormous.
+static const INT64 cbChunkMax = 8 * 1024 * 1024;
+
+static bool FillVariableColumn(Cursor* cur, Py_ssize_t index, int cbOffset, const ArrowArray* column, INT64 iRow,
+                               Py_ssize_t cRows, const unsigned char* pValidity, ParamInfo& info)
+{
+    // Copies strings or binary values into fixed width elements sized for the longest in the chunk.  Arrow_ChunkRows
+    // has already limited the chunk so the buffer stays under cbChunkMax.
+
+    if (column->n_buffers < 3)
+    {
+        RaiseErrorV(0, ProgrammingError, "executemany_arrow column %zd has %d buffers, not 3", index, (int)column->n_buffers);
+        return false;
+    }
+
+    const void*          pOffsets = column->buffers[1];
+    const unsigned char* pData    = (const unsigned char*)column->buffers[2];
+
+    INT64 cbMax = 0;
+    for (Py_ssize_t i = 0; i < cRows; i++)
+    {
+        if (IsValid(pValidity, iRow + i))
+            cbMax = max(cbMax, GetOffset(pOffsets, cbOffset, iRow + i + 1) - GetOffset(pOffsets, cbOffset, iRow + i));
+    }
+
+    // UTF-8 never needs more characters than bytes, so the decoded SQLWCHARs fit in cbMax characters.
+    SQLLEN cbChar = (info.ValueType == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+    SQLLEN cbElem = (SQLLEN)max(cbMax, (INT64)1) * cbChar;
+
+    char* pbValues = (char*)AllocChunk(cur, (size_t)(cbElem * cRows));
+    if (!pbValues)
+        return false;
+
+    SQLLEN* pInd   = info.StrLen_or_IndArray;
+    SQLLEN  cchMax = 1;
+
+    for (Py_ssize_t i = 0; i < cRows; i++)
+    {
+        if (!IsValid(pValidity, iRow + i))
+        {
+            pInd[i] = SQL_NULL_DATA;
+            continue;
+        }
+
+        INT64       ib   = GetOffset(pOffsets, cbOffset, iRow + i);
+        Py_ssize_t  cb   = (Py_ssize_t)(GetOffset(pOffsets, cbOffset, iRow + i + 1) - ib);
+        char*       pDst = pbValues + (cbElem * i);
+
+        if (info.ValueType == SQL_C_WCHAR)
+        {
+            Py_ssize_t cch = DecodeUTF8(pData + ib, cb, (SQLWCHAR*)pDst);
+            pInd[i] = (SQLLEN)(cch * sizeof(SQLWCHAR));
+            cchMax  = max(cchMax, (SQLLEN)cch);
+        }
+        else
+        {
+            memcpy(pDst, pData + ib, (size_t)cb);
+            pInd[i] = (SQLLEN)cb;
+            cchMax  = max(cchMax, (SQLLEN)cb);
+        }
+    }
+
+    Connection* cnxn = cur->cnxn;
+    switch (info.ValueType)
+    {
+    case SQL_C_WCHAR:
+        info.ParameterType = (cchMax > cnxn->wvarchar_maxlength) ? SQL_WLONGVARCHAR : SQL_WVARCHAR;
+        break;
+    case SQL_C_CHAR:
+        info.ParameterType = (cchMax > cnxn->varchar_maxlength) ? SQL_LONGVARCHAR : SQL_VARCHAR;
+        break;
+    default:
+        info.ParameterType = (cchMax > cnxn->binary_maxlength) ? SQL_LONGVARBINARY : SQL_VARBINARY;
+        break;
+    }
+
+    info.ColumnSize        = (SQLULEN)cchMax;
+    info.BufferLength      = cbElem;
+    info.ParameterValuePtr = pbValues;
+    info.allocated         = true;
+    return true;
+}
+
+Py_ssize_t Arrow_ChunkRows(Cursor* cur, const ArrowSchema* schema, const ArrowArray* batch, INT64 iFirstRow,
+                           Py_ssize_t cRows)
+{
+    for (Py_ssize_t iCol = 0; iCol < cur->paramcount; iCol++)
+    {
+        int   cbOffset;
+        INT64 unitsPerSecond;
+        ArrowKind kind = GetKind(schema->children[iCol], cbOffset, unitsPerSecond);
+        if (kind != KIND_TEXT && kind != KIND_BINARY)
+            continue;
+
+        const ArrowArray* column = batch->children[iCol];
+        if (column->n_buffers < 3)
+            continue;           // FillVariableColumn raises the error
+
+        const unsigned char* pValidity = (column->null_count != 0) ? (const unsigned char*)column->buffers[0] : 0;
+        const void*          pOffsets  = column->buffers[1];
+
+        INT64  iRow   = column->offset + batch->offset + iFirstRow;
+        SQLLEN cbChar = (cur->paramInfos[iCol].ValueType == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+        INT64  cbMax  = 1;
+
+        for (Py_ssize_t i = 0; i < cRows; i++)
+        {
+            if (IsValid(pValidity, iRow + i))
+            {
+                INT64 cb = GetOffset(pOffsets, cbOffset, iRow + i + 1) - GetOffset(pOffsets, cbOffset, iRow + i);
+                cbMax = max(cbMax, cb);
+            }
+
+            if (i > 0 && cbMax * cbChar * (i + 1) > cbChunkMax)
+            {
+                cRows = i;
+                break;
+            }
+        }
+    }
+
+    return cRows;
+}
+
+bool Arrow_FillColumn(Cursor* cur, Py_ssize_t index, const ArrowSchema* schema, const ArrowArray* column,
+                      INT64 iRow, Py_ssize_t cRows, ParamInfo& info)
+{
+    int   cbOffset;
+    INT64 unitsPerSecond;
+    ArrowKind kind = GetKind(schema, cbOffset, unitsPerSecond);
+
+    if (column->n_buffers < 2)
+    {
+        RaiseErrorV(0, ProgrammingError, "executemany_arrow column %zd has %d buffers, not 2", index, (int)column->n_buffers);
+        return false;
+    }
+
+    // The validity bitmap may be left out when there are no nulls.
+    const unsigned char* pValidity = (column->null_count != 0) ? (const unsigned char*)column->buffers[0] : 0;
+    const char*          pValues   = (const char*)column->buffers[1];
+    SQLLEN*              pInd      = info.StrLen_or_IndArray;
+
+    if (kind == KIND_TEXT || kind == KIND_BINARY)
+        return FillVariableColumn(cur, index, cbOffset, column, iRow, cRows, pValidity, info);
+
+    for (Py_ssize_t i = 0; i < cRows; i++)
+        pInd[i] = IsValid(pValidity, iRow + i) ? info.BufferLength : SQL_NULL_DATA;
+
+    switch (kind)
+    {
+    case KIND_FIXED:
+        info.ParameterValuePtr = (SQLPOINTER)(pValues + (iRow * info.BufferLength));
+        return true;
+
+    case KIND_BOOL:
+    {
+        unsigned char* pb = (unsigned char*)AllocChunk(cur, (size_t)cRows);
+        if (!pb)
+            return false;
+        for (Py_ssize_t i = 0; i < cRows; i++)
+            pb[i] = IsValid((const unsigned char*)pValues, iRow + i) ? 1 : 0;
+        info.ParameterValuePtr = pb;
+        info.allocated         = true;
+        return true;
+    }
+
+    case KIND_DATE32:
+    case KIND_DATE64:
+    {
+        DATE_STRUCT* pDates = (DATE_STRUCT*)AllocChunk(cur, sizeof(DATE_STRUCT) * cRows);
+        if (!pDates)
+            return false;
+        for (Py_ssize_t i = 0; i < cRows; i++)
+        {
+            if (pInd[i] == SQL_NULL_DATA)
+                continue;
+            INT64 days = (kind == KIND_DATE32) ? (INT64)((const int*)pValues)[iRow + i]
+                                               : FloorDiv(((const INT64*)pValues)[iRow + i], (INT64)86400000);
+            DateFromDays(days, pDates[i].year, pDates[i].month, pDates[i].day);
+        }
+        info.ParameterValuePtr = pDates;
+        info.allocated         = true;
+        return true;
+    }
+
+    case KIND_TIMESTAMP:
+    {
+        TIMESTAMP_STRUCT* pTimestamps = (TIMESTAMP_STRUCT*)AllocChunk(cur, sizeof(TIMESTAMP_STRUCT) * cRows);
+        if (!pTimestamps)
+            return false;
+
+        // Keep as many fractional digits as the database supports, as GetDateTimeInfo does.
+        int   precision = info.DecimalDigits;
+        INT64 keep      = 1;
+        for (int i = min(9, precision); i < 9; i++)
+            keep *= 10;
+
+        for (Py_ssize_t i = 0; i < cRows; i++)
+        {
+            if (pInd[i] == SQL_NULL_DATA)
+                continue;
+
+            INT64 value   = ((const INT64*)pValues)[iRow + i];
+            INT64 seconds = FloorDiv(value, unitsPerSecond);
+            INT64 nanos   = (value - seconds * unitsPerSecond) * (1000000000 / unitsPerSecond);
+            INT64 days    = FloorDiv(seconds, 86400);
+            INT64 sod     = seconds - days * 86400;
+
+            TIMESTAMP_STRUCT& ts = pTimestamps[i];
+            DateFromDays(days, ts.year, ts.month, ts.day);
+            ts.hour     = (SQLUSMALLINT)(sod / 3600);
+            ts.minute   = (SQLUSMALLINT)(sod / 60 % 60);
+            ts.second   = (SQLUSMALLINT)(sod % 60);
+            ts.fraction = (precision <= 0) ? 0 : (SQLUINTEGER)(nanos / keep * keep);
+        }
+        info.ParameterValuePtr = pTimestamps;
+        info.allocated         = true;
+        return true;
+    }
+
+    default:
+        break;
+    }
+
+    // Arrow_SetColumnType has already rejected anything else.
+    RaiseErrorV(0, NotSupportedError, "executemany_arrow column %zd has an unsupported Arrow format", index);
+    return false;
+}
+
+#endif // PY_VERSION_HEX >= 0x02070000
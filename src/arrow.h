@@ -0,0 +1,116 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef ARROW_H
+#define ARROW_H
+
+// The Arrow C data and stream interfaces, which are a stable ABI, so pyodbc can read Arrow record batches without
+// depending on libarrow.  The definitions are copied from the specification and guarded the same way, so they can
+// coexist with another copy.  (The spec uses int64_t; INT64 is the same type.)
+//
+// https://arrow.apache.org/docs/format/CDataInterface.html
+
+#if PY_VERSION_HEX >= 0x02070000
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    const char* format;
+    const char* name;
+    const char* metadata;
+    INT64 flags;
+    INT64 n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray
+{
+    INT64 length;
+    INT64 null_count;
+    INT64 offset;
+    INT64 n_buffers;
+    INT64 n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream
+{
+    int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+    int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+    const char* (*get_last_error)(struct ArrowArrayStream*);
+
+    void (*release)(struct ArrowArrayStream*);
+    void* private_data;
+};
+
+#endif // ARROW_C_STREAM_INTERFACE
+
+struct Connection;
+struct Cursor;
+struct ParamInfo;
+
+/*
+ * Returns a new reference to the "arrow_array_stream" PyCapsule for `obj`, which is either such a capsule or an object
+ * with an __arrow_c_stream__ method (pyarrow tables and readers, polars and pandas data frames, etc.).  The stream is
+ * used in place and released by the caller, which leaves nothing for the capsule's destructor to do.
+ */
+PyObject* Arrow_GetStreamCapsule(PyObject* obj);
+
+/*
+ * Raises an exception for an error code returned by one of the stream's callbacks and returns false.
+ */
+bool Arrow_RaiseStreamError(ArrowArrayStream* stream, const char* szFunction, int err);
+
+/*
+ * Sets the parts of a parameter array binding for the Arrow field `schema` that don't change from batch to batch.  If
+ * the field's type is not supported, NotSupportedError is raised and false is returned.
+ */
+bool Arrow_SetColumnType(Connection* cnxn, Py_ssize_t index, const ArrowSchema* schema, ParamInfo& info);
+
+/*
+ * Returns the number of rows, at most cRows, starting at iFirstRow of `batch` that can be bound as one chunk.  Strings
+ * and binary values are converted into elements the size of the longest in the chunk, so the chunk ends early when
+ * that would make a column's buffer too large.  At least one row is always returned.
+ */
+Py_ssize_t Arrow_ChunkRows(Cursor* cur, const ArrowSchema* schema, const ArrowArray* batch, INT64 iFirstRow,
+                           Py_ssize_t cRows);
+
+/*
+ * Points `info` at rows [iRow, iRow + cRows) of `column`, where iRow includes the offsets of the column and its
+ * batch, and fills in info.StrLen_or_IndArray.  Fixed width numbers are bound in place; other types are converted into
+ * buffers allocated from the cursor's paramarena.
+ */
+bool Arrow_FillColumn(Cursor* cur, Py_ssize_t index, const ArrowSchema* schema, const ArrowArray* column,
+                      INT64 iRow, Py_ssize_t cRows, ParamInfo& info);
+
+#endif // PY_VERSION_HEX >= 0x02070000
+
+#endif // ARROW_H
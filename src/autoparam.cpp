@@ -0,0 +1,552 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Client-side parameterization of SQL written with literal values, for programs that build their SQL as text.  When
+// the connection's auto_parameterize attribute is set,
+//
+//   cursor.execute("select * from t where id = 17 and name = N'x'")
+//
+// is executed as "select * from t where id = ? and name = ?" with the parameters (17, u'x'), so a new value is not a
+// new statement to the driver and the server's plan cache, and the prepared statement is reused by the cursor and the
+// connection's statement cache.
+//
+// The SQL is scanned once.  Comments, quoted and bracketed identifiers, and ODBC escape sequences such as
+// {ts '2001-01-01 00:00:00'} and {fn ucase('x')} are copied as they are.  Literals are also left where a parameter
+// isn't allowed or would change the meaning: TOP counts, ORDER BY column numbers, the lengths in types such as
+// varchar(10), typed literals such as DATE '2001-01-01', strings with a prefix such as X'1F' or _utf8'x', and numbers
+// with exponents.  SQL that already has parameter markers, or that isn't a SELECT, INSERT, UPDATE, DELETE, MERGE, or
+// WITH statement, is not changed.  Nor is SQL with a GROUP BY, since the select list's expressions must match the
+// grouped ones (select n % 2 ... group by n % 2), which they no longer do once each literal is a separate parameter.
+//
+// Integers are passed as ints and numbers with a decimal point as Decimals, which are the types SQL gives them.
+// N'...' literals are passed as Unicode when the SQL is Unicode.  Other string literals are only lifted if they will
+// be bound as SQL_VARCHAR -- a Python 2 str, or when the connection has an encoding -- since comparing a varchar column
+// to an nvarchar parameter keeps some databases from using an index on the column.
+
+#include "pyodbc.h"
+#include "autoparam.h"
+#include "cursor.h"
+#include "connection.h"
+#include "pyodbcmodule.h"
+#include "wrapper.h"
+
+// The most normalized statements kept by a connection.  When full, the dictionary is emptied and starts over.
+static const Py_ssize_t cMaxAutoParamStatements = 500;
+
+// Longer numbers are left as literals.  (38 digits is the largest NUMERIC.)
+static const Py_ssize_t cchMaxNumber = 40;
+
+static const char* const aszStatements[] = { "select", "insert", "update", "delete", "merge", "with", 0 };
+
+// Types whose lengths, precisions, and scales must be literals.
+static const char* const aszSizedTypes[] = { "char", "varchar", "nchar", "nvarchar", "binary", "varbinary", "decimal",
+                                             "numeric", "dec", "float", "time", "datetime2", "datetimeoffset", 0 };
+
+// Words followed by a string literal that must stay a literal.
+static const char* const aszTypedLiterals[] = { "date", "time", "timestamp", "interval", "escape", 0 };
+
+// Words that end an ORDER BY list.
+static const char* const aszEndOrdinals[] = { "having", "limit", "offset", "fetch", "for", "union", "except",
+                                              "intersect", "option", "window", 0 };
+
+static bool IsDigit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static bool IsSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\f' || ch == '\v';
+}
+
+static bool IsIdentifierChar(char ch)
+{
+    // The bytes of multibyte UTF-8 characters are treated as identifier characters.
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || IsDigit(ch) || ch == '_' || ch == '@' || ch == '#' ||
+           ch == '$' || (ch & 0x80) != 0;
+}
+
+static bool IsWord(const char* pch, Py_ssize_t cch, const char* szWord)
+{
+    // Returns true if the cch characters at pch are szWord, ignoring case.  szWord must be lowercase.
+
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        char ch = pch[i];
+        if (ch >= 'A' && ch <= 'Z')
+            ch = (char)(ch - 'A' + 'a');
+        if (szWord[i] == 0 || ch != szWord[i])
+            return false;
+    }
+    return szWord[cch] == 0;
+}
+
+static bool IsAnyWord(const char* pch, Py_ssize_t cch, const char* const* aszWords)
+{
+    for (int i = 0; aszWords[i] != 0; i++)
+        if (IsWord(pch, cch, aszWords[i]))
+            return true;
+    return false;
+}
+
+static Py_ssize_t SkipComment(const char* pch, Py_ssize_t cch, Py_ssize_t i)
+{
+    // If a comment starts at pch[i], returns the index after it.  Otherwise returns i.
+
+    if (i + 1 < cch && pch[i] == '-' && pch[i + 1] == '-')
+    {
+        i += 2;
+        while (i < cch && pch[i] != '\n')
+            i++;
+    }
+    else if (i + 1 < cch && pch[i] == '/' && pch[i + 1] == '*')
+    {
+        i += 2;
+        while (i < cch && !(pch[i] == '*' && i + 1 < cch && pch[i + 1] == '/'))
+            i++;
+        i = min(i + 2, cch);
+    }
+    return i;
+}
+
+static Py_ssize_t SkipQuoted(const char* pch, Py_ssize_t cch, Py_ssize_t i, char chClose)
+{
+    // pch[i] opens a quoted string or identifier closed by chClose, where two chClose characters stand for one.
+    // Returns the index after the closing character, or -1 if it is not closed.
+
+    for (i++; i < cch; i++)
+    {
+        if (pch[i] == chClose)
+        {
+            if (i + 1 < cch && pch[i + 1] == chClose)
+                i++;
+            else
+                return i + 1;
+        }
+    }
+    return -1;
+}
+
+static Py_ssize_t SkipEscape(const char* pch, Py_ssize_t cch, Py_ssize_t i)
+{
+    // pch[i] opens an ODBC escape sequence, which may contain strings and other escape sequences.  Returns the index
+    // after the closing brace, or -1 if it is not closed.
+
+    int depth = 0;
+    while (i < cch)
+    {
+        char ch = pch[i];
+        if (ch == '\'')
+        {
+            i = SkipQuoted(pch, cch, i, '\'');
+            if (i == -1)
+                return -1;
+            continue;
+        }
+
+        if (ch == '{')
+            depth++;
+        else if (ch == '}' && --depth == 0)
+            return i + 1;
+        i++;
+    }
+    return -1;
+}
+
+static bool IsStatement(const char* pch, Py_ssize_t cch)
+{
+    // Returns true if the first word of the SQL, after any comments and opening parentheses, is one of aszStatements.
+
+    Py_ssize_t i = 0;
+    while (i < cch)
+    {
+        Py_ssize_t iNext = SkipComment(pch, cch, i);
+        if (iNext != i)
+            i = iNext;
+        else if (IsSpace(pch[i]) || pch[i] == '(')
+            i++;
+        else
+            break;
+    }
+
+    Py_ssize_t iStart = i;
+    while (i < cch && IsIdentifierChar(pch[i]))
+        i++;
+
+    return IsAnyWord(&pch[iStart], i - iStart, aszStatements);
+}
+
+static PyObject* StringValue(const char* pch, Py_ssize_t cch, bool fUnicode)
+{
+    // Returns the value of the string literal pch[0:cch], including its quotes.
+
+    char* pb = (char*)pyodbc_malloc((size_t)max(cch, 1));
+    if (pb == 0)
+        return PyErr_NoMemory();
+
+    Py_ssize_t cb = 0;
+    for (Py_ssize_t i = 1; i < cch - 1; i++)
+    {
+        pb[cb++] = pch[i];
+        if (pch[i] == '\'')
+            i++;                // the second of a doubled quote
+    }
+
+    PyObject* value;
+    if (fUnicode)
+        value = PyUnicode_DecodeUTF8(pb, cb, "strict");
+    else
+        value = PyBytes_FromStringAndSize(pb, cb);
+
+    pyodbc_free(pb);
+    return value;
+}
+
+static PyObject* NumberValue(const char* pch, Py_ssize_t cch, bool fDecimal)
+{
+    char sz[cchMaxNumber + 1];
+    memcpy(sz, pch, (size_t)cch);
+    sz[cch] = 0;
+
+    if (fDecimal)
+        return PyObject_CallFunction(decimal_type, "s", sz);
+    return PyLong_FromString(sz, 0, 10);
+}
+
+static PyObject* InternSQL(Connection* cnxn, PyObject* sql)
+{
+    // Returns a new reference to the connection's object for the normalized SQL `sql`, adding it if necessary, so
+    // Prepare finds the statement by pointer.  Steals the reference to sql.
+
+    Object tmp(sql);
+
+    if (cnxn->autoparam_sql == 0)
+    {
+        cnxn->autoparam_sql = PyDict_New();
+        if (cnxn->autoparam_sql == 0)
+            return 0;
+    }
+
+    PyObject* existing = PyDict_GetItem(cnxn->autoparam_sql, sql);
+    if (existing)
+    {
+        Py_INCREF(existing);
+        return existing;
+    }
+
+    if (PyDict_Size(cnxn->autoparam_sql) >= cMaxAutoParamStatements)
+        PyDict_Clear(cnxn->autoparam_sql);
+
+    if (PyDict_SetItem(cnxn->autoparam_sql, sql, sql) != 0)
+        return 0;
+
+    return tmp.Detach();
+}
+
+bool AutoParameterize(Cursor* cur, PyObject* pSql, PyObject*& pNewSql, PyObject*& pNewParams)
+{
+    pNewSql    = 0;
+    pNewParams = 0;
+
+    Object      encoded;
+    const char* pch;
+    Py_ssize_t  cch;
+    bool        fUnicode = PyUnicode_Check(pSql);
+
+    if (fUnicode)
+    {
+        encoded = PyUnicode_AsUTF8String(pSql);
+        if (!encoded)
+            return false;
+        pch = PyBytes_AS_STRING(encoded.Get());
+        cch = PyBytes_GET_SIZE(encoded.Get());
+    }
+#if PY_MAJOR_VERSION < 3
+    else if (PyString_Check(pSql))
+    {
+        pch = PyString_AS_STRING(pSql);
+        cch = PyString_GET_SIZE(pSql);
+    }
+#endif
+    else
+    {
+        return true;
+    }
+
+    if (!IsStatement(pch, cch))
+        return true;
+
+    bool fLiftNational = fUnicode;
+    bool fLiftStrings  = !fUnicode || cur->cnxn->encoding != 0;
+
+    // Literals are only replaced, so the normalized SQL is never longer.
+
+    char* pb = (char*)pyodbc_malloc((size_t)max(cch, 1));
+    if (pb == 0)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    Object values(PyList_New(0));
+    if (!values)
+    {
+        pyodbc_free(pb);
+        return false;
+    }
+
+    Py_ssize_t cb = 0;
+
+    // The scanner's state.  The last word is remembered until the next token that isn't whitespace or a comment.
+
+    int         depth        = 0;       // parentheses
+    int         typeDepth    = -1;      // if not -1, numbers are in the parentheses of a sized type at this depth
+    int         ordinalDepth = -1;      // if not -1, numbers are in an ORDER BY list at this depth
+    bool        fTop         = false;   // the last word was TOP, possibly followed by '('
+    const char* pchWord      = 0;       // the last word
+    Py_ssize_t  cchWord      = 0;
+    bool        fNational    = false;   // the last character was the N of N'...'
+
+    bool fSuccess = true;
+    bool fChanged = false;
+
+    Py_ssize_t i = 0;
+    while (i < cch && fSuccess)
+    {
+        char ch = pch[i];
+
+        Py_ssize_t iNext = SkipComment(pch, cch, i);
+        if (iNext == i && IsSpace(ch))
+            iNext = i + 1;
+        if (iNext != i)
+        {
+            memcpy(&pb[cb], &pch[i], (size_t)(iNext - i));
+            cb += iNext - i;
+            i = iNext;
+            continue;
+        }
+
+        if (IsIdentifierChar(ch) && !IsDigit(ch))
+        {
+            iNext = i + 1;
+            while (iNext < cch && IsIdentifierChar(pch[iNext]))
+                iNext++;
+
+            if (iNext == i + 1 && (ch == 'N' || ch == 'n') && iNext < cch && pch[iNext] == '\'')
+            {
+                // The prefix of a national string literal, which keeps the previous word.
+                fNational = true;
+                pb[cb++] = ch;
+                i = iNext;
+                continue;
+            }
+
+            const char* pchPrev = pchWord;
+            Py_ssize_t  cchPrev = cchWord;
+
+            pchWord = &pch[i];
+            cchWord = iNext - i;
+
+            fTop = IsWord(pchWord, cchWord, "top");
+
+            if (IsWord(pchWord, cchWord, "by") && pchPrev && IsWord(pchPrev, cchPrev, "group"))
+            {
+                fSuccess = false;       // see the comment at the top
+                break;
+            }
+
+            if (IsWord(pchWord, cchWord, "by") && pchPrev && IsWord(pchPrev, cchPrev, "order"))
+                ordinalDepth = depth;
+            else if (IsAnyWord(pchWord, cchWord, aszEndOrdinals))
+                ordinalDepth = -1;
+
+            memcpy(&pb[cb], &pch[i], (size_t)cchWord);
+            cb += cchWord;
+            i = iNext;
+            continue;
+        }
+
+        // Everything else ends the word, but the word is still needed below.
+
+        const char* pchPrev   = pchWord;
+        Py_ssize_t  cchPrev   = cchWord;
+        bool        fPrevTop  = fTop;
+        bool        fPrefixed = fNational;
+
+        pchWord   = 0;
+        cchWord   = 0;
+        fTop      = false;
+        fNational = false;
+
+        if (ch == '\'')
+        {
+            iNext = SkipQuoted(pch, cch, i, '\'');
+            if (iNext == -1)
+            {
+                fSuccess = false;       // unterminated; leave it for the database to report
+                break;
+            }
+
+            // A word directly before the quote, such as the X of X'1F', is a prefix that is part of the literal.
+            bool fTyped = pchPrev && (IsAnyWord(pchPrev, cchPrev, aszTypedLiterals) || pchPrev + cchPrev == &pch[i]);
+
+            if (!fTyped && (fPrefixed ? fLiftNational : fLiftStrings))
+            {
+                Object value(StringValue(&pch[i], iNext - i, fUnicode));
+                if (!value || PyList_Append(values, value) != 0)
+                {
+                    pyodbc_free(pb);
+                    return false;
+                }
+                if (fPrefixed)
+                    cb--;               // remove the N
+                pb[cb++] = '?';
+                fChanged = true;
+            }
+            else
+            {
+                memcpy(&pb[cb], &pch[i], (size_t)(iNext - i));
+                cb += iNext - i;
+            }
+            i = iNext;
+            continue;
+        }
+
+        if (IsDigit(ch) || (ch == '.' && i + 1 < cch && IsDigit(pch[i + 1])))
+        {
+            bool fDecimal = false;
+            iNext = i;
+            while (iNext < cch && IsDigit(pch[iNext]))
+                iNext++;
+            if (iNext < cch && pch[iNext] == '.')
+            {
+                fDecimal = true;
+                iNext++;
+                while (iNext < cch && IsDigit(pch[iNext]))
+                    iNext++;
+            }
+
+            bool fSimple = !(iNext < cch && (IsIdentifierChar(pch[iNext]) || pch[iNext] == '.'));
+            if (!fSimple)
+            {
+                // An exponent, a hexadecimal binary literal such as 0x1F, etc.  Copy all of it.
+                while (iNext < cch && (IsIdentifierChar(pch[iNext]) || pch[iNext] == '.' ||
+                                       ((pch[iNext] == '+' || pch[iNext] == '-') && (pch[iNext - 1] == 'e' || pch[iNext - 1] == 'E'))))
+                    iNext++;
+            }
+
+            if (fSimple && !fPrevTop && typeDepth == -1 && ordinalDepth == -1 && iNext - i <= cchMaxNumber)
+            {
+                Object value(NumberValue(&pch[i], iNext - i, fDecimal));
+                if (!value || PyList_Append(values, value) != 0)
+                {
+                    pyodbc_free(pb);
+                    return false;
+                }
+                pb[cb++] = '?';
+                fChanged = true;
+            }
+            else
+            {
+                memcpy(&pb[cb], &pch[i], (size_t)(iNext - i));
+                cb += iNext - i;
+            }
+            i = iNext;
+            continue;
+        }
+
+        switch (ch)
+        {
+        case '"':
+        case '`':
+            iNext = SkipQuoted(pch, cch, i, ch);
+            break;
+
+        case '[':
+            iNext = SkipQuoted(pch, cch, i, ']');
+            break;
+
+        case '{':
+            iNext = SkipEscape(pch, cch, i);
+            break;
+
+        case '?':
+            iNext = -1;                 // already parameterized
+            break;
+
+        case '(':
+            depth++;
+            if (pchPrev && IsAnyWord(pchPrev, cchPrev, aszSizedTypes) && typeDepth == -1)
+                typeDepth = depth;
+            fTop = fPrevTop;            // TOP (10)
+            iNext = i + 1;
+            break;
+
+        case ')':
+            if (typeDepth == depth)
+                typeDepth = -1;
+            if (ordinalDepth == depth)
+                ordinalDepth = -1;
+            depth--;
+            iNext = i + 1;
+            break;
+
+        case ';':
+            ordinalDepth = -1;
+            iNext = i + 1;
+            break;
+
+        default:
+            iNext = i + 1;
+            break;
+        }
+
+        if (iNext == -1)
+        {
+            fSuccess = false;
+            break;
+        }
+
+        memcpy(&pb[cb], &pch[i], (size_t)(iNext - i));
+        cb += iNext - i;
+        i = iNext;
+    }
+
+    if (!fSuccess || !fChanged)
+    {
+        pyodbc_free(pb);
+        return true;
+    }
+
+    PyObject* sql;
+    if (fUnicode)
+        sql = PyUnicode_DecodeUTF8(pb, cb, "strict");
+    else
+        sql = PyBytes_FromStringAndSize(pb, cb);
+    pyodbc_free(pb);
+
+    if (!sql)
+        return false;
+
+    pNewSql = InternSQL(cur->cnxn, sql);
+    if (!pNewSql)
+        return false;
+
+    pNewParams = PyList_AsTuple(values);
+    if (!pNewParams)
+    {
+        Py_DECREF(pNewSql);
+        pNewSql = 0;
+        return false;
+    }
+
+    return true;
+}
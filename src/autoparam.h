@@ -0,0 +1,28 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef AUTOPARAM_H
+#define AUTOPARAM_H
+
+struct Cursor;
+
+/*
+ * Used by execute when the connection's auto_parameterize attribute is set and no parameters were passed.  Replaces
+ * the numeric and string literals in a SELECT, INSERT, UPDATE, DELETE, MERGE, or WITH statement with parameter
+ * markers.  New references to the normalized SQL and a tuple of the literals' values are returned in pNewSql and
+ * pNewParams.  Statements that normalize to the same SQL are given the same SQL object.
+ *
+ * If the SQL can't or needn't be parameterized, pNewSql is set to zero and true is returned.  If an error occurs, an
+ * exception is set and false is returned.
+ */
+bool AutoParameterize(Cursor* cur, PyObject* pSql, PyObject*& pNewSql, PyObject*& pNewParams);
+
+#endif // AUTOPARAM_H
@@ -0,0 +1,159 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Adaptive preparation of parameterless statements.  Execute passes SQL without parameters to SQLExecDirect, which is
+// best for statements run once, but programs also run the same parameterless statement over and over.  Once the
+// connection's auto_prepare_threshold is set, each connection counts the executions of each SQL text in a small
+// table, and a statement executed that many times is prepared instead.  Its cursor then reuses the prepared statement
+// as it does for parameterized SQL, as can the statement cache.
+//
+// The table is direct mapped by the SQL's hash, so a lookup is one comparison and a statement run rarely is simply
+// replaced by the next one that maps to its slot.  While a statement is below the threshold, the table also keeps the
+// SQL converted to SQLWCHARs (or the connection's encoding) so it isn't converted again on every execute.
+//
+// The table is only used while holding the GIL.  Cursors take their own reference to the encoded SQL, so it can be
+// replaced while they execute it.
+
+#include "pyodbc.h"
+#include "autoprepare.h"
+#include "connection.h"
+#include "cursor.h"
+#include "stmtcache.h"
+#include "sqlwchar.h"
+#include "wrapper.h"
+
+// The number of entries in each connection's table, a power of two.
+static const Py_hash_t cExecCounts = 64;
+
+static void ClearEntry(ExecCount& entry)
+{
+    Py_XDECREF(entry.pSql);
+    Py_XDECREF(entry.encoded);
+    entry.pSql    = 0;
+    entry.hash    = 0;
+    entry.count   = 0;
+    entry.encoded = 0;
+}
+
+static PyObject* EncodeSQL(Connection* cnxn, PyObject* pSql)
+{
+    // Returns a new reference to the SQL in the form passed to SQLExecDirect (see ExecCount.encoded), or zero with an
+    // exception set.
+
+    if (cnxn->encoding)
+        return Connection_EncodeText(cnxn, pSql);
+
+    Py_ssize_t len = SQLWCHAR_Length(pSql);
+    if (len == -1)
+        return 0;
+
+    PyObject* encoded = PyBytes_FromStringAndSize(0, (Py_ssize_t)sizeof(SQLWCHAR) * (len + 1));
+    if (!encoded)
+        return 0;
+
+    if (!SQLWCHAR_Copy((SQLWCHAR*)PyBytes_AS_STRING(encoded), pSql))
+    {
+        Py_DECREF(encoded);
+        return 0;
+    }
+
+    return encoded;
+}
+
+bool AutoPrepare_Count(Cursor* cur, PyObject* pSql, bool& fPrepare, PyObject*& encoded)
+{
+    Connection* cnxn = cur->cnxn;
+
+    fPrepare = false;
+    encoded  = 0;
+
+    I(cnxn->autoprepare_threshold > 0 && cnxn->execcounts != 0);
+
+    Py_hash_t hash = PyObject_Hash(pSql);
+    if (hash == -1)
+    {
+        PyErr_Clear();
+        return true;
+    }
+
+    ExecCount& entry = cnxn->execcounts[hash & (cExecCounts - 1)];
+
+    if (entry.pSql == 0 || entry.hash != hash || !IsSameSQL(entry.pSql, pSql))
+    {
+        ClearEntry(entry);
+        Py_INCREF(pSql);
+        entry.pSql = pSql;
+        entry.hash = hash;
+    }
+
+    if (entry.count < cnxn->autoprepare_threshold)
+        entry.count++;
+
+    if (entry.count >= cnxn->autoprepare_threshold)
+    {
+        // From now on the statement is prepared, so the encoded SQL is no longer needed.
+        Py_XDECREF(entry.encoded);
+        entry.encoded = 0;
+        fPrepare = true;
+        return true;
+    }
+
+#if PY_MAJOR_VERSION < 3
+    if (!PyUnicode_Check(pSql))
+        return true;
+#endif
+
+    if (entry.encoded == 0)
+    {
+        entry.encoded = EncodeSQL(cnxn, pSql);
+        if (entry.encoded == 0)
+            return false;
+    }
+
+    Py_INCREF(entry.encoded);
+    encoded = entry.encoded;
+    return true;
+}
+
+bool AutoPrepare_SetThreshold(Connection* cnxn, long threshold)
+{
+    if (threshold == 0)
+    {
+        AutoPrepare_Clear(cnxn);
+    }
+    else if (cnxn->execcounts == 0)
+    {
+        cnxn->execcounts = (ExecCount*)pyodbc_malloc(sizeof(ExecCount) * (size_t)cExecCounts);
+        if (cnxn->execcounts == 0)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+        memset(cnxn->execcounts, 0, sizeof(ExecCount) * (size_t)cExecCounts);
+    }
+
+    cnxn->autoprepare_threshold = threshold;
+    return true;
+}
+
+void AutoPrepare_Clear(Connection* cnxn)
+{
+    cnxn->autoprepare_threshold = 0;
+
+    if (cnxn->execcounts == 0)
+        return;
+
+    for (Py_hash_t i = 0; i < cExecCounts; i++)
+        ClearEntry(cnxn->execcounts[i]);
+
+    pyodbc_free(cnxn->execcounts);
+    cnxn->execcounts = 0;
+}
@@ -0,0 +1,54 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef AUTOPREPARE_H
+#define AUTOPREPARE_H
+
+struct Connection;
+struct Cursor;
+
+// How many times a parameterless statement has been executed on a connection.  See autoprepare.cpp.
+struct ExecCount
+{
+    // The SQL, or zero if the entry is empty.
+    PyObject* pSql;
+    Py_hash_t hash;
+
+    long count;
+
+    // The SQL as it is passed to SQLExecDirect: a bytes object holding NULL terminated SQLWCHARs, or the text in the
+    // connection's encoding if it has one.  Zero until the SQL is executed directly, and always zero for a Python 2
+    // str, which is passed as is.
+    PyObject* encoded;
+};
+
+/*
+ * Counts an execution of the parameterless SQL `pSql` by `cur`, whose connection's auto_prepare_threshold must not be
+ * zero.  Sets fPrepare to true if the SQL has now been executed often enough that it should be prepared.  Otherwise
+ * `encoded` is set to a new reference to the encoded form of the SQL (see ExecCount), or zero if the SQL should be
+ * passed as is.
+ *
+ * If an error occurs, an exception is set and false is returned.
+ */
+bool AutoPrepare_Count(Cursor* cur, PyObject* pSql, bool& fPrepare, PyObject*& encoded);
+
+/*
+ * Sets the number of executions after which a parameterless statement is prepared, allocating or freeing the
+ * connection's table.  Zero disables auto-prepare.
+ */
+bool AutoPrepare_SetThreshold(Connection* cnxn, long threshold);
+
+/*
+ * Frees the connection's table.
+ */
+void AutoPrepare_Clear(Connection* cnxn);
+
+#endif // AUTOPREPARE_H
@@ -17,6 +17,12 @@
 #include "wrapper.h"
 #include "cnxninfo.h"
 #include "sqlwchar.h"
+#include "procedure.h"
+#include "prepared.h"
+#include "stmtcache.h"
+#include "adapters.h"
+#include "autoprepare.h"
+#include "pool.h"
 
 static char connection_doc[] =
     "Connection objects manage connections to the database.\n"
@@ -140,7 +146,28 @@ static bool Connect(PyObject* pConnectString, HDBC hdbc, bool fAnsi, long timeou
 }
 
 
-PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout, bool fReadOnly)
+static bool IsUTF8(const char* szEncoding)
+{
+    // The spellings Python's codec lookup accepts for UTF-8, ignoring case.
+    static const char* const names[] = { "utf-8", "utf8", "utf_8", "u8" };
+
+    for (size_t i = 0; i < _countof(names); i++)
+    {
+        const char* p1 = szEncoding;
+        const char* p2 = names[i];
+        while (*p1 && tolower((unsigned char)*p1) == *p2)
+        {
+            p1++;
+            p2++;
+        }
+        if (*p1 == 0 && *p2 == 0)
+            return true;
+    }
+    return false;
+}
+
+PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout, bool fReadOnly,
+                         PyObject* encoding)
 {
     // pConnectString
     //   A string or unicode object.  (This must be checked by the caller.)
@@ -150,6 +177,17 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     //
     // fUnicodeResults
     //   If true, return strings in rows as unicode objects.
+    //
+    // encoding
+    //   Zero or a bytes object naming the codec to use for text instead of SQLWCHAR.
+
+    if (encoding)
+    {
+        // Raises LookupError for a codec that doesn't exist.
+        Object codec(PyCodec_Encoder(PyBytes_AS_STRING(encoding)));
+        if (!codec)
+            return 0;
+    }
 
     //
     // Allocate HDBC and connect
@@ -199,9 +237,44 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     cnxn->searchescape    = 0;
     cnxn->timeout         = 0;
     cnxn->unicode_results = fUnicodeResults;
+    cnxn->encoding        = encoding;
+    cnxn->utf8            = encoding && IsUTF8(PyBytes_AS_STRING(encoding));
     cnxn->conv_count      = 0;
     cnxn->conv_types      = 0;
     cnxn->conv_funcs      = 0;
+    cnxn->adapters         = 0;
+    cnxn->adapter_count    = 0;
+    cnxn->adapter_capacity = 0;
+    cnxn->adapter_last     = 0;
+
+    Py_XINCREF(encoding);
+
+    cnxn->stream_chunk_size  = DEFAULT_STREAM_CHUNK_SIZE;
+    cnxn->numeric_struct     = false;
+    cnxn->autoparameterize   = false;
+    cnxn->autoparam_sql      = 0;
+    cnxn->autoprepare_threshold = 0;
+    cnxn->execcounts         = 0;
+    cnxn->paramtypes_cache   = 0;
+    cnxn->stmtcache          = 0;
+    cnxn->stmtcache_count    = 0;
+    cnxn->stmtcache_capacity = 0;
+    cnxn->stmtcache_hits     = 0;
+    cnxn->stmtcache_misses   = 0;
+    cnxn->hstmtpool          = 0;
+    cnxn->hstmtpool_count    = 0;
+    cnxn->hstmtpool_capacity = 0;
+    cnxn->pool               = 0;
+    cnxn->alive_checked      = 0;
+    cnxn->alive_interval     = DEFAULT_ALIVE_INTERVAL;
+    cnxn->connection_dead_unsupported = false;
+    cnxn->ping_sql           = 0;
+
+    if (!StatementCache_Resize(cnxn, DEFAULT_STATEMENT_CACHE_SIZE) || !HandlePool_Resize(cnxn, DEFAULT_HANDLE_POOL_SIZE))
+    {
+        Py_DECREF(cnxn);
+        return 0;
+    }
 
     //
     // Initialize autocommit mode.
@@ -264,6 +337,7 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi,
     cnxn->wvarchar_maxlength     = p->wvarchar_maxlength;
     cnxn->binary_maxlength       = p->binary_maxlength;
     cnxn->need_long_data_len     = p->need_long_data_len;
+    cnxn->numeric_struct         = p->odbc_major >= 3;
 
     return reinterpret_cast<PyObject*>(cnxn);
 }
@@ -284,6 +358,96 @@ static void _clear_conv(Connection* cnxn)
     }
 }
 
+static bool SetTimeout(Connection* cnxn, intptr_t timeout);
+
+void Connection_GetSettings(Connection* cnxn, ConnectionSettings& settings)
+{
+    settings.nAutoCommit           = cnxn->nAutoCommit;
+    settings.timeout               = cnxn->timeout;
+    settings.autoparameterize      = cnxn->autoparameterize;
+    settings.autoprepare_threshold = cnxn->autoprepare_threshold;
+    settings.stmtcache_capacity    = cnxn->stmtcache_capacity;
+    settings.numeric_struct        = cnxn->numeric_struct;
+    settings.stream_chunk_size     = cnxn->stream_chunk_size;
+    settings.hstmtpool_capacity    = cnxn->hstmtpool_capacity;
+}
+
+bool Connection_Reset(Connection* cnxn, const ConnectionSettings& settings)
+{
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        RaiseErrorV(0, ProgrammingError, "The connection is closed.");
+        return false;
+    }
+
+    SQLRETURN ret;
+
+    if (cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLEndTran(SQL_HANDLE_DBC, cnxn->hdbc, SQL_ROLLBACK);
+        Py_END_ALLOW_THREADS
+        if (cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            RaiseErrorV(0, ProgrammingError, "The connection was closed.");
+            return false;
+        }
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLEndTran(SQL_ROLLBACK)", cnxn->hdbc, SQL_NULL_HANDLE);
+            return false;
+        }
+    }
+
+    if (cnxn->nAutoCommit != settings.nAutoCommit)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLSetConnectAttr(cnxn->hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)settings.nAutoCommit, SQL_IS_UINTEGER);
+        Py_END_ALLOW_THREADS
+        if (cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            RaiseErrorV(0, ProgrammingError, "The connection was closed.");
+            return false;
+        }
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLSetConnectAttr(SQL_ATTR_AUTOCOMMIT)", cnxn->hdbc, SQL_NULL_HANDLE);
+            return false;
+        }
+        cnxn->nAutoCommit = settings.nAutoCommit;
+    }
+
+    if (cnxn->timeout != settings.timeout && !SetTimeout(cnxn, settings.timeout))
+        return false;
+
+    if (cnxn->autoprepare_threshold != settings.autoprepare_threshold &&
+        !AutoPrepare_SetThreshold(cnxn, settings.autoprepare_threshold))
+    {
+        return false;
+    }
+
+    if (cnxn->stmtcache_capacity != settings.stmtcache_capacity &&
+        !StatementCache_Resize(cnxn, settings.stmtcache_capacity))
+    {
+        return false;
+    }
+
+    if (cnxn->hstmtpool_capacity != settings.hstmtpool_capacity &&
+        !HandlePool_Resize(cnxn, settings.hstmtpool_capacity))
+    {
+        return false;
+    }
+
+    cnxn->autoparameterize  = settings.autoparameterize;
+    cnxn->numeric_struct    = settings.numeric_struct;
+    cnxn->stream_chunk_size = settings.stream_chunk_size;
+
+    _clear_conv(cnxn);
+    InputAdapters_Clear(cnxn);
+
+    return true;
+}
+
 static char conv_clear_doc[] =
     "clear_output_converters() --> None\n\n"
     "Remove all output converter functions.";
@@ -310,6 +474,11 @@ static int Connection_clear(PyObject* self)
 
         TRACE("cnxn.clear cnxn=%p hdbc=%d\n", cnxn, cnxn->hdbc);
 
+        // The cached statements and pooled handles must be freed while the HDBC is still valid.  (Freeing cached
+        // statements can add to the pool, so it is cleared last.)
+        StatementCache_Clear(cnxn);
+        HandlePool_Clear(cnxn);
+
         Py_BEGIN_ALLOW_THREADS
         if (cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
             SQLEndTran(SQL_HANDLE_DBC, cnxn->hdbc, SQL_ROLLBACK);
@@ -323,8 +492,26 @@ static int Connection_clear(PyObject* self)
 
     Py_XDECREF(cnxn->searchescape);
     cnxn->searchescape = 0;
+
+    Py_XDECREF(cnxn->paramtypes_cache);
+    cnxn->paramtypes_cache = 0;
+
+    Py_XDECREF(cnxn->autoparam_sql);
+    cnxn->autoparam_sql = 0;
+
+    AutoPrepare_Clear(cnxn);
     
     _clear_conv(cnxn);
+    InputAdapters_Clear(cnxn);
+
+    // A connection closed while checked out from a pool gives up its place in it.
+    if (cnxn->pool)
+    {
+        PyObject* pool = cnxn->pool;
+        cnxn->pool = 0;
+        Pool_Discard(pool);
+        Py_DECREF(pool);
+    }
 
     return 0;
 }
@@ -332,6 +519,10 @@ static int Connection_clear(PyObject* self)
 static void Connection_dealloc(PyObject* self)
 {
     Connection_clear(self);
+
+    // The encoding is kept until now since cursors may still be reading data when the connection is closed.
+    Py_XDECREF(((Connection*)self)->encoding);
+
     PyObject_Del(self);
 }
 
@@ -369,6 +560,33 @@ static PyObject* Connection_cursor(PyObject* self, PyObject* args)
     return (PyObject*)Cursor_New(cnxn);
 }
 
+static PyObject* Connection_procedure(PyObject* self, PyObject* args)
+{
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* name;
+    PyObject* signature;
+    if (!PyArg_ParseTuple(args, "OO", &name, &signature))
+        return 0;
+
+    return Procedure_New(cnxn, name, signature);
+}
+
+static PyObject* Connection_prepare(PyObject* self, PyObject* args)
+{
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    PyObject* pSql;
+    if (!PyArg_ParseTuple(args, "O", &pSql))
+        return 0;
+
+    return PreparedStatement_New(cnxn, pSql);
+}
+
 static PyObject* Connection_execute(PyObject* self, PyObject* args)
 {
     PyObject* result = 0;
@@ -667,6 +885,39 @@ static PyObject* Connection_rollback(PyObject* self, PyObject* args)
 static char cursor_doc[] = 
     "Return a new Cursor object using the connection.";
     
+static char procedure_doc[] =
+    "procedure(name, signature) --> Procedure\n"
+    "\n"
+    "Prepare a call to the stored procedure `name` and bind its parameters once.\n"
+    "\n"
+    "`signature` is a sequence with one entry per parameter.  Each entry is a\n"
+    "prototype value or SQLParameter that fixes the parameter's type and direction;\n"
+    "strings and binary values are given room for the SQLParameter's ostr_len\n"
+    "characters (2048 for prototype values).\n"
+    "\n"
+    "Calling the returned object with the input and input/output values only copies\n"
+    "them into the bound buffers and executes the call, returning a tuple of the\n"
+    "output and input/output values:\n"
+    "\n"
+    "  proc = cnxn.procedure('add_one', (0, SQLParameter(0, SQL_PARAM_OUTPUT)))\n"
+    "  (result,) = proc(41)\n"
+    "\n"
+    "This is a convenience method that is not part of the DB API.";
+
+static char prepare_doc[] =
+    "prepare(sql) --> PreparedStatement\n"
+    "\n"
+    "Prepare `sql` once on a private cursor and return an object whose execute and\n"
+    "executemany methods run it without preparing it again:\n"
+    "\n"
+    "  stmt = cnxn.prepare('select name from users where id = ?')\n"
+    "  name = stmt.execute(42).fetchone()[0]\n"
+    "\n"
+    "Unlike a cursor's prepared statement, it is kept however many other cursors are\n"
+    "used on the connection.\n"
+    "\n"
+    "This is a convenience method that is not part of the DB API.";
+
 static char execute_doc[] =
     "execute(sql, [params]) --> Cursor\n"
     "\n"
@@ -733,6 +984,488 @@ static int Connection_setautocommit(PyObject* self, PyObject* value, void* closu
 }
 
 
+static PyObject* Connection_getstatementcachesize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->stmtcache_capacity);
+}
+
+static int Connection_setstatementcachesize(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the statement_cache_size attribute.");
+        return -1;
+    }
+    long capacity = PyInt_AsLong(value);
+    if (capacity == -1 && PyErr_Occurred())
+        return -1;
+    if (capacity < 0 || capacity > INT_MAX)
+    {
+        PyErr_SetString(PyExc_ValueError, "statement_cache_size must be between 0 and INT_MAX.");
+        return -1;
+    }
+
+    if (!StatementCache_Resize(cnxn, (int)capacity))
+        return -1;
+
+    return 0;
+}
+
+static PyObject* Connection_gethandlepoolsize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->hstmtpool_capacity);
+}
+
+static int Connection_sethandlepoolsize(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the statement_handle_pool_size attribute.");
+        return -1;
+    }
+    long capacity = PyInt_AsLong(value);
+    if (capacity == -1 && PyErr_Occurred())
+        return -1;
+    if (capacity < 0 || capacity > INT_MAX)
+    {
+        PyErr_SetString(PyExc_ValueError, "statement_handle_pool_size must be between 0 and INT_MAX.");
+        return -1;
+    }
+
+    if (!HandlePool_Resize(cnxn, (int)capacity))
+        return -1;
+
+    return 0;
+}
+
+static PyObject* Connection_getstreamchunksize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyLong_FromSsize_t((Py_ssize_t)cnxn->stream_chunk_size);
+}
+
+static int Connection_setstreamchunksize(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the stream_chunk_size attribute.");
+        return -1;
+    }
+    Py_ssize_t cb = PyNumber_AsSsize_t(value, PyExc_OverflowError);
+    if (cb == -1 && PyErr_Occurred())
+        return -1;
+    if (cb < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "stream_chunk_size must be at least 1.");
+        return -1;
+    }
+
+    cnxn->stream_chunk_size = (SQLLEN)cb;
+    return 0;
+}
+
+static PyObject* Connection_getnumericstruct(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    if (cnxn->numeric_struct)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static int Connection_setnumericstruct(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the numeric_struct attribute.");
+        return -1;
+    }
+
+    int n = PyObject_IsTrue(value);
+    if (n == -1)
+        return -1;
+
+    cnxn->numeric_struct = (n != 0);
+    return 0;
+}
+
+static PyObject* Connection_getautoparameterize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    if (cnxn->autoparameterize)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static int Connection_setautoparameterize(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the auto_parameterize attribute.");
+        return -1;
+    }
+
+    int n = PyObject_IsTrue(value);
+    if (n == -1)
+        return -1;
+
+    cnxn->autoparameterize = (n != 0);
+    return 0;
+}
+
+static PyObject* Connection_getautopreparethreshold(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyInt_FromLong(cnxn->autoprepare_threshold);
+}
+
+static int Connection_setautopreparethreshold(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the auto_prepare_threshold attribute.");
+        return -1;
+    }
+    long threshold = PyInt_AsLong(value);
+    if (threshold == -1 && PyErr_Occurred())
+        return -1;
+    if (threshold < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "auto_prepare_threshold must not be negative.");
+        return -1;
+    }
+
+    if (!AutoPrepare_SetThreshold(cnxn, threshold))
+        return -1;
+
+    return 0;
+}
+
+struct PingInfo
+{
+    const char* szDBMS;         // a prefix of the SQL_DBMS_NAME
+    const char* szSql;
+};
+
+static const PingInfo aPing[] =
+{
+    // Databases that can't select without a table.  Everything else uses "select 1".
+    { "Oracle",    "select 1 from dual" },
+    { "DB2",       "select 1 from sysibm.sysdummy1" },
+    { "Informix",  "select 1 from systables where tabid = 1" },
+    { "Firebird",  "select 1 from rdb$database" },
+    { "InterBase", "select 1 from rdb$database" },
+    { "HDB",       "select 1 from dummy" },
+};
+
+static const char* GetPingSQL(Connection* cnxn)
+{
+    if (cnxn->ping_sql)
+        return cnxn->ping_sql;
+
+    char szName[100];
+    SQLSMALLINT cch = 0;
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetInfo(cnxn->hdbc, SQL_DBMS_NAME, szName, (SQLSMALLINT)sizeof(szName), &cch);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret))
+        return "select 1";
+
+    cnxn->ping_sql = "select 1";
+
+    for (size_t i = 0; i < _countof(aPing); i++)
+    {
+        size_t cchPrefix = strlen(aPing[i].szDBMS);
+        size_t j = 0;
+        while (j < cchPrefix && szName[j] && toupper(szName[j]) == toupper(aPing[i].szDBMS[j]))
+            j++;
+        if (j == cchPrefix)
+        {
+            cnxn->ping_sql = aPing[i].szSql;
+            break;
+        }
+    }
+
+    return cnxn->ping_sql;
+}
+
+static bool Ping(Connection* cnxn)
+{
+    // Executes a trivial query on a statement handle from the connection's pool.
+
+    const char* szSql = GetPingSQL(cnxn);
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+        return false;
+
+    HSTMT hstmt;
+    if (!AllocStatementHandle(cnxn, hstmt))
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLExecDirect(hstmt, (SQLCHAR*)szSql, SQL_NTS);
+    Py_END_ALLOW_THREADS
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+        return false;
+
+    FreeStatementHandle(cnxn, hstmt);
+
+    return SQL_SUCCEEDED(ret);
+}
+
+bool Connection_IsAlive(Connection* cnxn, bool fFast)
+{
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+        return false;
+
+    double now = MonotonicSeconds();
+
+    if (fFast && cnxn->alive_checked != 0 && now - cnxn->alive_checked < cnxn->alive_interval)
+        return true;
+
+    bool fAlive = false;
+    bool fChecked = false;
+
+    if (fFast && !cnxn->connection_dead_unsupported)
+    {
+        // The driver tracks this from the last operation, so it doesn't contact the server.
+
+        SQLUINTEGER dead = SQL_CD_FALSE;
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLGetConnectAttr(cnxn->hdbc, SQL_ATTR_CONNECTION_DEAD, &dead, SQL_IS_UINTEGER, 0);
+        Py_END_ALLOW_THREADS
+
+        if (cnxn->hdbc == SQL_NULL_HANDLE)
+            return false;
+
+        if (SQL_SUCCEEDED(ret))
+        {
+            fAlive   = (dead != SQL_CD_TRUE);
+            fChecked = true;
+        }
+        else
+        {
+            cnxn->connection_dead_unsupported = true;
+        }
+    }
+
+    if (!fChecked)
+        fAlive = Ping(cnxn);
+
+    cnxn->alive_checked = fAlive ? now : 0;
+
+    return fAlive;
+}
+
+static char is_alive_doc[] =
+    "is_alive(fast=True) --> bool\n"
+    "\n"
+    "Returns True if the connection is open and the database can be reached.\n"
+    "\n"
+    "By default, this asks the driver whether the connection is dead\n"
+    "(SQL_ATTR_CONNECTION_DEAD), which doesn't contact the server, and reuses a\n"
+    "True result for alive_check_interval seconds.  If the driver doesn't support\n"
+    "that, or fast is False, a trivial query is executed instead.\n"
+    "\n"
+    "This is a convenience method that is not part of the DB API.";
+
+static PyObject* Connection_is_alive(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    // A closed connection is not alive, so this doesn't use Connection_Validate.
+
+    Connection* cnxn = (Connection*)self;
+
+    PyObject* pFast = 0;
+    static char* kwlist[] = { "fast", 0 };
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &pFast))
+        return 0;
+
+    int fFast = pFast ? PyObject_IsTrue(pFast) : 1;
+    if (fFast == -1)
+        return 0;
+
+    if (Connection_IsAlive(cnxn, fFast != 0))
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+static PyObject* Connection_getaliveinterval(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyFloat_FromDouble(cnxn->alive_interval);
+}
+
+static int Connection_setaliveinterval(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the alive_check_interval attribute.");
+        return -1;
+    }
+    double interval = PyFloat_AsDouble(value);
+    if (interval == -1 && PyErr_Occurred())
+        return -1;
+    if (interval < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "alive_check_interval must not be negative.");
+        return -1;
+    }
+
+    cnxn->alive_interval = interval;
+    cnxn->alive_checked  = 0;
+
+    return 0;
+}
+
+static char statement_cache_info_doc[] =
+    "statement_cache_info() --> (hits, misses, maxsize, currsize)\n"
+    "\n"
+    "Returns the statistics of the prepared statement cache.  A hit is a statement\n"
+    "taken from the cache instead of being prepared; a miss is one that had to be\n"
+    "prepared while the cache was enabled.";
+
+static PyObject* Connection_statement_cache_info(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return Py_BuildValue("(llii)", cnxn->stmtcache_hits, cnxn->stmtcache_misses, cnxn->stmtcache_capacity,
+                         cnxn->stmtcache_count);
+}
+
+
+PyObject* Connection_DecodeText(Connection* cnxn, const char* pch, Py_ssize_t cb)
+{
+    I(cnxn->encoding != 0);
+
+    if (cnxn->utf8)
+        return PyUnicode_DecodeUTF8(pch, cb, "strict");
+
+    return PyUnicode_Decode(pch, cb, PyBytes_AS_STRING(cnxn->encoding), "strict");
+}
+
+PyObject* Connection_EncodeText(Connection* cnxn, PyObject* text)
+{
+    I(cnxn->encoding != 0);
+    I(PyUnicode_Check(text));
+
+    if (cnxn->utf8)
+        return PyUnicode_AsUTF8String(text);
+
+    PyObject* encoded = PyUnicode_AsEncodedString(text, PyBytes_AS_STRING(cnxn->encoding), "strict");
+    if (encoded && !PyBytes_Check(encoded))
+    {
+        PyErr_Format(PyExc_TypeError, "The %s codec did not return bytes.", PyBytes_AS_STRING(cnxn->encoding));
+        Py_DECREF(encoded);
+        return 0;
+    }
+    return encoded;
+}
+
+
+static PyObject* Connection_getencoding(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    if (!cnxn->encoding)
+        Py_RETURN_NONE;
+
+    return PyString_FromString(PyBytes_AS_STRING(cnxn->encoding));
+}
+
+
 static PyObject* Connection_getsearchescape(PyObject* self, void* closure)
 {
     UNUSED(closure);
@@ -792,6 +1525,14 @@ static int Connection_settimeout(PyObject* self, PyObject* value, void* closure)
         return -1;
     }
 
+    if (!SetTimeout(cnxn, timeout))
+        return -1;
+
+    return 0;
+}
+
+static bool SetTimeout(Connection* cnxn, intptr_t timeout)
+{
     SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
     ret = SQLSetConnectAttr(cnxn->hdbc, SQL_ATTR_CONNECTION_TIMEOUT, (SQLPOINTER)timeout, SQL_IS_UINTEGER);
@@ -799,12 +1540,15 @@ static int Connection_settimeout(PyObject* self, PyObject* value, void* closure)
     if (!SQL_SUCCEEDED(ret))
     {
         RaiseErrorFromHandle("SQLSetConnectAttr", cnxn->hdbc, SQL_NULL_HANDLE);
-        return -1;
+        return false;
     }
 
     cnxn->timeout = timeout;
 
-    return 0;
+    // Pooled handles still have the old query timeout.
+    HandlePool_Empty(cnxn);
+
+    return true;
 }
 
 static bool _add_converter(PyObject* self, SQLSMALLINT sqltype, PyObject* func)
@@ -895,6 +1639,53 @@ static PyObject* Connection_conv_add(PyObject* self, PyObject* args)
     Py_RETURN_NONE;
 }
 
+static char adapter_add_doc[] =
+    "add_input_adapter(pytype, func) --> None\n"
+    "\n"
+    "Register an input adapter function that will be called whenever a parameter of\n"
+    "exactly the given type is passed to execute.  Adapters are only used for types\n"
+    "pyodbc does not bind itself.  numpy integers, floats and bools and uuid.UUID are\n"
+    "bound without registering anything.\n"
+    "\n"
+    "pytype\n"
+    "  The Python type to adapt.  Subclasses are not included.\n"
+    "\n"
+    "func\n"
+    "  The adapter function which will be called with a single parameter, the\n"
+    "  value, and should return a value of a type pyodbc can bind, such as a str,\n"
+    "  int, or Decimal.  Adapters are only used for input parameters.";
+
+static PyObject* Connection_adapter_add(PyObject* self, PyObject* args)
+{
+    PyObject* pytype;
+    PyObject* func;
+    if (!PyArg_ParseTuple(args, "O!O", &PyType_Type, &pytype, &func))
+        return 0;
+
+    if (!PyCallable_Check(func))
+    {
+        PyErr_SetString(PyExc_TypeError, "func must be callable");
+        return 0;
+    }
+
+    if (!InputAdapters_Add((Connection*)self, (PyTypeObject*)pytype, func))
+        return 0;
+
+    Py_RETURN_NONE;
+}
+
+static char adapter_clear_doc[] =
+    "clear_input_adapters() --> None\n\n"
+    "Remove all input adapter functions.";
+
+static PyObject* Connection_adapter_clear(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    InputAdapters_Clear((Connection*)self);
+    Py_RETURN_NONE;
+}
+
 static char enter_doc[] = "__enter__() -> self.";
 static PyObject* Connection_enter(PyObject* self, PyObject* args)
 {
@@ -931,11 +1722,17 @@ static struct PyMethodDef Connection_methods[] =
     { "cursor",                  Connection_cursor,          METH_NOARGS,  cursor_doc     },
     { "close",                   Connection_close,           METH_NOARGS,  close_doc      },
     { "execute",                 Connection_execute,         METH_VARARGS, execute_doc    },
+    { "procedure",               Connection_procedure,       METH_VARARGS, procedure_doc  },
+    { "prepare",                 Connection_prepare,         METH_VARARGS, prepare_doc    },
     { "commit",                  Connection_commit,          METH_NOARGS,  commit_doc     },
     { "rollback",                Connection_rollback,        METH_NOARGS,  rollback_doc   },
     { "getinfo",                 Connection_getinfo,         METH_VARARGS, getinfo_doc    },
     { "add_output_converter",    Connection_conv_add,        METH_VARARGS, conv_add_doc   },
     { "clear_output_converters", Connection_conv_clear,      METH_NOARGS,  conv_clear_doc },
+    { "add_input_adapter",       Connection_adapter_add,     METH_VARARGS, adapter_add_doc   },
+    { "clear_input_adapters",    Connection_adapter_clear,   METH_NOARGS,  adapter_clear_doc },
+    { "statement_cache_info",    Connection_statement_cache_info, METH_NOARGS, statement_cache_info_doc },
+    { "is_alive",                (PyCFunction)Connection_is_alive, METH_VARARGS|METH_KEYWORDS, is_alive_doc },
     { "__enter__",               Connection_enter,           METH_NOARGS,  enter_doc      },
     { "__exit__",                Connection_exit,            METH_VARARGS, exit_doc       },
     
@@ -950,6 +1747,37 @@ static PyGetSetDef Connection_getseters[] = {
       "Returns True if the connection is in autocommit mode; False otherwise.", 0 },
     { "timeout", Connection_gettimeout, Connection_settimeout,
       "The timeout in seconds, zero means no timeout.", 0 },
+    { "statement_cache_size", Connection_getstatementcachesize, Connection_setstatementcachesize,
+      "The number of prepared statements kept for reuse when cursors switch to other\n"
+      "SQL or are closed.  Zero, the default, disables the cache.", 0 },
+    { "statement_handle_pool_size", Connection_gethandlepoolsize, Connection_sethandlepoolsize,
+      "The number of statement handles kept for new cursors when cursors are closed,\n"
+      "saving a handle allocation per cursor.  The default is 8; zero disables the\n"
+      "pool.", 0 },
+    { "alive_check_interval", Connection_getaliveinterval, Connection_setaliveinterval,
+      "The number of seconds is_alive reuses a True result for.  The default is 1;\n"
+      "zero checks every time.", 0 },
+    { "auto_prepare_threshold", Connection_getautopreparethreshold, Connection_setautopreparethreshold,
+      "The number of times SQL without parameters is executed before it is prepared\n"
+      "and reused like parameterized SQL.  Zero, the default, always executes it\n"
+      "directly.", 0 },
+    { "stream_chunk_size", Connection_getstreamchunksize, Connection_setstreamchunksize,
+      "The number of bytes sent at a time for parameters too large to bind, such as\n"
+      "file-like objects and iterators of bytes.  The default is 1 MB.", 0 },
+    { "numeric_struct", Connection_getnumericstruct, Connection_setnumericstruct,
+      "If True, Decimal parameters (and ints too large for a BIGINT) are bound as\n"
+      "binary SQL_NUMERIC_STRUCTs of up to 38 digits.  If False, they are bound as\n"
+      "strings.  Defaults to True for ODBC 3 drivers.", 0 },
+    { "auto_parameterize", Connection_getautoparameterize, Connection_setautoparameterize,
+      "If True, SQL executed without parameters has its numeric and string literals\n"
+      "replaced by parameter markers, so statements differing only in their values\n"
+      "are prepared once and reused.  N'...' strings are replaced if the SQL is\n"
+      "Unicode; other strings only if they will be bound as varchar.  SQL with a\n"
+      "GROUP BY is left alone.  Defaults to False.", 0 },
+    { "encoding", Connection_getencoding, 0,
+      "The encoding passed to connect, or None.  When set, text is exchanged with the\n"
+      "driver as SQL_C_CHAR in this encoding instead of as SQLWCHAR, and SQL is\n"
+      "executed with the ANSI functions.", 0 },
     { 0 }
 };
 
@@ -13,6 +13,9 @@
 #define CONNECTION_H
 
 struct Cursor;
+struct CachedStatement;
+struct InputAdapter;
+struct ExecCount;
 
 extern PyTypeObject ConnectionType;
 
@@ -37,12 +40,25 @@ struct Connection
     // to insert NULLs into binary columns.
     bool supports_describeparam;
 
+    // The parameter types from SQLDescribeParam, kept so cursors preparing the same SQL don't describe it again.  A
+    // dictionary mapping from the SQL (the object passed to execute) to a bytes object holding one SQLSMALLINT per
+    // parameter marker.  Zero until the first statement is described.
+    PyObject* paramtypes_cache;
+
     // The column size of datetime columns, obtained from SQLGetInfo(), used to determine the datetime precision.
     int datetime_precision;
 
     // If true, then the strings in the rows are returned as unicode objects.
     bool unicode_results;
 
+    // If non-zero, a bytes object holding the name of the codec used for text instead of SQLWCHAR.  Character columns
+    // are fetched as SQL_C_CHAR and decoded, Unicode input parameters are encoded and bound as SQL_C_CHAR, and Unicode
+    // SQL is encoded and passed to the ANSI SQLExecDirect and SQLPrepare.  Set by the `encoding` keyword of connect.
+    PyObject* encoding;
+
+    // True if `encoding` is UTF-8, which is decoded and encoded without looking up the codec.
+    bool utf8;
+
     // The connection timeout in seconds.
     intptr_t timeout;
 
@@ -53,6 +69,29 @@ struct Connection
     int binary_maxlength;
     bool need_long_data_len;
 
+    // The largest piece, in bytes, sent with each SQLPutData call for data-at-execution parameters.  File-like objects
+    // passed as parameters are read this much at a time.  Set by the stream_chunk_size attribute.
+    SQLLEN stream_chunk_size;
+
+    // If true, Decimal parameters, and ints too large for a BIGINT, are bound as SQL_NUMERIC_STRUCTs instead of strings
+    // the driver has to parse.  Defaults to true for ODBC 3 drivers, since the precision and scale are passed in the
+    // parameter descriptor.  Set by the numeric_struct attribute.
+    bool numeric_struct;
+
+    // If true, SQL executed without parameters has its literals replaced by parameter markers, so it is prepared and
+    // reused.  Set by the auto_parameterize attribute.  See autoparam.cpp.
+    bool autoparameterize;
+
+    // The normalized SQL produced by autoparameterize, a dictionary mapping each to itself so equal statements are
+    // executed with the same object.  Zero until the first statement is normalized.
+    PyObject* autoparam_sql;
+
+    // If not zero, parameterless SQL executed this many times is prepared instead of passed to SQLExecDirect, and
+    // execcounts is a table counting the executions.  Set by the auto_prepare_threshold attribute.  See
+    // autoprepare.cpp.
+    long autoprepare_threshold;
+    ExecCount* execcounts;
+
     // Output conversions.  Maps from SQL type in conv_types to the converter function in conv_funcs.
     //
     // If conv_count is zero, conv_types and conv_funcs will also be zero.
@@ -63,8 +102,53 @@ struct Connection
     int conv_count;             // how many items are in conv_types and conv_funcs.
     SQLSMALLINT* conv_types;            // array of SQL_TYPEs to convert
     PyObject** conv_funcs;      // array of Python functions
+
+    // Input adapters for parameter types GetParameterInfo doesn't bind itself, keyed by exact Python type.  Holds the
+    // types registered with add_input_adapter and every other type examined so far.  See adapters.cpp.
+    //
+    // adapter_last is the index of the last type found, so runs of parameters of the same type are a single pointer
+    // comparison.
+
+    InputAdapter* adapters;
+    int adapter_count;
+    int adapter_capacity;
+    int adapter_last;
+
+    // Prepared statements not currently used by a cursor, ordered from least to most recently used.  See stmtcache.cpp.
+    //
+    // If stmtcache_capacity is zero, the cache is disabled and stmtcache is zero.
+
+    CachedStatement* stmtcache;
+    int stmtcache_count;        // how many statements are in stmtcache
+    int stmtcache_capacity;     // the maximum number of statements, set by statement_cache_size
+    long stmtcache_hits;
+    long stmtcache_misses;
+
+    // Statement handles freed by cursors, reset and kept for the next cursor.  Used as a stack so the most recently
+    // used handle is reused first.  If hstmtpool_capacity is zero, the pool is disabled and hstmtpool is zero.
+
+    HSTMT* hstmtpool;
+    int hstmtpool_count;        // how many handles are in hstmtpool
+    int hstmtpool_capacity;     // the maximum number of handles, set by statement_handle_pool_size
+
+    // Used by is_alive.  The time (from MonotonicSeconds) of the last check that found the connection alive or zero,
+    // how many seconds that result is reused for, whether the driver supports SQL_ATTR_CONNECTION_DEAD, and the
+    // statement used to ping the database when it doesn't (zero until first needed).
+    double alive_checked;
+    double alive_interval;
+    bool connection_dead_unsupported;
+    const char* ping_sql;
+
+    // The Pool the connection is checked out from, or zero if it is not from a pool or is idle in one.  See pool.cpp.
+    PyObject* pool;
 };
 
+// The default Connection.alive_check_interval in seconds.
+#define DEFAULT_ALIVE_INTERVAL 1.0
+
+// The default Connection.stream_chunk_size.
+#define DEFAULT_STREAM_CHUNK_SIZE (1024 * 1024)
+
 #define Connection_Check(op) PyObject_TypeCheck(op, &ConnectionType)
 #define Connection_CheckExact(op) (Py_TYPE(op) == &ConnectionType)
 
@@ -72,11 +156,51 @@ struct Connection
  * Used by the module's connect function to create new connection objects.  If unable to connect to the database, an
  * exception is set and zero is returned.
  */
-PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout, bool fReadOnly);
+PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, bool fAnsi, bool fUnicodeResults, long timeout, bool fReadOnly,
+                         PyObject* encoding);
 
 /*
  * Used by the Cursor to implement commit and rollback.
  */
 PyObject* Connection_endtrans(Connection* cnxn, SQLSMALLINT type);
 
+/*
+ * Decodes `cb` bytes of text read as SQL_C_CHAR using the connection's encoding, which must be set.
+ */
+PyObject* Connection_DecodeText(Connection* cnxn, const char* pch, Py_ssize_t cb);
+
+/*
+ * Returns a new bytes object holding the Unicode object `text` in the connection's encoding, which must be set.
+ */
+PyObject* Connection_EncodeText(Connection* cnxn, PyObject* text);
+
+/*
+ * Returns true if the connection is open and the database can be reached.  If fFast is true, a result from the last
+ * alive_interval seconds is reused, and otherwise the driver's SQL_ATTR_CONNECTION_DEAD is used if supported, which
+ * doesn't contact the server.  If it isn't supported, or fFast is false, a trivial query is executed.  Never sets an
+ * exception.
+ */
+bool Connection_IsAlive(Connection* cnxn, bool fFast);
+
+// The settings a Pool restores when a connection is returned, captured from a new connection by Connection_GetSettings.
+struct ConnectionSettings
+{
+    uintptr_t nAutoCommit;
+    intptr_t timeout;
+    bool autoparameterize;
+    long autoprepare_threshold;
+    int stmtcache_capacity;
+    bool numeric_struct;
+    SQLLEN stream_chunk_size;
+    int hstmtpool_capacity;
+};
+
+void Connection_GetSettings(Connection* cnxn, ConnectionSettings& settings);
+
+/*
+ * Used by Pool when a connection is returned.  Rolls back any transaction, restores `settings`, and removes the output
+ * converters and input adapters.  If an error occurs, an exception is set and false is returned.
+ */
+bool Connection_Reset(Connection* cnxn, const ConnectionSettings& settings);
+
 #endif
@@ -24,6 +24,12 @@
 #include "getdata.h"
 #include "dbspecific.h"
 #include "sqlwchar.h"
+#include "stmtcache.h"
+#include "arrow.h"
+#include "parammemo.h"
+#include "inlist.h"
+#include "autoparam.h"
+#include "autoprepare.h"
 #include <datetime.h>
 #include "wrapper.h"
 
@@ -388,6 +394,9 @@ static bool free_results(Cursor* self, int flags)
     {
         Py_XDECREF(self->pPreparedSQL);
         self->pPreparedSQL = 0;
+
+        // The parameters bound for the prepared statement are kept between executes, so they go with it.
+        FreeParameterData(self);
     }
 
     if (self->colinfos)
@@ -445,27 +454,36 @@ static void closeimpl(Cursor* cur)
     //
     // This method releases the GIL lock while closing, so verify the HDBC still exists if you use it.
 
+    // If the connection caches prepared statements, hand the statement to it instead of freeing it.  This leaves the
+    // cursor without a handle.
+    FreeParameterData(cur);
+    StatementCache_Checkin(cur);
+
     free_results(cur, FREE_STATEMENT | FREE_PREPARED);
 
     FreeParameterInfo(cur);
     FreeParameterData(cur);
+    Arena_Free(cur->paramarena);
 
     if (StatementIsValid(cur))
     {
         HSTMT hstmt = cur->hstmt;
         cur->hstmt = SQL_NULL_HANDLE;
-        Py_BEGIN_ALLOW_THREADS
-        SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
-        Py_END_ALLOW_THREADS
+        FreeStatementHandle(cur->cnxn, hstmt);
     }
 
-
     Py_XDECREF(cur->pPreparedSQL);
+    Py_XDECREF(cur->inlist_source);
+    Py_XDECREF(cur->inlist_shape);
+    Py_XDECREF(cur->inlist_sql);
     Py_XDECREF(cur->description);
     Py_XDECREF(cur->map_name_to_index);
     Py_XDECREF(cur->cnxn);
 
     cur->pPreparedSQL = 0;
+    cur->inlist_source = 0;
+    cur->inlist_shape = 0;
+    cur->inlist_sql = 0;
     cur->description = 0;
     cur->map_name_to_index = 0;
     cur->cnxn = 0;
@@ -616,6 +634,148 @@ static bool PrepareResults(Cursor* cur, int cCols)
 }
 
 
+inline bool IsParamDataAvailable(SQLRETURN ret)
+{
+#ifdef SQL_PARAM_DATA_AVAILABLE
+    return ret == SQL_PARAM_DATA_AVAILABLE;
+#else
+    UNUSED(ret);
+    return false;
+#endif
+}
+
+
+static ParamInfo* FindStreamInfo(Cursor* cur, SQLPOINTER token)
+{
+    // Streamed output parameters use their ParamInfo as the SQLParamData token.  Returns the ParamInfo if `token` is
+    // one of ours, zero otherwise (e.g. it is the PyObject of an ordinary data-at-execution parameter).
+
+    if (cur->paramInfos == 0)
+        return 0;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        if (token == (SQLPOINTER)&cur->paramInfos[i])
+            return &cur->paramInfos[i];
+    }
+
+    return 0;
+}
+
+
+static bool PutData(Cursor* cur, const void* pv, SQLLEN cb, SQLLEN cbChunk)
+{
+    // Sends `cb` bytes of a data-at-execution parameter with SQLPutData, at most cbChunk bytes at a time.  If cb is
+    // zero, a single empty piece is sent.
+
+    const char* p      = (const char*)pv;
+    SQLLEN      offset = 0;
+
+    do
+    {
+        SQLLEN remaining = min(cbChunk, cb - offset);
+        TRACE("SQLPutData [%d] (%d)\n", (int)offset, (int)remaining);
+
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
+        Py_END_ALLOW_THREADS
+
+        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+            return false;
+        }
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+            return false;
+        }
+
+        offset += remaining;
+    }
+    while (offset < cb);
+
+    return true;
+}
+
+static bool CancelStream(Cursor* cur)
+{
+    // Called with an exception set when a stream can't be read.  The statement is still waiting for data, so it is
+    // canceled to make the cursor usable again.
+
+    HSTMT hstmt = cur->hstmt;
+    Py_BEGIN_ALLOW_THREADS
+    SQLCancel(hstmt);
+    Py_END_ALLOW_THREADS
+
+    return false;
+}
+
+static bool PutDataStream(Cursor* cur, PyObject* stream)
+{
+    // Sends a file-like object, read stream_chunk_size bytes at a time, or the chunks produced by an iterator.  Only
+    // one chunk is in memory at a time.
+
+    Object read;
+    if (PyObject_HasAttrString(stream, "read") && !read.Attach(PyObject_GetAttrString(stream, "read")))
+        return CancelStream(cur);
+
+    bool fSent = false;
+
+    for (;;)
+    {
+        Object chunk(read ? PyObject_CallFunction(read, "n", (Py_ssize_t)cur->cnxn->stream_chunk_size) : PyIter_Next(stream));
+        if (!chunk)
+        {
+            if (PyErr_Occurred())
+                return CancelStream(cur);
+            break;              // the iterator is exhausted
+        }
+
+        const char* pb;
+        Py_ssize_t  cb;
+        if (PyBytes_Check(chunk))
+        {
+            pb = PyBytes_AS_STRING(chunk.Get());
+            cb = PyBytes_GET_SIZE(chunk.Get());
+        }
+#if PY_VERSION_HEX >= 0x02060000
+        else if (PyByteArray_Check(chunk))
+        {
+            pb = PyByteArray_AS_STRING(chunk.Get());
+            cb = PyByteArray_GET_SIZE(chunk.Get());
+        }
+#endif
+        else
+        {
+            PyErr_Format(PyExc_TypeError, "Streamed parameters must produce bytes or bytearray chunks, not %s.",
+                         Py_TYPE(chunk.Get())->tp_name);
+            return CancelStream(cur);
+        }
+
+        if (cb == 0)
+        {
+            if (read)
+                break;          // end of file
+            continue;
+        }
+
+        if (!PutData(cur, pb, (SQLLEN)cb, cur->cnxn->stream_chunk_size))
+            return false;
+        fSent = true;
+    }
+
+    // Every data-at-execution parameter needs at least one SQLPutData, even when it is empty.
+    if (!fSent)
+        return PutData(cur, "", 0, 0);
+
+    return true;
+}
+
+
 // Helper method to read data-at-execution parameter data
 static PyObject* ReadDataAtExecutionParameters(Cursor* cur, SQLRETURN* pRet)
 {
@@ -636,66 +796,50 @@ static PyObject* ReadDataAtExecutionParameters(Cursor* cur, SQLRETURN* pRet)
         ret = SQLParamData(cur->hstmt, (SQLPOINTER*)&pParam);
         Py_END_ALLOW_THREADS
 
-        if (ret != SQL_NEED_DATA && ret != SQL_NO_DATA && !SQL_SUCCEEDED(ret))
+        if (ret != SQL_NEED_DATA && ret != SQL_NO_DATA && !IsParamDataAvailable(ret) && !SQL_SUCCEEDED(ret))
             return RaiseErrorFromHandle(szLastFunction, cur->cnxn->hdbc, cur->hstmt);
 
         TRACE("SQLParamData() --> %d\n", ret);
 
         if (ret == SQL_NEED_DATA)
         {
+            // INPUT_OUTPUT_STREAM parameters are bound with their ParamInfo as the token instead of the object.
+            ParamInfo* pInfo = FindStreamInfo(cur, pParam);
+            if (pInfo)
+                pParam = pInfo->pParam;
+
+            // Unicode values bound as SQL_C_CHAR by GetUnicodeInfo (all but the streams) are sent in the connection's
+            // encoding.
+            Object encoded;
+            if (PyUnicode_Check(pParam) && !pInfo && cur->cnxn->encoding)
+            {
+                if (!encoded.Attach(Connection_EncodeText(cur->cnxn, pParam)))
+                    return 0;
+                pParam = encoded.Get();
+            }
+
             szLastFunction = "SQLPutData";
             if (PyUnicode_Check(pParam))
             {
                 SQLWChar wchar(pParam); // Will convert to SQLWCHAR if necessary.
+                if (!wchar)
+                    return 0;
 
-                Py_ssize_t offset = 0;            // in characters
-                Py_ssize_t length = wchar.size(); // in characters
-
-                while (offset < length)
-                {
-                    SQLLEN remaining = min(cur->cnxn->varchar_maxlength, length - offset);
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, (SQLPOINTER)wchar[offset], (SQLLEN)(remaining * sizeof(SQLWCHAR)));
-                    Py_END_ALLOW_THREADS
-                    if (!SQL_SUCCEEDED(ret))
-                        return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
-                    offset += remaining;
-                }
+                // Keep the pieces a whole number of SQLWCHARs.
+                SQLLEN cbChunk = max(cur->cnxn->stream_chunk_size / (SQLLEN)sizeof(SQLWCHAR), (SQLLEN)1) * sizeof(SQLWCHAR);
+                if (!PutData(cur, wchar[0], (SQLLEN)(wchar.size() * sizeof(SQLWCHAR)), cbChunk))
+                    return 0;
             }
             else if (PyBytes_Check(pParam))
             {
-                const char* p = PyBytes_AS_STRING(pParam);
-                SQLLEN offset = 0;
-                SQLLEN cb = (SQLLEN)PyBytes_GET_SIZE(pParam);
-                while (offset < cb)
-                {
-                    SQLLEN remaining = min(cur->cnxn->varchar_maxlength, cb - offset);
-                    TRACE("SQLPutData [%d] (%d) %s\n", offset, remaining, &p[offset]);
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
-                    Py_END_ALLOW_THREADS
-                    if (!SQL_SUCCEEDED(ret))
-                        return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
-                    offset += remaining;
-                }
+                if (!PutData(cur, PyBytes_AS_STRING(pParam), (SQLLEN)PyBytes_GET_SIZE(pParam), cur->cnxn->stream_chunk_size))
+                    return 0;
             }
 #if PY_VERSION_HEX >= 0x02060000
             else if (PyByteArray_Check(pParam))
             {
-                const char* p = PyByteArray_AS_STRING(pParam);
-                SQLLEN offset = 0;
-                SQLLEN cb     = (SQLLEN)PyByteArray_GET_SIZE(pParam);
-                while (offset < cb)
-                {
-                    SQLLEN remaining = min(cur->cnxn->varchar_maxlength, cb - offset);
-                    TRACE("SQLPutData [%d] (%d) %s\n", offset, remaining, &p[offset]);
-                    Py_BEGIN_ALLOW_THREADS
-                    ret = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
-                    Py_END_ALLOW_THREADS
-                    if (!SQL_SUCCEEDED(ret))
-                        return RaiseErrorFromHandle("SQLPutData", cur->cnxn->hdbc, cur->hstmt);
-                    offset += remaining;
-                }
+                if (!PutData(cur, PyByteArray_AS_STRING(pParam), (SQLLEN)PyByteArray_GET_SIZE(pParam), cur->cnxn->stream_chunk_size))
+                    return 0;
             }
 #endif
 #if PY_MAJOR_VERSION < 3
@@ -717,6 +861,25 @@ static PyObject* ReadDataAtExecutionParameters(Cursor* cur, SQLRETURN* pRet)
                 }
             }
 #endif
+#if PY_VERSION_HEX >= 0x02060000
+            else if (PyObject_CheckBuffer(pParam))
+            {
+                // A large memoryview, array, mmap, etc. bound by GetBufferViewInfo.
+                Py_buffer view;
+                if (PyObject_GetBuffer(pParam, &view, PyBUF_SIMPLE) != 0)
+                    return 0;
+                bool ok = PutData(cur, view.buf, (SQLLEN)view.len, cur->cnxn->stream_chunk_size);
+                PyBuffer_Release(&view);
+                if (!ok)
+                    return 0;
+            }
+#endif
+            else
+            {
+                // A file-like object or iterator bound by GetStreamInfo.
+                if (!PutDataStream(cur, pParam))
+                    return 0;
+            }
             ret = SQL_NEED_DATA;
         }
     }
@@ -727,6 +890,167 @@ static PyObject* ReadDataAtExecutionParameters(Cursor* cur, SQLRETURN* pRet)
 }
 
 
+// The size of the first SQLGetData read of a streamed output parameter.  Larger values are read in pieces, growing the
+// buffer as we go, so this only needs to cover the common case.
+static const SQLLEN cbOutputStreamChunk = 8192;
+
+static PyObject* ReadOutputStream(Cursor* cur, ParamInfo* pInfo)
+{
+    // Reads a single streamed output parameter with SQLGetData and returns it as a new Python object.
+
+    SQLUSMALLINT iParam = (SQLUSMALLINT)(pInfo - cur->paramInfos + 1);
+    SQLSMALLINT  ctype  = pInfo->ValueType;
+    SQLLEN       cbNull = (ctype == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : ((ctype == SQL_C_CHAR) ? 1 : 0);
+
+    SQLLEN cbAllocated = cbOutputStreamChunk;
+    SQLLEN cbData      = 0;
+    char*  pb          = (char*)pyodbc_malloc((size_t)cbAllocated);
+    if (!pb)
+        return PyErr_NoMemory();
+
+    for (;;)
+    {
+        SQLLEN cbRead = 0;
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLGetData(cur->hstmt, iParam, ctype, &pb[cbData], cbAllocated - cbData, &cbRead);
+        Py_END_ALLOW_THREADS
+
+        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            pyodbc_free(pb);
+            return RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        }
+
+        if (ret == SQL_NO_DATA)
+            break;
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            pyodbc_free(pb);
+            return RaiseErrorFromHandle("SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+        }
+
+        if (cbRead == SQL_NULL_DATA)
+        {
+            pyodbc_free(pb);
+            Py_RETURN_NONE;
+        }
+
+        if (ret == SQL_SUCCESS || (cbRead != SQL_NO_TOTAL && cbRead <= cbAllocated - cbData - cbNull))
+        {
+            // This was the last piece.
+            cbData += cbRead;
+            break;
+        }
+
+        // The buffer was filled (less the null terminator the driver always writes) and there is more.  Grow to the
+        // remaining size if the driver told us, otherwise double.
+
+        cbData += cbAllocated - cbData - cbNull;
+
+        SQLLEN cbNeeded = (cbRead == SQL_NO_TOTAL) ? (cbAllocated * 2) : (cbData + cbRead + cbNull);
+        cbNeeded = max(cbNeeded, cbData + cbOutputStreamChunk);
+
+        char* pbNew = (char*)pyodbc_malloc((size_t)cbNeeded);
+        if (!pbNew)
+        {
+            pyodbc_free(pb);
+            return PyErr_NoMemory();
+        }
+        memcpy(pbNew, pb, (size_t)cbData);
+        pyodbc_free(pb);
+        pb = pbNew;
+        cbAllocated = cbNeeded;
+    }
+
+    TRACE("ReadOutputStream: param=%d bytes=%d\n", (int)iParam, (int)cbData);
+
+    PyObject* result;
+    if (ctype == SQL_C_WCHAR)
+        result = PyUnicode_FromSQLWCHAR((const SQLWCHAR*)pb, cbData / sizeof(SQLWCHAR));
+#if PY_VERSION_HEX >= 0x02060000
+    else if (PyByteArray_Check(pInfo->pParam))
+        result = PyByteArray_FromStringAndSize(pb, cbData);
+#endif
+    else
+        result = PyBytes_FromStringAndSize(pb, cbData);
+
+    pyodbc_free(pb);
+    return result;
+}
+
+
+static PyObject* ReadOutputStreamParameters(Cursor* cur, SQLRETURN* pRet)
+{
+    // Called when the statement returned SQL_PARAM_DATA_AVAILABLE.  SQLParamData hands us the token of each streamed
+    // output parameter in turn and we read it into ParamInfo.pOutput, so nothing had to be sized before executing.
+
+    SQLRETURN ret = *pRet;
+
+    while (IsParamDataAvailable(ret))
+    {
+        SQLPOINTER token = 0;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLParamData(cur->hstmt, &token);
+        Py_END_ALLOW_THREADS
+
+        TRACE("SQLParamData() --> %d\n", ret);
+
+        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            return RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        }
+
+        if (!IsParamDataAvailable(ret))
+            break;
+
+        ParamInfo* pInfo = FindStreamInfo(cur, token);
+        if (!pInfo)
+            return RaiseErrorV("HY000", ProgrammingError, "The driver returned an unknown output stream token.");
+
+        Py_XDECREF(pInfo->pOutput);
+        pInfo->pOutput = ReadOutputStream(cur, pInfo);
+        if (!pInfo->pOutput)
+            return 0;
+    }
+
+    if (ret != SQL_NO_DATA && !SQL_SUCCEEDED(ret))
+        return RaiseErrorFromHandle("SQLParamData", cur->cnxn->hdbc, cur->hstmt);
+
+    *pRet = ret;
+
+    return (PyObject*)cur;
+}
+
+
+inline bool IsOutputParameter(const ParamInfo* pInfo)
+{
+    return pInfo->InputOutputType != SQL_PARAM_INPUT;
+}
+
+
+static PyObject* GetOutputValue(const ParamInfo* pInfo)
+{
+    // Returns a new reference to the value the driver wrote to an output or input/output parameter.
+
+    // Streamed parameters were read by ReadOutputStreamParameters.
+    if (pInfo->pOutput)
+    {
+        Py_INCREF(pInfo->pOutput);
+        return pInfo->pOutput;
+    }
+
+    // If there is no conversion method, the driver never offered the stream, or the value is NULL, return None.
+    if (!pInfo->fnToPyObject || pInfo->ParameterValuePtr == (SQLPOINTER)pInfo || pInfo->StrLen_or_Ind == SQL_NULL_DATA)
+        Py_RETURN_NONE;
+
+    return pInfo->fnToPyObject(pInfo);
+}
+
+
 static PyObject* ConsumeResultRows(Cursor* cur)
 {
     SQLLEN cRows = -1;
@@ -790,13 +1114,23 @@ static char callproc_doc[] =
     " parameters are left untouched, output and input/output parameters"
     " replaced with possibly new values.\n"
     "\n"
+    "Parameters wrapped as SQLParameter(value, SQL_PARAM_OUTPUT_STREAM) are read in"
+    " pieces after the call when the driver supports ODBC 3.8 streamed output"
+    " parameters, so large values do not need an ostr_len buffer.\n"
+    "\n"
     "  cursor.callproc(callproc, (param1, param2))\n"
     "\n"
     "    or\n"
     "\n"
-    "  cursor.callproc(callproc, param1, param2)\n";
+    "  cursor.callproc(callproc, param1, param2)\n"
+    "\n"
+    "If return_value=True is passed, the procedure's return value is bound as an"
+    " extra output parameter ({ ? = CALL ... }) and (return_value, params) is"
+    " returned instead:\n"
+    "\n"
+    "  status, params = cursor.callproc(callproc, param1, return_value=True)\n";
 
-static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
+static PyObject* Cursor_callproc(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     Py_ssize_t cParams = PyTuple_Size(args) - 1;
 
@@ -810,7 +1144,42 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
         return 0;
     }
 
-    free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
+    bool fReturnValue = false;
+    if (kwargs && PyDict_Size(kwargs) > 0)
+    {
+        PyObject* key = 0;
+        PyObject* value = 0;
+        Py_ssize_t pos = 0;
+
+        while (PyDict_Next(kwargs, &pos, &key, &value))
+        {
+            // Keywords are case sensitive, as they are for Python functions.
+#if PY_MAJOR_VERSION >= 3
+            if (!PyUnicode_Check(key) || PyUnicode_CompareWithASCIIString(key, "return_value") != 0)
+                return PyErr_Format(PyExc_TypeError, "callproc() got an unexpected keyword argument '%S'", key);
+#else
+            if (!PyString_Check(key) || strcmp(PyString_AS_STRING(key), "return_value") != 0)
+            {
+                Object name(PyObject_Str(key));
+                if (!name)
+                    return 0;
+                return PyErr_Format(PyExc_TypeError, "callproc() got an unexpected keyword argument '%s'", PyString_AS_STRING(name.Get()));
+            }
+#endif
+            int n = PyObject_IsTrue(value);
+            if (n == -1)
+                return 0;
+            fReturnValue = (n != 0);
+        }
+    }
+
+    // SQLExecDirect replaces the prepared statement, so keep it in the connection's statement cache (if enabled) and
+    // forget it.
+    FreeParameterData(cursor);
+    if (!StatementCache_Release(cursor))
+        return 0;
+
+    free_results(cursor, FREE_STATEMENT | FREE_PREPARED);
     free_results(cursor, FREE_STATEMENT | KEEP_PREPARED); // FIXME: why?
 
     PyObject* pProcName = PyTuple_GET_ITEM(args, 0);
@@ -834,8 +1203,34 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
         }
     }
 
+    // If the caller wants the return value, bind an extra integer output parameter in front of the others.  This
+    // saves a second round trip to read the procedure's status.
+
+    Object returnParams;
+    if (fReturnValue)
+    {
+        returnParams = PyTuple_New(cParams + 1);
+        if (!returnParams)
+            return 0;
+
+        PyObject* pReturnParam = PyObject_CallFunction(SQLParameter_type, "ii", 0, SQL_PARAM_OUTPUT);
+        if (!pReturnParam)
+            return 0;
+        PyTuple_SET_ITEM(returnParams.Get(), 0, pReturnParam);
+
+        Py_ssize_t offset = paramsInTuple ? 0 : 1;
+        for (Py_ssize_t ix = 0; ix < cParams; ix++)
+        {
+            PyObject* item = PyTuple_GET_ITEM(args, ix + offset);
+            Py_INCREF(item);
+            PyTuple_SET_ITEM(returnParams.Get(), ix + 1, item);
+        }
+
+        args = returnParams.Get();
+        paramsInTuple = true;
+    }
+
     // Construct the call statement.
-    // $TODO: optionally support return codes
     // Build the call statement argument list. This is a sequence of '?' for each parameter
     // of the stored procedure, where each is separated by a comma.
     Py_ssize_t cbParameterList = cParams ? 2 * cParams /* one byte for the '?', one for the ',' (or '\0' for the last param) */ : 1;
@@ -863,13 +1258,19 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
 #if PY_VERSION_HEX >= 0x03000000
     PyObject* pCallprocName = PyUnicode_AsASCIIString(pProcName);
     if (pCallprocName == NULL) {
+        pyodbc_free(pszParameterList);
         return NULL;
     }
-    PyObject* pCallStatement = PyString_FromFormat("{ CALL %s(%s) }", PyBytes_AsString(pCallprocName), pszParameterList);
+    PyObject* pCallStatement = PyString_FromFormat(fReturnValue ? "{ ? = CALL %s(%s) }" : "{ CALL %s(%s) }", PyBytes_AsString(pCallprocName), pszParameterList);
     Py_DECREF(pCallprocName);
 #else
-    PyObject* pCallStatement = PyString_FromFormat("{ CALL %s(%s) }", PyString_AsString(pProcName), pszParameterList);
+    PyObject* pCallStatement = PyString_FromFormat(fReturnValue ? "{ ? = CALL %s(%s) }" : "{ CALL %s(%s) }", PyString_AsString(pProcName), pszParameterList);
 #endif
+    pyodbc_free(pszParameterList);
+
+    // Owns the statement, so the error returns below don't leak it.
+    Object callStatement(pCallStatement);
+
     if (pCallStatement)
     {
         {
@@ -899,6 +1300,17 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
         }
         else
 #endif
+        if (cursor->cnxn->encoding)
+        {
+            Object query(Connection_EncodeText(cursor->cnxn, pCallStatement));
+            if (!query)
+                return 0;
+
+            Py_BEGIN_ALLOW_THREADS
+            ret = SQLExecDirect(cursor->hstmt, (SQLCHAR*)PyBytes_AS_STRING(query.Get()), SQL_NTS);
+            Py_END_ALLOW_THREADS
+        }
+        else
         {
             SQLWChar query(pCallStatement);
             if (!query)
@@ -920,7 +1332,7 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
             return RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
         }
 
-        if (!SQL_SUCCEEDED(ret) && ret != SQL_NEED_DATA && ret != SQL_NO_DATA)
+        if (!SQL_SUCCEEDED(ret) && ret != SQL_NEED_DATA && ret != SQL_NO_DATA && !IsParamDataAvailable(ret))
         {
             // We could try dropping through the while and if below, but if there is an error, we need to raise it before
             // FreeParameterData calls more ODBC functions.
@@ -929,13 +1341,21 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
             return 0;
         }
 
-        if (!ReadDataAtExecutionParameters(cursor, &ret))
+        bool fRead = ReadDataAtExecutionParameters(cursor, &ret) != 0;
+        ReleaseParameterViews(cursor);
+        if (!fRead)
         {
             return 0;
         }
         //
         // END COPIED AND PASTED FROM execute()
 
+        if (IsParamDataAvailable(ret) && !ReadOutputStreamParameters(cursor, &ret))
+        {
+            FreeParameterData(cursor);
+            return 0;
+        }
+
         if (SQL_NO_DATA != ret)
         {
             I(SQL_SUCCEEDED(ret));
@@ -956,61 +1376,48 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
 
         // Create the return tpule based on the input argument list. For INPUT_OUTPUT and OUTPUT
         // parameters, create new Python objects using the value written to the ParamInfo Data.
-        PyObject* pOutputTuple = PyTuple_New((Py_ssize_t)cursor->paramcount);
+        //
+        // The return value parameter, if any, is the first one and is not part of the tuple.
+        int iFirst = fReturnValue ? 1 : 0;
+        PyObject* pOutputTuple = PyTuple_New((Py_ssize_t)(cursor->paramcount - iFirst));
         if (pOutputTuple)
         {
             bool failure = false;
-            for (int ix = 0; ix < cursor->paramcount && !failure; ++ix)
+            for (int ix = 0; ix < cursor->paramcount - iFirst && !failure; ++ix)
+            {
+                const ParamInfo* pInfo = &cursor->paramInfos[ix + iFirst];
+                PyObject* pValue;
+                if (IsOutputParameter(pInfo))
+                {
+                    pValue = GetOutputValue(pInfo);
+                }
+                else
+                {
+                    // Add references to the input parameters
+                    pValue = pInfo->pParam;
+                    Py_INCREF(pValue);
+                }
+
+                if (pValue)
+                    PyTuple_SET_ITEM(pOutputTuple, (Py_ssize_t)ix, pValue);
+                else
+                    failure = true;
+            }
+            if (!failure && fReturnValue)
             {
-                const ParamInfo* pInfo = &cursor->paramInfos[ix];
-                switch (pInfo->InputOutputType)
+                PyObject* pValue = GetOutputValue(&cursor->paramInfos[0]);
+                if (pValue)
                 {
-                    case SQL_PARAM_INPUT_OUTPUT:
-                    case SQL_PARAM_OUTPUT:
-                    {
-                        if (pInfo->fnToPyObject)
-                        {
-                            PyObject* pOutput = pInfo->fnToPyObject(pInfo);
-                            if (pOutput)
-                            {
-                                if (-1 == PyTuple_SetItem(pOutputTuple, (Py_ssize_t)ix, pOutput))
-                                {
-                                    failure = true;
-                                    Py_DECREF(pOutput);
-                                }
-                            }
-                            else
-                            {
-                                failure = true;
-                            }
-                        }
-                        else
-                        {
-                            // No conversion method supplied...
-                            // Return None
-                            Py_INCREF(Py_None);
-                            if (-1 == PyTuple_SetItem(pOutputTuple, (Py_ssize_t)ix, Py_None))
-                            {
-                                failure = true;
-                                Py_DECREF(Py_None);
-                            }
-                        }
-                        break;
-                    }
-                    default:
-                    {
-                        // Add references to the input parameters
-                        Py_INCREF(pInfo->pParam);
-                        if (-1 == PyTuple_SetItem(pOutputTuple, (Py_ssize_t)ix, pInfo->pParam))
-                        {
-                            failure = true;
-                            Py_DECREF(pInfo->pParam);
-                        }
-                        break;
-                    }
+                    // Steals both references
+                    pReturn = Py_BuildValue("(NN)", pValue, pOutputTuple);
+                    pOutputTuple = 0;
+                }
+                else
+                {
+                    Py_DECREF(pOutputTuple);
                 }
             }
-            if (!failure)
+            else if (!failure)
             {
                 // Steal the reference
                 pReturn = pOutputTuple;
@@ -1023,16 +1430,87 @@ static PyObject* Cursor_callproc(PyObject* self, PyObject* args)
         }
 
         FreeParameterData(cursor);
-
-        Py_XDECREF(pCallStatement);
-        pCallStatement = 0;
     }
-    pyodbc_free(pszParameterList);
 
     return pReturn;
 }
 
 
+PyObject* Cursor_ExecuteProcedure(Cursor* cur)
+{
+    // Executes the statement prepared and bound by PrepareAndBindFixed, after SetFixedParams has copied in the input
+    // values, and returns a tuple of the output and input/output parameter values.
+    //
+    // Unlike callproc and execute, the parameters are left bound for the next call.
+
+    if (!StatementIsValid(cur) || cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        return RaiseErrorV(0, ProgrammingError, "Attempt to use a closed cursor.");
+
+    if (!free_results(cur, FREE_STATEMENT | KEEP_PREPARED))
+        return 0;
+
+    int cOutputs = 0;
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        Py_CLEAR(cur->paramInfos[i].pOutput);
+        if (IsOutputParameter(&cur->paramInfos[i]))
+            cOutputs++;
+    }
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLExecute(cur->hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        return RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+    }
+
+    if (!SQL_SUCCEEDED(ret) && ret != SQL_NEED_DATA && ret != SQL_NO_DATA && !IsParamDataAvailable(ret))
+        return RaiseErrorFromHandle("SQLExecute", cur->cnxn->hdbc, cur->hstmt);
+
+    if (!ReadDataAtExecutionParameters(cur, &ret))
+        return 0;
+
+    if (IsParamDataAvailable(ret) && !ReadOutputStreamParameters(cur, &ret))
+        return 0;
+
+    if (ret == SQL_NO_DATA)
+    {
+        cur->rowcount = 0;
+    }
+    else
+    {
+        if (!SQL_SUCCEEDED(ret))
+            return RaiseErrorFromHandle("SQLExecute", cur->cnxn->hdbc, cur->hstmt);
+
+        // As in callproc, result rows must be consumed before the output parameters are written.
+        if (!ConsumeResultRows(cur))
+            return 0;
+    }
+
+    Object result(PyTuple_New(cOutputs));
+    if (!result)
+        return 0;
+
+    int iOutput = 0;
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        if (!IsOutputParameter(&cur->paramInfos[i]))
+            continue;
+
+        PyObject* pValue = GetOutputValue(&cur->paramInfos[i]);
+        if (!pValue)
+            return 0;
+        PyTuple_SET_ITEM(result.Get(), iOutput++, pValue);
+    }
+
+    return result.Detach();
+}
+
+
 static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first)
 {
     // Internal function to execute SQL, called by .callproc, .execute and .executemany.
@@ -1054,6 +1532,20 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
     {
         if (!PyTuple_Check(params) && !PyList_Check(params) && !Row_Check(params))
             return RaiseErrorV(0, PyExc_TypeError, "Params must be in a list, tuple, or Row");
+
+        if (HasInList(params, skip_first))
+        {
+            // Execute the expanded SQL with the InLists' values in place of each InList.
+
+            PyObject* pNewSql;
+            PyObject* pNewParams;
+            if (!ExpandInLists(cur, pSql, params, skip_first, pNewSql, pNewParams))
+                return 0;
+
+            Object sql(pNewSql);
+            Object expanded(pNewParams);
+            return execute(cur, sql, expanded, false);
+        }
     }
 
     // Normalize the parameter variables.
@@ -1061,13 +1553,49 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
     int        params_offset = skip_first ? 1 : 0;
     Py_ssize_t cParams       = params == 0 ? 0 : PySequence_Length(params) - params_offset;
 
+    // SQL without parameters that is already prepared on this cursor (by auto-prepare or a PreparedStatement) is
+    // executed as it is, without being parameterized or counted again.
+    bool fPrepared = cParams == 0 && cur->pPreparedSQL != 0 && IsSameSQL(pSql, cur->pPreparedSQL);
+
+    if (cParams == 0 && !fPrepared && cur->cnxn->autoparameterize)
+    {
+        // Execute SQL written with literals as the equivalent parameterized SQL, which is prepared and reused.
+
+        PyObject* pNewSql;
+        PyObject* pNewParams;
+        if (!AutoParameterize(cur, pSql, pNewSql, pNewParams))
+            return 0;
+
+        if (pNewSql)
+        {
+            Object sql(pNewSql);
+            Object lifted(pNewParams);
+            return execute(cur, sql, lifted, false);
+        }
+    }
+
     SQLRETURN ret = 0;
 
     free_results(cur, FREE_STATEMENT | KEEP_PREPARED);
 
     const char* szLastFunction = "";
 
-    if (cParams > 0)
+    // SQL without parameters is executed directly unless it is already prepared on this cursor or the connection's
+    // auto_prepare_threshold says it is executed often enough to prepare.  If not, `encoded` may be set to the SQL
+    // already converted for SQLExecDirect.
+
+    bool   fPrepare = cParams > 0 || fPrepared;
+    Object encoded;
+
+    if (!fPrepare && cur->cnxn->autoprepare_threshold != 0)
+    {
+        PyObject* pEncoded;
+        if (!AutoPrepare_Count(cur, pSql, fPrepare, pEncoded))
+            return 0;
+        encoded.Attach(pEncoded);
+    }
+
+    if (fPrepare)
     {
         // There are parameters, so we'll need to prepare the SQL statement and bind the parameters.  (We need to
         // prepare the statement because we can't bind a NULL (None) object without knowing the target datatype.  There
@@ -1083,13 +1611,33 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
     }
     else
     {
-        // REVIEW: Why don't we always prepare?  It is highly unlikely that a user would need to execute the same SQL
-        // repeatedly if it did not have parameters, so we are not losing performance, but it would simplify the code.
+        // SQL without parameters is usually executed once, so it isn't worth a round trip to prepare it.  SQL that is
+        // executed repeatedly can be prepared by setting auto_prepare_threshold.
+
+        FreeParameterData(cur);
+
+        if (!StatementCache_Release(cur))
+            return 0;
 
         Py_XDECREF(cur->pPreparedSQL);
         cur->pPreparedSQL = 0;
 
         szLastFunction = "SQLExecDirect";
+        if (encoded && cur->cnxn->encoding)
+        {
+            Py_BEGIN_ALLOW_THREADS
+            ret = SQLExecDirect(cur->hstmt, (SQLCHAR*)PyBytes_AS_STRING(encoded.Get()), SQL_NTS);
+            Py_END_ALLOW_THREADS
+        }
+        else if (encoded)
+        {
+            szLastFunction = "SQLExecDirectW";
+
+            Py_BEGIN_ALLOW_THREADS
+            ret = SQLExecDirectW(cur->hstmt, (SQLWCHAR*)PyBytes_AS_STRING(encoded.Get()), SQL_NTS);
+            Py_END_ALLOW_THREADS
+        }
+        else
 #if PY_MAJOR_VERSION < 3
         if (PyString_Check(pSql))
         {
@@ -1099,6 +1647,17 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
         }
         else
 #endif
+        if (cur->cnxn->encoding)
+        {
+            Object query(Connection_EncodeText(cur->cnxn, pSql));
+            if (!query)
+                return 0;
+
+            Py_BEGIN_ALLOW_THREADS
+            ret = SQLExecDirect(cur->hstmt, (SQLCHAR*)PyBytes_AS_STRING(query.Get()), SQL_NTS);
+            Py_END_ALLOW_THREADS
+        }
+        else
         {
             SQLWChar query(pSql);
             if (!query)
@@ -1132,10 +1691,14 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
 
     if (!ReadDataAtExecutionParameters(cur, &ret))
     {
+        FreeParameterData(cur);
         return 0;
     }
 
-    FreeParameterData(cur);
+    // The parameters are left bound so that executing the same statement again only has to copy in the new values.
+    // See PrepareAndBind.  Buffer objects bound in place are let go now, though, so they can be resized again.
+
+    ReleaseParameterViews(cur);
 
     if (ret == SQL_NO_DATA)
     {
@@ -1228,6 +1791,207 @@ PyObject* Cursor_execute(PyObject* self, PyObject* args)
 }
 
 
+// The number of rows executemany binds as parameter arrays and sends at once when fast_executemany is set.
+// Iterators and generators are read one batch at a time, so this also bounds the memory used.
+static const Py_ssize_t cParamArrayRows = 1000;
+
+static bool ExecuteParamArrays(Cursor* cur, Py_ssize_t cRows, Py_ssize_t iFirstRow, SQLLEN& cRowsAffected)
+{
+    // Executes the batch bound by BindParamArrays or BindParamColumnRows.  The status of each row is collected so an
+    // error can be reported against the row that caused it.  The caller frees the bindings.
+
+    SQLUSMALLINT* pStatus = (SQLUSMALLINT*)pyodbc_malloc(sizeof(SQLUSMALLINT) * cRows);
+    if (!pStatus)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    SQLULEN cProcessed = 0;
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)(SQLULEN)cRows, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_STATUS_PTR, pStatus, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &cProcessed, 0);
+    Py_END_ALLOW_THREADS
+
+    const char* szLastFunction = "SQLSetStmtAttr";
+
+    if (SQL_SUCCEEDED(ret))
+    {
+        szLastFunction = "SQLExecute";
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLExecute(cur->hstmt);
+        Py_END_ALLOW_THREADS
+    }
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        pyodbc_free(pStatus);
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    // Some drivers carry on after a failed row and only report it in the status array.
+
+    Py_ssize_t iFailed = -1;
+    for (Py_ssize_t i = 0; i < (Py_ssize_t)cProcessed && i < cRows; i++)
+    {
+        if (pStatus[i] == SQL_PARAM_ERROR)
+        {
+            iFailed = i;
+            break;
+        }
+    }
+
+    bool fSuccess = (SQL_SUCCEEDED(ret) || ret == SQL_NO_DATA) && iFailed == -1;
+
+    if (!fSuccess)
+    {
+        char szFunction[64];
+        if (iFailed != -1)
+            sprintf(szFunction, "SQLExecute; executemany row %ld", (long)(iFirstRow + iFailed));
+        else
+            strcpy(szFunction, szLastFunction);
+        RaiseErrorFromHandle(szFunction, cur->cnxn->hdbc, cur->hstmt);
+    }
+    else if (ret != SQL_NO_DATA)
+    {
+        SQLLEN cRowCount = -1;
+        Py_BEGIN_ALLOW_THREADS
+        SQLRowCount(cur->hstmt, &cRowCount);
+        Py_END_ALLOW_THREADS
+
+        if (cRowCount < 0 || cRowsAffected < 0)
+            cRowsAffected = -1;
+        else
+            cRowsAffected += cRowCount;
+    }
+
+    // Put the statement back to single row parameters before the status array goes away.
+
+    Py_BEGIN_ALLOW_THREADS
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, 0, 0);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_STATUS_PTR, 0, 0);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, 0);
+    Py_END_ALLOW_THREADS
+
+    pyodbc_free(pStatus);
+
+    return fSuccess;
+}
+
+static bool ExecuteBatch(Cursor* cur, PyObject* pSql, PyObject* rows, Py_ssize_t iFirstRow, SQLLEN& cRowsAffected,
+                         ParamMemo* memo)
+{
+    bool fArrayBound;
+
+    if (!free_results(cur, FREE_STATEMENT | KEEP_PREPARED))
+        return false;
+
+    if (!BindParamArrays(cur, pSql, rows, fArrayBound, memo))
+        return false;
+
+    if (fArrayBound)
+    {
+        bool fSuccess = ExecuteParamArrays(cur, PyList_GET_SIZE(rows), iFirstRow, cRowsAffected);
+        FreeParameterData(cur);
+        return fSuccess;
+    }
+
+    // These rows can't be sent as arrays, so fall back to executing them one at a time.
+
+    cRowsAffected = -1;
+
+    for (Py_ssize_t i = 0; i < PyList_GET_SIZE(rows); i++)
+    {
+        PyObject* result = execute(cur, pSql, PyList_GET_ITEM(rows, i), false);
+        if (!result)
+            return false;
+        Py_DECREF(result);
+    }
+
+    return true;
+}
+
+static PyObject* executemany_batches(Cursor* cur, PyObject* pSql, PyObject* iter, ParamMemo* memo)
+{
+    // The rows are read into batches of cParamArrayRows, each of which is bound as parameter arrays and executed
+    // once.
+
+    Object     rows(PyList_New(0));
+    Py_ssize_t iFirstRow     = 0;
+    SQLLEN     cRowsAffected = 0;
+
+    if (!rows)
+        return 0;
+
+    for (;;)
+    {
+        Object row(PyIter_Next(iter));
+        if (!row && PyErr_Occurred())
+            return 0;
+
+        if (row && PyList_Append(rows, row) != 0)
+            return 0;
+
+        Py_ssize_t cRows = PyList_GET_SIZE(rows.Get());
+        if (cRows == cParamArrayRows || (!row && cRows != 0))
+        {
+            if (!ExecuteBatch(cur, pSql, rows, iFirstRow, cRowsAffected, memo))
+            {
+                cur->rowcount = -1;
+                return 0;
+            }
+
+            iFirstRow += cRows;
+            if (PyList_SetSlice(rows, 0, cRows, 0) != 0)
+                return 0;
+        }
+
+        if (!row)
+            break;
+    }
+
+    cur->rowcount = (int)cRowsAffected;
+    Py_RETURN_NONE;
+}
+
+static PyObject* executemany_arrays(Cursor* cur, PyObject* pSql, PyObject* param_seq)
+{
+    // Implements executemany when fast_executemany is set.
+
+    Object iter(PyObject_GetIter(param_seq));
+    if (!iter)
+        return 0;
+
+    // The memo lasts for the whole call, so values repeated in different batches are only converted once.
+
+    ParamMemo  memo;
+    ParamMemo* pMemo = 0;
+    memo.entries = 0;
+    if (cur->parammemo)
+    {
+        if (!ParamMemo_Init(memo))
+            return 0;
+        pMemo = &memo;
+    }
+
+    PyObject* result = executemany_batches(cur, pSql, iter, pMemo);
+
+    cur->parammemo_hits   = pMemo ? memo.hits : 0;
+    cur->parammemo_misses = pMemo ? memo.misses : 0;
+    ParamMemo_Free(memo);
+
+    return result;
+}
+
 static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
 {
     Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
@@ -1256,6 +2020,9 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
             return 0;
         }
 
+        if (cursor->fastexecutemany)
+            return executemany_arrays(cursor, pSql, param_seq);
+
         for (Py_ssize_t i = 0; i < c; i++)
         {
             PyObject* params = PySequence_GetItem(param_seq, i);
@@ -1272,6 +2039,9 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
     }
     else if (PyGen_Check(param_seq) || PyIter_Check(param_seq))
     {
+        if (cursor->fastexecutemany)
+            return executemany_arrays(cursor, pSql, param_seq);
+
         Object iter;
 
         if (PyGen_Check(param_seq))
@@ -1313,6 +2083,173 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
 }
 
 
+#if PY_VERSION_HEX >= 0x02060000
+static PyObject* Cursor_executemany_columns(PyObject* self, PyObject* args)
+{
+    // Inserts rows held column-wise in buffer objects.  The columns are bound directly as parameter arrays and sent
+    // cParamArrayRows rows at a time, so no Python objects are created for the rows.
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    cursor->rowcount = -1;
+
+    PyObject *pSql, *columns;
+    if (!PyArg_ParseTuple(args, "OO", &pSql, &columns))
+        return 0;
+
+    if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
+    {
+        PyErr_SetString(PyExc_TypeError, "The first argument to executemany_columns must be a string or unicode query.");
+        return 0;
+    }
+
+    if (!PySequence_Check(columns) || PyString_Check(columns) || PyUnicode_Check(columns))
+    {
+        PyErr_SetString(PyExc_TypeError, "The second argument to executemany_columns must be a sequence of columns.");
+        return 0;
+    }
+
+    if (!free_results(cursor, FREE_STATEMENT | KEEP_PREPARED))
+        return 0;
+
+    Py_ssize_t cRows;
+    if (!BindParamColumns(cursor, pSql, columns, cParamArrayRows, cRows))
+        return 0;
+
+    SQLLEN cRowsAffected = 0;
+
+    for (Py_ssize_t iFirstRow = 0; iFirstRow < cRows; iFirstRow += cParamArrayRows)
+    {
+        Py_ssize_t cChunk = min(cRows - iFirstRow, cParamArrayRows);
+        if (!BindParamColumnRows(cursor, iFirstRow, cChunk) || !ExecuteParamArrays(cursor, cChunk, iFirstRow, cRowsAffected))
+        {
+            FreeParameterData(cursor);
+            return 0;
+        }
+    }
+
+    FreeParameterData(cursor);
+
+    cursor->rowcount = (int)cRowsAffected;
+    Py_RETURN_NONE;
+}
+#endif
+
+#if PY_VERSION_HEX >= 0x02070000
+static bool ExecuteArrowStream(Cursor* cur, PyObject* pSql, ArrowArrayStream* stream, SQLLEN& cRowsAffected)
+{
+    // Binds and executes every batch of `stream`, cParamArrayRows rows at a time or fewer when they hold long strings.
+    // The caller releases the stream.
+
+    ArrowSchema schema;
+    memset(&schema, 0, sizeof(schema));
+
+    int err = stream->get_schema(stream, &schema);
+    if (err != 0)
+        return Arrow_RaiseStreamError(stream, "get_schema", err);
+
+    bool fSuccess = BindParamArrowColumns(cur, pSql, &schema, cParamArrayRows);
+
+    Py_ssize_t iFirstRow = 0;   // counting from the start of the stream, for errors
+
+    while (fSuccess)
+    {
+        ArrowArray batch;
+        memset(&batch, 0, sizeof(batch));
+
+        err = stream->get_next(stream, &batch);
+        if (err != 0)
+        {
+            fSuccess = Arrow_RaiseStreamError(stream, "get_next", err);
+            break;
+        }
+
+        if (batch.release == 0)
+            break;              // the end of the stream
+
+        Py_ssize_t iRow = 0;
+        while (fSuccess && iRow < (Py_ssize_t)batch.length)
+        {
+            // BindParamArrowRows binds fewer rows than asked for if they contain long strings.
+            Py_ssize_t cRows = min((Py_ssize_t)batch.length - iRow, cParamArrayRows);
+            void* pChunk = 0;
+
+            fSuccess = BindParamArrowRows(cur, &schema, &batch, iRow, cRows, pChunk) &&
+                       ExecuteParamArrays(cur, cRows, iFirstRow + iRow, cRowsAffected);
+
+            if (pChunk)
+                Arena_Rewind(cur->paramarena, pChunk);
+
+            iRow += cRows;
+        }
+
+        iFirstRow += (Py_ssize_t)batch.length;
+        batch.release(&batch);
+    }
+
+    FreeParameterData(cur);
+
+    if (schema.release)
+        schema.release(&schema);
+
+    return fSuccess;
+}
+
+static PyObject* Cursor_executemany_arrow(PyObject* self, PyObject* args)
+{
+    // Inserts the rows of an Arrow stream.  Each batch's buffers are bound as parameter arrays, converting only the
+    // columns whose layout differs from ODBC's, so no Python objects are created for the rows.
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    cursor->rowcount = -1;
+
+    PyObject *pSql, *source;
+    if (!PyArg_ParseTuple(args, "OO", &pSql, &source))
+        return 0;
+
+    if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
+    {
+        PyErr_SetString(PyExc_TypeError, "The first argument to executemany_arrow must be a string or unicode query.");
+        return 0;
+    }
+
+    Object capsule(Arrow_GetStreamCapsule(source));
+    if (!capsule)
+        return 0;
+
+    ArrowArrayStream* stream = (ArrowArrayStream*)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+    if (!stream)
+        return 0;
+
+    if (stream->release == 0)
+    {
+        PyErr_SetString(ProgrammingError, "The Arrow stream has already been consumed.");
+        return 0;
+    }
+
+    bool fSuccess = free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
+
+    SQLLEN cRowsAffected = 0;
+    if (fSuccess)
+        fSuccess = ExecuteArrowStream(cursor, pSql, stream, cRowsAffected);
+
+    // Releasing the stream marks it released, so the capsule's destructor leaves it alone.
+    stream->release(stream);
+
+    if (!fSuccess)
+        return 0;
+
+    cursor->rowcount = (int)cRowsAffected;
+    Py_RETURN_NONE;
+}
+#endif
+
+
 static PyObject* Cursor_fetch(Cursor* cur)
 {
     // Internal function to fetch a single row and construct a Row object from it.  Used by all of the fetching
@@ -2250,6 +3187,19 @@ static char arraysize_doc[] =
     "This read/write attribute specifies the number of rows to fetch at a time with\n" \
     "fetchmany(). It defaults to 1 meaning to fetch a single row at a time.";
 
+static char fast_executemany_doc[] =
+    "If True, executemany binds the parameters of up to 1000 rows at a time as\n" \
+    "parameter arrays and sends each batch to the database with a single execute.\n" \
+    "Iterators and generators are read one batch at a time.  Batches that can't be\n" \
+    "bound as arrays, such as a column with mixed types, are executed row by row.\n" \
+    "Defaults to False.";
+
+static char param_memo_doc[] =
+    "If True, fast_executemany converts each distinct string, datetime, Decimal,\n" \
+    "etc. in a column once and copies the result when the same value appears in\n" \
+    "another row.  Values are matched by identity and then by equality.  See\n" \
+    "param_memo_info.  Defaults to False.";
+
 static char connection_doc[] =
     "This read-only attribute return a reference to the Connection object on which\n" \
     "the cursor was created.\n" \
@@ -2262,6 +3212,8 @@ static PyMemberDef Cursor_members[] =
     {"rowcount",    T_INT,       offsetof(Cursor, rowcount),        READONLY, rowcount_doc },
     {"description", T_OBJECT_EX, offsetof(Cursor, description),     READONLY, description_doc },
     {"arraysize",   T_INT,       offsetof(Cursor, arraysize),       0,        arraysize_doc },
+    {"fast_executemany", T_BOOL, offsetof(Cursor, fastexecutemany), 0,  fast_executemany_doc },
+    {"param_memo",  T_BOOL,      offsetof(Cursor, parammemo),       0,        param_memo_doc },
     {"connection",  T_OBJECT_EX, offsetof(Cursor, cnxn),            READONLY, connection_doc },
     { 0 }
 };
@@ -2335,6 +3287,32 @@ static char executemany_doc[] =
     "Only the result of the final execution is returned.  See `execute` for a\n" \
     "description of parameter passing the return value.";
 
+static char executemany_columns_doc[] =
+    "executemany_columns(sql, columns) --> None\n" \
+    "\n" \
+    "Executes `sql` once for every row of data held column-wise, one column per\n" \
+    "parameter marker.  Each column is an object supporting the buffer protocol\n" \
+    "(a numpy array, array.array, memoryview, etc.) holding a contiguous, one\n" \
+    "dimensional array of integers, floats, bools, or fixed width byte strings.\n" \
+    "To insert NULLs, pass a (values, null_mask) tuple instead, where null_mask\n" \
+    "has one byte per row that is non-zero for NULL, such as a numpy bool array.\n" \
+    "\n" \
+    "The columns' memory is bound directly as parameter arrays and sent to the\n" \
+    "database up to 1000 rows at a time.";
+
+static char executemany_arrow_doc[] =
+    "executemany_arrow(sql, source) --> None\n" \
+    "\n" \
+    "Executes `sql` once for every row of an Arrow stream, with one column per\n" \
+    "parameter marker.  `source` is anything with an __arrow_c_stream__ method,\n" \
+    "such as a pyarrow Table or RecordBatchReader, or an arrow_array_stream\n" \
+    "PyCapsule.  The stream is read through the Arrow C stream interface, so\n" \
+    "pyarrow is not required.\n" \
+    "\n" \
+    "Integer, floating point, boolean, string, binary, date, and timestamp columns\n" \
+    "are supported.  Timestamps with a time zone are sent as UTC.  Each batch is\n" \
+    "bound as parameter arrays and sent to the database up to 1000 rows at a time.";
+
 static char nextset_doc[] = "nextset() --> True | None\n" \
     "\n" \
     "Jumps to the next resultset if the last sql has multiple resultset." \
@@ -2376,6 +3354,42 @@ static char fetchmany_doc[] =
     "not produce any result set or no call was issued yet.";
 
 
+static char param_arena_info_doc[] =
+    "param_arena_info() --> (used, highwater, capacity)\n"
+    "\n"
+    "Returns the number of bytes the cursor's parameter bindings are using, the most\n"
+    "they have used at once, and the size of the memory kept for them.  A capacity\n"
+    "that keeps growing indicates statements whose bindings are not reused.";
+
+static PyObject* Cursor_param_arena_info(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    const Arena& arena = cursor->paramarena;
+    return Py_BuildValue("(nnn)", (Py_ssize_t)arena.used, (Py_ssize_t)arena.highwater, (Py_ssize_t)arena.capacity);
+}
+
+static char param_memo_info_doc[] =
+    "param_memo_info() --> (hits, misses)\n"
+    "\n"
+    "Returns how many values the last fast_executemany with param_memo set copied\n"
+    "from an earlier row and how many it had to convert.";
+
+static PyObject* Cursor_param_memo_info(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    return Py_BuildValue("(ll)", cursor->parammemo_hits, cursor->parammemo_misses);
+}
+
 static char enter_doc[] = "__enter__() -> self.";
 static PyObject* Cursor_enter(PyObject* self, PyObject* args)
 {
@@ -2411,10 +3425,16 @@ static PyObject* Cursor_exit(PyObject* self, PyObject* args)
     
 static PyMethodDef Cursor_methods[] =
 {
-    { "callproc",         (PyCFunction)Cursor_callproc,         METH_VARARGS,               callproc_doc         },
+    { "callproc",         (PyCFunction)Cursor_callproc,         METH_VARARGS | METH_KEYWORDS, callproc_doc       },
     { "close",            (PyCFunction)Cursor_close,            METH_NOARGS,                close_doc            },
     { "execute",          (PyCFunction)Cursor_execute,          METH_VARARGS,               execute_doc          },
     { "executemany",      (PyCFunction)Cursor_executemany,      METH_VARARGS,               executemany_doc      },
+#if PY_VERSION_HEX >= 0x02060000
+    { "executemany_columns", (PyCFunction)Cursor_executemany_columns, METH_VARARGS,         executemany_columns_doc },
+#endif
+#if PY_VERSION_HEX >= 0x02070000
+    { "executemany_arrow", (PyCFunction)Cursor_executemany_arrow, METH_VARARGS,             executemany_arrow_doc },
+#endif
     { "setinputsizes",    (PyCFunction)Cursor_ignored,          METH_VARARGS,               ignored_doc          },
     { "setoutputsize",    (PyCFunction)Cursor_ignored,          METH_VARARGS,               ignored_doc          },
     { "fetchone",         (PyCFunction)Cursor_fetchone,         METH_NOARGS,                fetchone_doc         },
@@ -2434,6 +3454,8 @@ static PyMethodDef Cursor_methods[] =
     { "skip",             (PyCFunction)Cursor_skip,             METH_VARARGS,               skip_doc             },
     { "commit",           (PyCFunction)Cursor_commit,           METH_NOARGS,                commit_doc           },
     { "rollback",         (PyCFunction)Cursor_rollback,         METH_NOARGS,                rollback_doc         },
+    { "param_arena_info", (PyCFunction)Cursor_param_arena_info, METH_NOARGS,                param_arena_info_doc },
+    { "param_memo_info",  (PyCFunction)Cursor_param_memo_info,  METH_NOARGS,                param_memo_info_doc  },
     { "__enter__",        Cursor_enter,                         METH_NOARGS,                enter_doc            },
     { "__exit__",         Cursor_exit,                          METH_VARARGS,               exit_doc             },
     { 0, 0, 0, 0 }
@@ -2524,43 +3546,31 @@ Cursor_New(Connection* cnxn)
         cur->hstmt             = SQL_NULL_HANDLE;
         cur->description       = Py_None;
         cur->pPreparedSQL      = 0;
+        cur->inlist_source     = 0;
+        cur->inlist_shape      = 0;
+        cur->inlist_sql        = 0;
         cur->paramcount        = 0;
         cur->paramtypes        = 0;
         cur->paramInfos        = 0;
+        Arena_Init(cur->paramarena);
         cur->colinfos          = 0;
         cur->arraysize         = 1;
+        cur->fastexecutemany   = false;
+        cur->parammemo         = false;
+        cur->parammemo_hits    = 0;
+        cur->parammemo_misses  = 0;
         cur->rowcount          = -1;
         cur->map_name_to_index = 0;
 
         Py_INCREF(cnxn);
         Py_INCREF(cur->description);
 
-        SQLRETURN ret;
-        Py_BEGIN_ALLOW_THREADS
-        ret = SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &cur->hstmt);
-        Py_END_ALLOW_THREADS
-
-        if (!SQL_SUCCEEDED(ret))
+        if (!AllocStatementHandle(cnxn, cur->hstmt))
         {
-            RaiseErrorFromHandle("SQLAllocHandle", cnxn->hdbc, SQL_NULL_HANDLE);
             Py_DECREF(cur);
             return 0;
         }
 
-        if (cnxn->timeout)
-        {
-            Py_BEGIN_ALLOW_THREADS
-            ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)cnxn->timeout, 0);
-            Py_END_ALLOW_THREADS
-
-            if (!SQL_SUCCEEDED(ret))
-            {
-                RaiseErrorFromHandle("SQLSetStmtAttr(SQL_ATTR_QUERY_TIMEOUT)", cnxn->hdbc, cur->hstmt);
-                Py_DECREF(cur);
-                return 0;
-            }
-        }
-
         TRACE("cursor.new cnxn=%p hdbc=%d cursor=%p hstmt=%d\n", (Connection*)cur->cnxn, ((Connection*)cur->cnxn)->hdbc, cur, cur->hstmt);
     }
 
@@ -14,6 +14,8 @@
 #ifndef CURSOR_H
 #define CURSOR_H
 
+#include "arena.h"
+
 struct Connection;
 
 struct ColumnInfo
@@ -43,20 +45,41 @@ struct ParamInfo
     SQLULEN     ColumnSize;
     SQLSMALLINT DecimalDigits;
 
-    // The value pointer that will be bound.  If `alloc` is true, this was allocated with malloc and must be freed.
+    // The value pointer that will be bound.  If `allocated` is true, this is a buffer in the cursor's paramarena.
     // Otherwise it is zero or points into memory owned by the original Python parameter.
     SQLPOINTER ParameterValuePtr;
 
     SQLLEN BufferLength;
     SQLLEN StrLen_or_Ind;
 
-    // If true, the memory in ParameterValuePtr was allocated via malloc and must be freed.
+    // If true, the memory in ParameterValuePtr was allocated from the cursor's paramarena, so new values can be copied
+    // into it.  It is released when the arena is reset, not freed individually.
     bool allocated;
 
     // The python object containing the parameter value.  A reference to this object should be held until we have
     // finished using memory owned by it.
     PyObject* pParam;
 
+    // For streamed output parameters (SQL_PARAM_OUTPUT_STREAM and SQL_PARAM_INPUT_OUTPUT_STREAM), the value read with
+    // SQLGetData after the statement executed.  Zero for all other parameters.
+    PyObject* pOutput;
+
+    // When a batch of rows is bound as parameter arrays by BindParamArrays, the array of lengths or indicators, one
+    // per row, in the cursor's paramarena, and ParameterValuePtr points to the array of values.  Zero otherwise.
+    SQLLEN* StrLen_or_IndArray;
+
+#if PY_VERSION_HEX >= 0x02060000
+    // When a buffer-protocol object (memoryview, array, mmap, ...) is bound directly by GetBufferViewInfo, the view
+    // its memory was exported through, in the cursor's paramarena.  The exporter can't resize or free the memory while
+    // the view is held, so it is released as soon as the statement has executed (ReleaseParameterViews) or the value
+    // has been copied into a buffer of our own.  Zero otherwise.
+    Py_buffer* pView;
+
+    // For executemany_columns, the view of the column's null mask (one byte per row, non-zero for NULL), if it has
+    // one.  Released with pView.
+    Py_buffer* pNullMask;
+#endif
+
     // Optional data.  If used, ParameterValuePtr will point into this.
     union
     {
@@ -67,6 +90,8 @@ struct ParamInfo
         TIMESTAMP_STRUCT timestamp;
         DATE_STRUCT date;
         TIME_STRUCT time;
+        SQL_NUMERIC_STRUCT numeric;
+        SQLGUID guid;
     } Data;
 
     // Method to generate a python object from (this) ParamInfo.
@@ -99,17 +124,30 @@ struct Cursor
     int paramcount;
 
     // If non-zero, a pointer to an array of SQL type values allocated via malloc.  This is zero until we actually ask
-    // for the type of parameter, which is only when a parameter is None (NULL).  At that point, the entire array is
-    // allocated (length == paramcount) but all entries are set to SQL_UNKNOWN_TYPE.
+    // for the type of parameter, which is only when a parameter is None (NULL).  At that point, all of the parameters
+    // are described and the types are saved in the connection's paramtypes_cache.  When SQL is prepared, the types
+    // saved by another cursor are copied from the cache, if there.
     SQLSMALLINT* paramtypes;
 
-    // If non-zero, a pointer to a buffer containing the actual parameters bound.  If pPreparedSQL is zero, this should
-    // be freed using free and set to zero.
+    // If non-zero, a pointer to a buffer in paramarena containing the actual parameters bound.  FreeParameterData
+    // releases it and sets it to zero.
     //
-    // Even if the same SQL statement is executed twice, the parameter bindings are redone from scratch since we try to
-    // bind into the Python objects directly.
+    // The bindings are kept after an execute.  If the same SQL statement is executed again, values that fit are copied
+    // into the bound buffers and only parameters whose type or size changed are bound again.  (The first bindings may
+    // point into the Python objects directly, so those are moved into buffers of their own the second time.)
     ParamInfo* paramInfos;
 
+    // The memory for paramInfos and the buffers they bind.  Everything is released at once by FreeParameterData, which
+    // resets the arena but keeps its memory, so executing statements of a similar size again doesn't call malloc.
+    Arena paramarena;
+
+    // The last SQL expanded for InList parameters: the caller's SQL, the bucket sizes of its InLists, and the expanded
+    // SQL.  Executing the same SQL with lists in the same buckets reuses the expanded object, so Prepare finds it by
+    // pointer.  All are zero until an InList is used.  See inlist.cpp.
+    PyObject* inlist_source;
+    PyObject* inlist_shape;
+    PyObject* inlist_sql;
+
     //
     // Result Information
     //
@@ -123,6 +161,17 @@ struct Cursor
 
     int arraysize;
 
+    // If true, executemany binds the rows in batches as parameter arrays and sends each batch with one SQLExecute
+    // instead of executing once per row.
+    bool fastexecutemany;
+
+    // If true, fast_executemany remembers the converted form of each string, datetime, Decimal, etc. and copies it
+    // when the same value appears in a later row.  The hits and misses of the last executemany are kept for
+    // param_memo_info.  See parammemo.cpp.
+    bool parammemo;
+    long parammemo_hits;
+    long parammemo_misses;
+
     // The Cursor.rowcount attribute from the DB API specification.
     int rowcount;
 
@@ -143,4 +192,7 @@ void Cursor_init();
 Cursor* Cursor_New(Connection* cnxn);
 PyObject* Cursor_execute(PyObject* self, PyObject* args);
 
+// Executes the statement bound by PrepareAndBindFixed and returns the output parameter values.  Used by Procedure.
+PyObject* Cursor_ExecuteProcedure(Cursor* cur);
+
 #endif
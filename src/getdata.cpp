@@ -262,6 +262,17 @@ public:
         buffer = 0;
         return result;
     }
+
+    PyObject* DetachDecoded(Connection* cnxn)
+    {
+        // Returns SQL_C_CHAR text decoded with the connection's encoding.  The buffer is decoded in place and freed by
+        // the destructor, so there is no intermediate bytes object.
+
+        if (bytesUsed == SQL_NULL_DATA || buffer == 0)
+            Py_RETURN_NONE;
+
+        return Connection_DecodeText(cnxn, buffer, bytesUsed);
+    }
 };
 
 
@@ -298,6 +309,9 @@ static PyObject* GetDataString(Cursor* cur, Py_ssize_t iCol)
 
     SQLSMALLINT nTargetType;
 
+    // If the connection has an encoding, Unicode results are read as SQL_C_CHAR in that encoding and decoded here.
+    bool fDecode = false;
+
     switch (pinfo->sql_type)
     {
     case SQL_CHAR:
@@ -327,6 +341,12 @@ static PyObject* GetDataString(Cursor* cur, Py_ssize_t iCol)
         break;
     }
 
+    if (nTargetType == SQL_C_WCHAR && cur->cnxn->encoding)
+    {
+        nTargetType = SQL_C_CHAR;
+        fDecode     = true;
+    }
+
     char tempBuffer[1026]; // Pad with 2 bytes for driver bugs
     DataBuffer buffer(nTargetType, tempBuffer, sizeof(tempBuffer)-2);
 
@@ -402,7 +422,7 @@ static PyObject* GetDataString(Cursor* cur, Py_ssize_t iCol)
         }
 
         if (ret == SQL_SUCCESS || ret == SQL_NO_DATA)
-            return buffer.DetachValue();
+            return fDecode ? buffer.DetachDecoded(cur->cnxn) : buffer.DetachValue();
     }
 
     // REVIEW: Add an error message.
@@ -0,0 +1,393 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// InList parameters let a list be passed for an IN clause without building the SQL by hand:
+//
+//   cursor.execute("select * from t where id in (?)", pyodbc.InList(ids))
+//
+// Before the statement is prepared, the InList's marker is replaced by one marker per value and the values are passed
+// as ordinary parameters, so they are bound by BindParams like any other.  If every length were prepared as written,
+// each would be a different statement to the driver and the server's plan cache, so the number of markers is rounded
+// up to the next power of two and the extra markers are given copies of the last value, which don't change the result
+// of IN.  (For NOT IN, copies are also harmless; NULLs are not, so pad_with_null is only for callers who want them.)
+// Lists of 1 to 1000 values then use at most 11 statement shapes.
+//
+// An empty list is rejected when the InList is created.  No value list gives the right answer for both IN, which should
+// match nothing, and NOT IN, which should match everything, so the caller has to decide what an empty list means.
+
+#include "pyodbc.h"
+#include "inlist.h"
+#include "cursor.h"
+#include "stmtcache.h"
+#include "wrapper.h"
+#include "errors.h"
+#include "pyodbcmodule.h"
+
+static Py_ssize_t BucketSize(Py_ssize_t cValues)
+{
+    Py_ssize_t cMarkers = 1;
+    while (cMarkers < cValues)
+        cMarkers *= 2;
+    return cMarkers;
+}
+
+bool HasInList(PyObject* params, bool skip_first)
+{
+    Py_ssize_t c = PySequence_Size(params);
+    if (c == -1)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    for (Py_ssize_t i = skip_first ? 1 : 0; i < c; i++)
+    {
+        Object param(PySequence_GetItem(params, i));
+        if (!param)
+        {
+            PyErr_Clear();
+            return false;
+        }
+        if (InList_Check(param.Get()))
+            return true;
+    }
+
+    return false;
+}
+
+static PyObject* ExpandSQL(PyObject* pSql, PyObject* shape)
+{
+    // Returns a new SQL object like pSql with the i'th parameter marker repeated shape[i] times.  (Entries of zero are
+    // parameters that aren't InLists.)  Markers in quoted strings and identifiers and in comments are skipped.
+
+    Object      encoded;
+    const char* pch;
+    Py_ssize_t  cch;
+
+    if (PyUnicode_Check(pSql))
+    {
+        encoded = PyUnicode_AsUTF8String(pSql);
+        if (!encoded)
+            return 0;
+        pch = PyBytes_AS_STRING(encoded.Get());
+        cch = PyBytes_GET_SIZE(encoded.Get());
+    }
+    else
+    {
+        pch = PyBytes_AS_STRING(pSql);
+        cch = PyBytes_GET_SIZE(pSql);
+    }
+
+    // Each marker repeated n times becomes "?, ?, ..., ?", which is 3n - 2 characters.
+
+    Py_ssize_t cParams = PyTuple_GET_SIZE(shape);
+    Py_ssize_t cbMax   = cch;
+    Py_ssize_t iLast   = -1;         // the last InList parameter, whose marker must be found
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        Py_ssize_t cMarkers = PyLong_AsSsize_t(PyTuple_GET_ITEM(shape, i));
+        if (cMarkers > 0)
+        {
+            cbMax += cMarkers * 3 - 3;
+            iLast = i;
+        }
+    }
+
+    char* pb = (char*)pyodbc_malloc((size_t)cbMax);
+    if (pb == 0)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+
+    Py_ssize_t cb     = 0;
+    Py_ssize_t iParam = 0;
+
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        char ch = pch[i];
+
+        Py_ssize_t iEnd = i;    // the last character to copy as is
+
+        if (ch == '\'' || ch == '"')
+        {
+            // A doubled quote inside the string is treated as the end of one string and the start of another.
+            iEnd = i + 1;
+            while (iEnd < cch && pch[iEnd] != ch)
+                iEnd++;
+        }
+        else if (ch == '-' && i + 1 < cch && pch[i + 1] == '-')
+        {
+            iEnd = i + 2;
+            while (iEnd < cch && pch[iEnd] != '\n')
+                iEnd++;
+        }
+        else if (ch == '/' && i + 1 < cch && pch[i + 1] == '*')
+        {
+            iEnd = i + 2;
+            while (iEnd + 1 < cch && !(pch[iEnd] == '*' && pch[iEnd + 1] == '/'))
+                iEnd++;
+            iEnd++;
+        }
+        else if (ch == '?')
+        {
+            Py_ssize_t cMarkers = iParam < cParams ? PyLong_AsSsize_t(PyTuple_GET_ITEM(shape, iParam)) : 0;
+            iParam++;
+
+            if (cMarkers > 0)
+            {
+                for (Py_ssize_t iMarker = 0; iMarker < cMarkers; iMarker++)
+                {
+                    if (iMarker != 0)
+                    {
+                        pb[cb++] = ',';
+                        pb[cb++] = ' ';
+                    }
+                    pb[cb++] = '?';
+                }
+                continue;
+            }
+        }
+
+        if (iEnd >= cch)
+            iEnd = cch - 1;
+        memcpy(&pb[cb], &pch[i], (size_t)(iEnd - i + 1));
+        cb += iEnd - i + 1;
+        i = iEnd;
+    }
+
+    if (iParam <= iLast)
+    {
+        pyodbc_free(pb);
+        return RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but %d parameters were supplied",
+                           (int)iParam, (int)cParams);
+    }
+
+    PyObject* result;
+    if (PyUnicode_Check(pSql))
+        result = PyUnicode_DecodeUTF8(pb, cb, "strict");
+    else
+        result = PyBytes_FromStringAndSize(pb, cb);
+
+    pyodbc_free(pb);
+    return result;
+}
+
+bool ExpandInLists(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, PyObject*& pNewSql,
+                   PyObject*& pNewParams)
+{
+    pNewSql    = 0;
+    pNewParams = 0;
+
+#if PY_MAJOR_VERSION >= 3
+    if (!PyUnicode_Check(pSql))
+    {
+        PyErr_SetString(PyExc_TypeError, "SQL must be a Unicode string");
+        return false;
+    }
+#endif
+
+    Py_ssize_t offset  = skip_first ? 1 : 0;
+    Py_ssize_t cParams = PySequence_Size(params) - offset;
+    if (cParams < 0)
+        return false;
+
+    // The shape is the number of markers for each parameter, or zero if it is not an InList.  The parameters are
+    // flattened at the same time.
+
+    Object shape(PyTuple_New(cParams));
+    Object flat(PyList_New(0));
+    if (!shape || !flat)
+        return false;
+
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        Object param(PySequence_GetItem(params, i + offset));
+        if (!param)
+            return false;
+
+        Py_ssize_t cMarkers = 0;
+
+        if (InList_Check(param.Get()))
+        {
+            InList*    list    = (InList*)param.Get();
+            Py_ssize_t cValues = PyTuple_GET_SIZE(list->values);
+            cMarkers = BucketSize(cValues);
+
+            for (Py_ssize_t iValue = 0; iValue < cMarkers; iValue++)
+            {
+                PyObject* value;
+                if (iValue < cValues)
+                    value = PyTuple_GET_ITEM(list->values, iValue);
+                else if (list->pad_null)
+                    value = Py_None;
+                else
+                    value = PyTuple_GET_ITEM(list->values, cValues - 1);
+
+                if (PyList_Append(flat, value) != 0)
+                    return false;
+            }
+        }
+        else if (PyList_Append(flat, param) != 0)
+        {
+            return false;
+        }
+
+        PyObject* count = PyLong_FromSsize_t(cMarkers);
+        if (!count)
+            return false;
+        PyTuple_SET_ITEM(shape.Get(), i, count);
+    }
+
+    if (cur->inlist_sql == 0 || !IsSameSQL(pSql, cur->inlist_source) ||
+        PyObject_RichCompareBool(shape, cur->inlist_shape, Py_EQ) != 1)
+    {
+        PyObject* sql = ExpandSQL(pSql, shape);
+        if (!sql)
+            return false;
+
+        Py_XDECREF(cur->inlist_source);
+        Py_XDECREF(cur->inlist_shape);
+        Py_XDECREF(cur->inlist_sql);
+
+        Py_INCREF(pSql);
+        cur->inlist_source = pSql;
+        cur->inlist_shape  = shape.Detach();
+        cur->inlist_sql    = sql;
+    }
+
+    pNewParams = PyList_AsTuple(flat);
+    if (!pNewParams)
+        return false;
+
+    Py_INCREF(cur->inlist_sql);
+    pNewSql = cur->inlist_sql;
+
+    return true;
+}
+
+static char InList_doc[] =
+    "InList(values, pad_with_null=False)\n"
+    "\n"
+    "Wraps a sequence of values passed for a single parameter marker in an IN clause:\n"
+    "\n"
+    "  cursor.execute('select * from t where id in (?)', pyodbc.InList(ids))\n"
+    "\n"
+    "The marker is replaced by one marker per value, rounded up to the next power of\n"
+    "two so only a few statements are prepared.  The extra markers are given the last\n"
+    "value again, or NULL if pad_with_null is true.\n"
+    "\n"
+    "An empty sequence raises ValueError since SQL has no empty IN list.";
+
+static PyMemberDef InList_members[] =
+{
+    { "values",        T_OBJECT_EX, offsetof(InList, values),   READONLY, "a tuple of the values" },
+    { "pad_with_null", T_BOOL,      offsetof(InList, pad_null), READONLY, "pad with NULLs instead of the last value" },
+    { 0 }
+};
+
+static void InList_dealloc(InList* self)
+{
+    Py_XDECREF(self->values);
+#ifndef Py_TYPE
+    self->ob_type->tp_free((PyObject*)self);
+#else
+    Py_TYPE(self)->tp_free(self);
+#endif
+}
+
+static PyObject* InList_new(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+    PyObject* values;
+    PyObject* pad_null = 0;
+
+    static char* kwlist[] = { "values", "pad_with_null", 0 };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &values, &pad_null))
+        return 0;
+
+    // A string is a sequence, but is almost certainly a mistake here.
+
+    if (PyString_Check(values) || PyUnicode_Check(values) || PyBytes_Check(values))
+        return RaiseErrorV(0, PyExc_TypeError, "InList values must be a sequence of values, not a string");
+
+    int fPadNull = pad_null ? PyObject_IsTrue(pad_null) : 0;
+    if (fPadNull == -1)
+        return 0;
+
+    Object tuple(PySequence_Tuple(values));
+    if (!tuple)
+        return 0;
+
+    if (PyTuple_GET_SIZE(tuple.Get()) == 0)
+        return RaiseErrorV(0, PyExc_ValueError, "InList values cannot be empty");
+
+    InList* self = (InList*)type->tp_alloc(type, 0);
+    if (self == 0)
+        return 0;
+
+    self->values   = tuple.Detach();
+    self->pad_null = fPadNull != 0;
+
+    return (PyObject*)self;
+}
+
+PyTypeObject InListType =
+{
+#ifndef PyVarObject_HEAD_INIT
+    PyObject_HEAD_INIT(NULL)
+    0,                       /* ob_size */
+#else
+    PyVarObject_HEAD_INIT(NULL, 0)
+#endif
+    "pyodbc.InList",         /* tp_name */
+    sizeof(InList),          /* tp_basicsize */
+    0,                       /* tp_itemsize */
+    (destructor)InList_dealloc, /* tp_dealloc */
+    0,                       /* tp_print */
+    0,                       /* tp_getattr */
+    0,                       /* tp_setattr */
+    0,                       /* tp_compare */
+    0,                       /* tp_repr */
+    0,                       /* tp_as_number */
+    0,                       /* tp_as_sequence */
+    0,                       /* tp_as_mapping */
+    0,                       /* tp_hash */
+    0,                       /* tp_call */
+    0,                       /* tp_str */
+    0,                       /* tp_getattro */
+    0,                       /* tp_setattro */
+    0,                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,      /* tp_flags */
+    InList_doc,              /* tp_doc */
+    0,                       /* tp_traverse */
+    0,                       /* tp_clear */
+    0,                       /* tp_richcompare */
+    0,                       /* tp_weaklistoffset */
+    0,                       /* tp_iter */
+    0,                       /* tp_iternext */
+    0,                       /* tp_methods */
+    InList_members,          /* tp_members */
+    0,                       /* tp_getset */
+    0,                       /* tp_base */
+    0,                       /* tp_dict */
+    0,                       /* tp_descr_get */
+    0,                       /* tp_descr_set */
+    0,                       /* tp_dictoffset */
+    0,                       /* tp_init */
+    0,                       /* tp_alloc */
+    InList_new,              /* tp_new */
+};
+
+bool InList_init()
+{
+    return PyType_Ready(&InListType) >= 0;
+}
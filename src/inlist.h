@@ -0,0 +1,51 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef INLIST_H
+#define INLIST_H
+
+struct Cursor;
+
+// A list of values for an IN clause, written as a single parameter marker: `where id in (?)`.  See inlist.cpp.
+struct InList
+{
+    PyObject_HEAD
+
+    // A tuple of the values.
+    PyObject* values;
+
+    // If true, the list is padded to its bucket size with NULLs instead of copies of the last value.
+    bool pad_null;
+};
+
+extern PyTypeObject InListType;
+
+#define InList_Check(op) PyObject_TypeCheck(op, &InListType)
+
+bool InList_init();
+
+/*
+ * Returns true if any of the parameters in `params` is an InList.  (If skip_first is true, the first item is the SQL
+ * and is not examined.)
+ */
+bool HasInList(PyObject* params, bool skip_first);
+
+/*
+ * Replaces the parameter marker of each InList in `params` with one marker per value, rounded up to the next power of
+ * two, and flattens the values into a new tuple of parameters.  New references are returned in pNewSql and
+ * pNewParams; the SQL object is reused while the same SQL is executed with lists in the same buckets.
+ *
+ * If an error occurs, an exception is set and false is returned.
+ */
+bool ExpandInLists(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first, PyObject*& pNewSql,
+                   PyObject*& pNewParams);
+
+#endif // INLIST_H
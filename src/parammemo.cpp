@@ -0,0 +1,142 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// The memo is an open addressing hash table with a fixed number of slots, keyed by the value's hash.  Since it is
+// used for values that repeat, it simply stops growing when full rather than evicting anything, and long values are
+// left out so it stays small.
+//
+// Values are matched by identity first, which is what usually happens when the rows were built from the same objects,
+// and then by equality so equal strings read from a file into separate objects also match.  Only values of exactly
+// the same type match by equality.
+
+#include "pyodbc.h"
+#include "parammemo.h"
+
+static const int    cMemoSlots      = 2048;     // a power of 2
+static const int    cMaxMemoEntries = 1024;
+static const SQLLEN cbMaxMemoValue  = 4096;
+static const SQLLEN cbMaxMemoData   = 1024 * 1024;
+
+bool ParamMemo_Init(ParamMemo& memo)
+{
+    memo.count  = 0;
+    memo.cbData = 0;
+    memo.hits   = 0;
+    memo.misses = 0;
+
+    memo.entries = (ParamMemoEntry*)pyodbc_malloc(sizeof(ParamMemoEntry) * cMemoSlots);
+    if (!memo.entries)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    memset(memo.entries, 0, sizeof(ParamMemoEntry) * cMemoSlots);
+    return true;
+}
+
+void ParamMemo_Free(ParamMemo& memo)
+{
+    if (!memo.entries)
+        return;
+
+    for (int i = 0; i < cMemoSlots; i++)
+    {
+        if (memo.entries[i].value)
+        {
+            Py_DECREF(memo.entries[i].value);
+            pyodbc_free(memo.entries[i].pb);
+        }
+    }
+
+    pyodbc_free(memo.entries);
+    memo.entries = 0;
+    memo.count   = 0;
+}
+
+bool ParamMemo_Find(ParamMemo& memo, Py_ssize_t index, SQLSMALLINT ValueType, SQLSMALLINT DecimalDigits,
+                    PyObject* value, bool fIdentityOnly, SQLLEN cbMax, Py_hash_t& hash, const ParamMemoEntry*& entry)
+{
+    entry = 0;
+
+    hash = PyObject_Hash(value);
+    if (hash == -1)
+    {
+        PyErr_Clear();          // unhashable, so it isn't memoized
+        return true;
+    }
+
+    for (int i = (int)(hash & (cMemoSlots - 1)); memo.entries[i].value; i = (i + 1) & (cMemoSlots - 1))
+    {
+        const ParamMemoEntry& e = memo.entries[i];
+        if (e.hash != hash || e.index != index || e.ValueType != ValueType || e.DecimalDigits != DecimalDigits)
+            continue;
+
+        if (e.value != value)
+        {
+            if (fIdentityOnly || Py_TYPE(e.value) != Py_TYPE(value))
+                continue;
+
+            int eq = PyObject_RichCompareBool(e.value, value, Py_EQ);
+            if (eq == -1)
+                return false;
+            if (!eq)
+                continue;
+        }
+
+        if (e.cb > cbMax)
+        {
+            memo.misses++;
+            hash = -1;
+            return true;
+        }
+
+        memo.hits++;
+        entry = &e;
+        return true;
+    }
+
+    memo.misses++;
+    return true;
+}
+
+bool ParamMemo_Add(ParamMemo& memo, Py_ssize_t index, SQLSMALLINT ValueType, SQLSMALLINT DecimalDigits,
+                   PyObject* value, Py_hash_t hash, const void* pb, SQLLEN cb, SQLLEN ind)
+{
+    if (hash == -1 || memo.count == cMaxMemoEntries || cb > cbMaxMemoValue || memo.cbData + cb > cbMaxMemoData)
+        return true;
+
+    char* pbCopy = (char*)pyodbc_malloc((size_t)max(cb, (SQLLEN)1));
+    if (!pbCopy)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    memcpy(pbCopy, pb, (size_t)cb);
+
+    int i = (int)(hash & (cMemoSlots - 1));
+    while (memo.entries[i].value)
+        i = (i + 1) & (cMemoSlots - 1);
+
+    ParamMemoEntry& e = memo.entries[i];
+    e.value         = value;
+    e.hash          = hash;
+    e.index         = index;
+    e.ValueType     = ValueType;
+    e.DecimalDigits = DecimalDigits;
+    e.pb            = pbCopy;
+    e.cb            = cb;
+    e.ind           = ind;
+    Py_INCREF(value);
+
+    memo.count++;
+    memo.cbData += cb;
+    return true;
+}
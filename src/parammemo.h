@@ -0,0 +1,68 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef PARAMMEMO_H
+#define PARAMMEMO_H
+
+// A memo of parameter values already converted for a fast_executemany parameter array, so a value repeated in row
+// after row (a tenant ID, a batch date) is copied instead of converted again.  One is used for each executemany call
+// when Cursor.param_memo is set.  See parammemo.cpp.
+
+struct ParamMemoEntry
+{
+    // The key: the value, the parameter it was bound to, and the binding's C type and decimal digits (the scale of a
+    // NUMERIC), which determine how it was converted.
+    PyObject* value;
+    Py_hash_t hash;
+    Py_ssize_t index;
+    SQLSMALLINT ValueType;
+    SQLSMALLINT DecimalDigits;
+
+    // The converted bytes, including a string's null terminator, and the length indicator.
+    char* pb;
+    SQLLEN cb;
+    SQLLEN ind;
+};
+
+struct ParamMemo
+{
+    ParamMemoEntry* entries;    // a hash table of cMemoSlots entries, unused if value is zero
+    int count;
+    SQLLEN cbData;              // the total size of the converted bytes
+
+    long hits;
+    long misses;
+};
+
+bool ParamMemo_Init(ParamMemo& memo);
+void ParamMemo_Free(ParamMemo& memo);
+
+/*
+ * Looks up `value` for parameter `index` bound with `ValueType` and `DecimalDigits`, first by identity and then, unless
+ * fIdentityOnly is set, by equality.  Sets `entry` to the match or zero.  `hash` is set for ParamMemo_Add and is -1 if
+ * the value can't be memoized.
+ *
+ * A match whose converted bytes are larger than cbMax, the size of the slot they would be copied to, is a miss, but
+ * since the value is already memoized `hash` is set to -1 so it isn't added again.
+ *
+ * If an error occurs, an exception is set and false is returned.
+ */
+bool ParamMemo_Find(ParamMemo& memo, Py_ssize_t index, SQLSMALLINT ValueType, SQLSMALLINT DecimalDigits,
+                    PyObject* value, bool fIdentityOnly, SQLLEN cbMax, Py_hash_t& hash, const ParamMemoEntry*& entry);
+
+/*
+ * Remembers the converted form of a value just missed by ParamMemo_Find.  Does nothing once the memo is full.  Returns
+ * false with an exception set if out of memory.
+ */
+bool ParamMemo_Add(ParamMemo& memo, Py_ssize_t index, SQLSMALLINT ValueType, SQLSMALLINT DecimalDigits,
+                   PyObject* value, Py_hash_t hash, const void* pb, SQLLEN cb, SQLLEN ind);
+
+#endif // PARAMMEMO_H
@@ -10,6 +10,12 @@
 #include "errors.h"
 #include "dbspecific.h"
 #include "sqlwchar.h"
+#include "stmtcache.h"
+#include "arena.h"
+#include "arrow.h"
+#include "inlist.h"
+#include "adapters.h"
+#include "parammemo.h"
 #include <datetime.h>
 
 
@@ -24,6 +30,9 @@ struct SQLParameter
     int ostr_len;
 };
 
+// The default size of string and binary output buffers, used when an SQLParameter doesn't specify one.
+static const int cchDefaultOutputString = 2048;
+
 inline Connection* GetConnection(Cursor* cursor)
 {
     return (Connection*)cursor->cnxn;
@@ -31,15 +40,68 @@ inline Connection* GetConnection(Cursor* cursor)
 
 static bool GetParamType(Cursor* cur, Py_ssize_t iParam, SQLSMALLINT& type);
 
+static void ReleaseView(ParamInfo& info)
+{
+    // Releases the buffer view a parameter was bound through, along with our reference to the object, which may be a
+    // memoryview holding an export of its own.  Without pParam, CanReuseBinding won't reuse the binding, so the next
+    // execute binds the parameter again.
+
+#if PY_VERSION_HEX >= 0x02060000
+    if (info.pView)
+    {
+        PyBuffer_Release(info.pView);
+        info.pView = 0;
+        Py_CLEAR(info.pParam);
+    }
+    if (info.pNullMask)
+    {
+        PyBuffer_Release(info.pNullMask);
+        info.pNullMask = 0;
+    }
+#endif
+}
+
+static void FreeInfo(ParamInfo& info)
+{
+    // The buffers are in the cursor's arena and are released when it is reset.
+    ReleaseView(info);
+    Py_XDECREF(info.pParam);
+    Py_XDECREF(info.pOutput);
+}
+
 static void FreeInfos(ParamInfo* a, Py_ssize_t count)
 {
     for (Py_ssize_t i = 0; i < count; i++)
+        FreeInfo(a[i]);
+}
+
+static ParamInfo* AllocParamInfos(Cursor* cur, Py_ssize_t count)
+{
+    ParamInfo* infos = (ParamInfo*)Arena_Alloc(cur->paramarena, sizeof(ParamInfo) * count);
+    if (infos == 0)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+    memset(infos, 0, sizeof(ParamInfo) * count);
+    return infos;
+}
+
+static SQLWCHAR* AllocSQLWCHAR(Cursor* cur, PyObject* param, Py_ssize_t len, Py_ssize_t cchBuffer)
+{
+    // Returns a copy of the Unicode object `param`, which is `len` SQLWCHARs long, in a buffer from the cursor's arena
+    // with room for max(len, cchBuffer) characters and a NULL terminator.  If an error occurs, an exception is set and
+    // zero is returned.
+
+    SQLWCHAR* p = (SQLWCHAR*)Arena_Alloc(cur->paramarena, sizeof(SQLWCHAR) * (1 + max(len, cchBuffer)));
+    if (p == 0)
     {
-        if (a[i].allocated)
-            pyodbc_free(a[i].ParameterValuePtr);
-        Py_XDECREF(a[i].pParam);
+        PyErr_NoMemory();
+        return 0;
     }
-    pyodbc_free(a);
+    if (!SQLWCHAR_Copy(p, param))
+        return 0;
+    return p;
 }
 
 #define _MAKESTR(n) case n: return #n
@@ -81,6 +143,10 @@ static const char* CInputOutputName(SQLSMALLINT n)
         _MAKESTR(SQL_PARAM_INPUT);
         _MAKESTR(SQL_PARAM_INPUT_OUTPUT);
         _MAKESTR(SQL_PARAM_OUTPUT);
+#ifdef SQL_PARAM_OUTPUT_STREAM
+        _MAKESTR(SQL_PARAM_INPUT_OUTPUT_STREAM);
+        _MAKESTR(SQL_PARAM_OUTPUT_STREAM);
+#endif
     }
     return "unknown";
 }
@@ -132,6 +198,66 @@ static const char* CTypeName(SQLSMALLINT n)
     return "unknown";
 }
 
+inline bool IsOutputStream(SQLSMALLINT type)
+{
+#ifdef SQL_PARAM_OUTPUT_STREAM
+    return type == SQL_PARAM_OUTPUT_STREAM || type == SQL_PARAM_INPUT_OUTPUT_STREAM;
+#else
+    UNUSED(type);
+    return false;
+#endif
+}
+
+static bool SupportsOutputStreams(Cursor* cur, PyObject* param)
+{
+    // Streamed output parameters were added in ODBC 3.8 and are only implemented for the variable length types that
+    // can be read back in pieces with SQLGetData.
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+    Connection* cnxn = GetConnection(cur);
+    if (cnxn->odbc_major < 3 || (cnxn->odbc_major == 3 && cnxn->odbc_minor < 80))
+        return false;
+
+#if PY_VERSION_HEX >= 0x02060000
+    if (PyByteArray_Check(param))
+        return true;
+#endif
+    return PyBytes_Check(param) || PyUnicode_Check(param);
+#else
+    UNUSED(cur, param);
+    return false;
+#endif
+}
+
+static bool GetOutputStreamInfo(Cursor* cur, Py_ssize_t len, ParamInfo& info)
+{
+    // Binds a streamed output parameter.  Nothing is allocated up front -- the value is read in chunks with SQLGetData
+    // once the statement has executed (see ReadOutputStreamParameters in cursor.cpp).
+    //
+    // The ParamInfo itself is used as the token SQLParamData returns, both when the driver asks for the input part of
+    // an INPUT_OUTPUT_STREAM parameter and when it announces that an output stream is available.  The Python object
+    // can't be used since the same object (e.g. '') is often passed for more than one parameter.
+
+    info.ColumnSize        = 0;
+    info.ParameterValuePtr = &info;
+    info.BufferLength      = 0;
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+    if (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT_STREAM)
+    {
+        SQLLEN cb = (SQLLEN)len * (info.ValueType == SQL_C_WCHAR ? sizeof(SQLWCHAR) : 1);
+        info.StrLen_or_Ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC(cb) : SQL_DATA_AT_EXEC;
+    }
+    else
+#endif
+    {
+        UNUSED(len);
+        info.StrLen_or_Ind = 0;
+    }
+
+    return true;
+}
+
 static PyObject* ToNullInfo(const ParamInfo* info)
 {
     (void)info;
@@ -201,11 +327,23 @@ static bool GetBytesInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamIn
 #endif
 
     info.ColumnSize = (SQLUINTEGER)max(len, 1);
+    info.fnToPyObject = ToBytesInfo;
+
+    if (IsOutputStream(info.InputOutputType))
+    {
+#if PY_MAJOR_VERSION >= 3
+        info.ParameterType = SQL_LONGVARBINARY;
+#else
+        info.ParameterType = SQL_LONGVARCHAR;
+#endif
+        return GetOutputStreamInfo(cur, len, info);
+    }
+
     if (len <= cur->cnxn->binary_maxlength)
     {
         info.StrLen_or_Ind = len;
-        // FIXME: unixODBC does not support INPUT_STREAM & INPUT_OUTPUT_STREAM.
-        //        so here I'm just assuming the user would never use them.
+        // Streamed output parameters were handled above, and GetParameterInfo turns them into plain output parameters
+        // when the driver can't stream, so this is an ordinary bound buffer.
         if (info.InputOutputType == SQL_PARAM_INPUT) {
             info.BufferLength = len + 1;
             info.ParameterValuePtr = PyBytes_AS_STRING(param);
@@ -213,8 +351,9 @@ static bool GetBytesInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamIn
             if (ostr_len < len) {
                 ostr_len = (int)len;
             }
-            void* buf = pyodbc_malloc(ostr_len + 1);
+            void* buf = Arena_Alloc(cur->paramarena, ostr_len + 1);
             if (buf == NULL) {
+                PyErr_NoMemory();
                 return false;
             }
             if (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT) {
@@ -239,7 +378,71 @@ static bool GetBytesInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamIn
         info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)len) : SQL_DATA_AT_EXEC;
         info.ParameterValuePtr = param;
     }
-    info.fnToPyObject = ToBytesInfo;
+    return true;
+}
+
+static const char* GetEncodedText(Cursor* cur, PyObject* text, Py_ssize_t& cb, Object& encoded)
+{
+    // Returns the Unicode object `text` in the connection's encoding and sets `cb` to its length in bytes.  On Python
+    // 3.3+, UTF-8 is borrowed from the string, which caches it (ASCII strings are their own UTF-8), so it is valid as
+    // long as `text` is.  Otherwise the bytes are held by `encoded`.  Returns zero with an exception set on error.
+
+#if PY_VERSION_HEX >= 0x03030000
+    if (cur->cnxn->utf8)
+        return PyUnicode_AsUTF8AndSize(text, &cb);
+#endif
+
+    if (!encoded.Attach(Connection_EncodeText(cur->cnxn, text)))
+        return 0;
+
+    cb = PyBytes_GET_SIZE(encoded.Get());
+    return PyBytes_AS_STRING(encoded.Get());
+}
+
+static bool GetEncodedTextInfo(Cursor* cur, PyObject* param, ParamInfo& info)
+{
+    // Binds a Unicode input parameter as SQL_C_CHAR in the connection's encoding.
+
+    Object encoded;
+    Py_ssize_t cb;
+    const char* pch = GetEncodedText(cur, param, cb, encoded);
+    if (!pch)
+        return false;
+
+    info.ValueType  = SQL_C_CHAR;
+    info.ColumnSize = (SQLUINTEGER)max(cb, 1);
+
+    if (cb <= cur->cnxn->varchar_maxlength)
+    {
+        info.ParameterType = SQL_VARCHAR;
+        info.StrLen_or_Ind = cb;
+        info.BufferLength  = cb + 1;
+
+        if (!encoded)
+        {
+            info.ParameterValuePtr = (SQLPOINTER)pch;
+        }
+        else
+        {
+            char* pb = (char*)Arena_Alloc(cur->paramarena, (size_t)(cb + 1));
+            if (!pb)
+            {
+                PyErr_NoMemory();
+                return false;
+            }
+            memcpy(pb, pch, (size_t)(cb + 1));
+            info.ParameterValuePtr = pb;
+            info.allocated         = true;
+        }
+    }
+    else
+    {
+        // Too long to pass all at once, so we'll provide the data at execute.  The value is encoded again then.
+        info.ParameterType     = SQL_LONGVARCHAR;
+        info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)cb) : SQL_DATA_AT_EXEC;
+        info.ParameterValuePtr = param;
+    }
+
     return true;
 }
 
@@ -249,22 +452,40 @@ static PyObject* ToUnicodeInfo(const ParamInfo* info) {
 
 static bool GetUnicodeInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, int ostr_len)
 {
-    Py_UNICODE* pch = PyUnicode_AsUnicode(param);
-    Py_ssize_t  len = PyUnicode_GET_SIZE(param);
+    // Output parameters are always SQLWCHAR, since their buffers are sized in characters before the value is known.
+    if (cur->cnxn->encoding && info.InputOutputType == SQL_PARAM_INPUT)
+        return GetEncodedTextInfo(cur, param, info);
+
+    // The length in SQLWCHARs, which is what ODBC measures, not characters.
+    Py_ssize_t len = SQLWCHAR_Length(param);
+    if (len == -1)
+        return false;
 
     info.ValueType  = SQL_C_WCHAR;
     info.ColumnSize = (SQLUINTEGER)max(len, 1);
 
+    if (IsOutputStream(info.InputOutputType))
+    {
+        info.ParameterType = SQL_WLONGVARCHAR;
+        info.fnToPyObject  = ToUnicodeInfo;
+        return GetOutputStreamInfo(cur, len, info);
+    }
+
     if (len <= cur->cnxn->wvarchar_maxlength)
     {
         if (info.InputOutputType == SQL_PARAM_INPUT) {
             info.ParameterType = SQL_WVARCHAR;
             info.StrLen_or_Ind = (SQLINTEGER)(len * sizeof(SQLWCHAR));
             info.BufferLength = info.StrLen_or_Ind + sizeof(SQLWCHAR);
-            if (SQLWCHAR_SIZE == Py_UNICODE_SIZE) {
-                info.ParameterValuePtr = pch;
+            // Bind directly to the string's own characters when they are already SQLWCHARs.  Otherwise convert into
+            // the cursor's arena, which is reused by the next execute.
+            const SQLWCHAR* pch = SQLWCHAR_Borrow(param);
+            if (pch) {
+                info.ParameterValuePtr = (SQLPOINTER)pch;
             } else {
-                info.ParameterValuePtr = SQLWCHAR_FromUnicode(pch, len);
+                info.ParameterValuePtr = AllocSQLWCHAR(cur, param, len, 0);
+                if (!info.ParameterValuePtr)
+                    return false;
                 info.allocated = true;
             }
         } else {
@@ -274,10 +495,14 @@ static bool GetUnicodeInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
             info.ParameterType = SQL_WVARCHAR;
             info.ColumnSize    = ostr_len;
             if (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT) {
-                info.ParameterValuePtr = SQLWCHAR_FromUnicode(pch, len, ostr_len);
+                info.ParameterValuePtr = AllocSQLWCHAR(cur, param, len, ostr_len);
             } else {
-                info.ParameterValuePtr = pyodbc_malloc(sizeof(SQLWCHAR) * ostr_len);
+                info.ParameterValuePtr = Arena_Alloc(cur->paramarena, sizeof(SQLWCHAR) * (ostr_len + 1));
+                if (!info.ParameterValuePtr)
+                    PyErr_NoMemory();
             }
+            if (!info.ParameterValuePtr)
+                return false;
             info.StrLen_or_Ind = (SQLINTEGER)(len * sizeof(SQLWCHAR));
             info.BufferLength  = (SQLINTEGER)((ostr_len + 1) * sizeof(SQLWCHAR));
             info.allocated = true;
@@ -429,6 +654,228 @@ static bool GetIntInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo
 }
 #endif
 
+// SQL_NUMERIC_STRUCTs hold an unsigned 128-bit value in little-endian order, which is worked on here as four 32-bit
+// limbs so the arithmetic doesn't need a 128-bit type.
+
+static const int cMaxNumericPrecision = 38;
+
+static void NumericLoad(const SQL_NUMERIC_STRUCT& num, unsigned int* limbs)
+{
+    for (int i = 0; i < 4; i++)
+        limbs[i] = (unsigned int)num.val[i*4] | ((unsigned int)num.val[i*4+1] << 8) |
+                   ((unsigned int)num.val[i*4+2] << 16) | ((unsigned int)num.val[i*4+3] << 24);
+}
+
+static void NumericStore(const unsigned int* limbs, SQL_NUMERIC_STRUCT& num)
+{
+    for (int i = 0; i < 16; i++)
+        num.val[i] = (SQLCHAR)(limbs[i / 4] >> ((i % 4) * 8));
+}
+
+static bool NumericMulAdd(unsigned int* limbs, unsigned int mul, unsigned int add)
+{
+    // limbs = limbs * mul + add.  Returns false if the result doesn't fit in 128 bits.
+
+    UINT64 carry = add;
+    for (int i = 0; i < 4; i++)
+    {
+        carry   += (UINT64)limbs[i] * mul;
+        limbs[i] = (unsigned int)carry;
+        carry  >>= 32;
+    }
+    return carry == 0;
+}
+
+static unsigned int NumericDivMod(unsigned int* limbs, unsigned int div)
+{
+    // limbs = limbs / div.  Returns the remainder.
+
+    UINT64 rem = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        UINT64 cur = (rem << 32) | limbs[i];
+        limbs[i]   = (unsigned int)(cur / div);
+        rem        = cur % div;
+    }
+    return (unsigned int)rem;
+}
+
+static bool NumericIsZero(const unsigned int* limbs)
+{
+    return (limbs[0] | limbs[1] | limbs[2] | limbs[3]) == 0;
+}
+
+static int NumericDigits(const unsigned int* limbs)
+{
+    // The number of decimal digits in the value, counting zero as one digit.
+
+    unsigned int tmp[4] = { limbs[0], limbs[1], limbs[2], limbs[3] };
+    int digits = 0;
+    do
+    {
+        NumericDivMod(tmp, 10);
+        digits++;
+    }
+    while (!NumericIsZero(tmp));
+    return digits;
+}
+
+static bool GetNumericValue(PyObject* param, SQL_NUMERIC_STRUCT& num, bool& fFits)
+{
+    // Converts a Decimal or an int to a SQL_NUMERIC_STRUCT with the smallest precision and scale that hold it exactly.
+    // Sets fFits to false, without raising, for NaN, infinity, and values needing more than cMaxNumericPrecision
+    // digits.
+
+    memset(&num, 0, sizeof(num));
+    fFits = false;
+
+    unsigned int limbs[4] = { 0, 0, 0, 0 };
+    int scale = 0;
+
+    if (PyDecimal_Check(param))
+    {
+        Object t(PyObject_CallMethod(param, "as_tuple", 0));
+        if (!t)
+            return false;
+
+        PyObject* digits = PyTuple_GET_ITEM(t.Get(), 1);
+        PyObject* exp    = PyTuple_GET_ITEM(t.Get(), 2);
+#if PY_MAJOR_VERSION < 3
+        if (!PyInt_Check(exp) && !PyLong_Check(exp))
+#else
+        if (!PyLong_Check(exp))
+#endif
+            return true;        // NaN or Infinity
+
+        // The digits and any trailing zeros from a positive exponent must fit in the precision together.  (A value
+        // of that many digits always fits in 128 bits, so NumericMulAdd can't overflow.)
+
+        long       lExp  = PyInt_AsLong(exp);
+        Py_ssize_t count = PyTuple_GET_SIZE(digits);
+        if (count > cMaxNumericPrecision || -lExp > cMaxNumericPrecision ||
+            count + max(lExp, 0L) > cMaxNumericPrecision)
+            return true;
+
+        for (Py_ssize_t i = 0; i < count; i++)
+        {
+            if (!NumericMulAdd(limbs, 10, (unsigned int)PyInt_AsLong(PyTuple_GET_ITEM(digits, i))))
+                return true;
+        }
+
+        for (long i = 0; i < lExp; i++)
+        {
+            if (!NumericMulAdd(limbs, 10, 0))
+                return true;
+        }
+
+        scale    = (lExp < 0) ? (int)-lExp : 0;
+        num.sign = PyInt_AsLong(PyTuple_GET_ITEM(t.Get(), 0)) ? 0 : 1;
+    }
+    else
+    {
+        Object abs(PyNumber_Absolute(param));
+        if (!abs)
+            return false;
+
+        Object shift(PyLong_FromLong(64));
+        Object high(shift ? PyNumber_Rshift(abs, shift) : 0);
+        if (!high)
+            return false;
+
+        UINT64 hi = PyLong_AsUnsignedLongLong(high);
+        if (hi == (UINT64)-1 && PyErr_Occurred())
+        {
+            if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+                return false;
+            PyErr_Clear();
+            return true;
+        }
+
+        UINT64 lo = PyLong_AsUnsignedLongLongMask(abs);
+        if (lo == (UINT64)-1 && PyErr_Occurred())
+            return false;
+
+        limbs[0] = (unsigned int)lo;
+        limbs[1] = (unsigned int)(lo >> 32);
+        limbs[2] = (unsigned int)hi;
+        limbs[3] = (unsigned int)(hi >> 32);
+
+        int negative = PyObject_RichCompareBool(abs, param, Py_NE);
+        if (negative == -1)
+            return false;
+        num.sign = negative ? 0 : 1;
+    }
+
+    int precision = max(NumericDigits(limbs), scale);
+    if (precision > cMaxNumericPrecision)
+        return true;
+
+    NumericStore(limbs, num);
+    num.precision = (SQLCHAR)precision;
+    num.scale     = (SQLSCHAR)scale;
+    fFits = true;
+    return true;
+}
+
+static bool RescaleNumeric(SQL_NUMERIC_STRUCT& num, int precision, int scale)
+{
+    // Changes the scale of `num` to `scale` without changing its value.  Returns false, leaving `num` unchanged, if
+    // that would drop nonzero digits or need more than `precision` digits.
+
+    unsigned int limbs[4];
+    NumericLoad(num, limbs);
+
+    for (int s = num.scale; s < scale; s++)
+    {
+        if (!NumericMulAdd(limbs, 10, 0))
+            return false;
+    }
+
+    for (int s = num.scale; s > scale; s--)
+    {
+        if (NumericDivMod(limbs, 10) != 0)
+            return false;
+    }
+
+    if (max(NumericDigits(limbs), scale) > precision)
+        return false;
+
+    NumericStore(limbs, num);
+    num.precision = (SQLCHAR)precision;
+    num.scale     = (SQLSCHAR)scale;
+    return true;
+}
+
+static bool GetNumericInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, bool& fBound)
+{
+    // Binds a Decimal or an int as a SQL_NUMERIC_STRUCT if the connection allows it and the value fits.  Otherwise
+    // fBound is set to false and the caller binds it some other way.
+    //
+    // Drivers ignore the precision and scale passed to SQLBindParameter for SQL_C_NUMERIC, so BindParameter also sets
+    // them in the application parameter descriptor.
+
+    fBound = false;
+
+    if (!cur->cnxn->numeric_struct || info.InputOutputType != SQL_PARAM_INPUT)
+        return true;
+
+    if (!GetNumericValue(param, info.Data.numeric, fBound))
+        return false;
+    if (!fBound)
+        return true;
+
+    info.ValueType         = SQL_C_NUMERIC;
+    info.ParameterType     = SQL_NUMERIC;
+    info.ColumnSize        = info.Data.numeric.precision;
+    info.DecimalDigits     = info.Data.numeric.scale;
+    info.ParameterValuePtr = &info.Data.numeric;
+    info.BufferLength      = sizeof(info.Data.numeric);
+    info.StrLen_or_Ind     = sizeof(info.Data.numeric);
+    return true;
+}
+
+static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, int ostr_len);
+
 static PyObject* ToLongInfo(const ParamInfo* info)
 {
     return PyLong_FromLongLong(info->Data.i64);
@@ -436,8 +883,27 @@ static PyObject* ToLongInfo(const ParamInfo* info)
 
 static bool GetLongInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
-    // TODO: Overflow?
     info.Data.i64 = (INT64)PyLong_AsLongLong(param);
+    if (info.Data.i64 == -1 && PyErr_Occurred())
+    {
+        // Too large for a BIGINT, so try a NUMERIC, which holds 38 digits.
+        if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+            return false;
+        PyErr_Clear();
+
+        bool fBound;
+        if (!GetNumericInfo(cur, index, param, info, fBound))
+            return false;
+        if (fBound)
+            return true;
+
+        // The connection doesn't use SQL_NUMERIC_STRUCTs or the value needs more than 38 digits, so bind it as a
+        // decimal string like a Decimal.
+        Object dec(PyObject_CallFunctionObjArgs(decimal_type, param, 0));
+        if (!dec)
+            return false;
+        return GetDecimalInfo(cur, index, dec, info, 0);
+    }
 
     info.ValueType         = SQL_C_SBIGINT;
     info.ParameterType     = SQL_BIGINT;
@@ -470,7 +936,7 @@ static bool GetFloatInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamIn
     return true;
 }
 
-static char* CreateDecimalString(long sign, PyObject* digits, long exp, int ostr_len=0)
+static char* CreateDecimalString(Arena& arena, long sign, PyObject* digits, long exp, int ostr_len=0)
 {
     long count = (long)PyTuple_GET_SIZE(digits);
 
@@ -483,7 +949,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp, int ostr
 
         len = sign + count + exp + 1; // 1: NULL
         ostr_len = max((int)len, ostr_len);
-        pch = (char*)pyodbc_malloc((size_t)ostr_len);
+        pch = (char*)Arena_Alloc(arena, (size_t)ostr_len);
         if (pch)
         {
             char* p = pch;
@@ -502,7 +968,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp, int ostr
 
         len = sign + count + 2; // 2: decimal + NULL
         ostr_len = max((int)len, ostr_len);
-        pch = (char*)pyodbc_malloc((size_t)ostr_len);
+        pch = (char*)Arena_Alloc(arena, (size_t)ostr_len);
         if (pch)
         {
             char* p = pch;
@@ -524,7 +990,7 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp, int ostr
         len = sign + -exp + 3; // 3: leading zero + decimal + NULL
 
         ostr_len = max((int)len, ostr_len);
-        pch = (char*)pyodbc_malloc((size_t)ostr_len);
+        pch = (char*)Arena_Alloc(arena, (size_t)ostr_len);
         if (pch)
         {
             char* p = pch;
@@ -561,9 +1027,11 @@ static PyObject* ToDecimalInfo(const ParamInfo* info)
 
 static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, int ostr_len)
 {
-    // The NUMERIC structure never works right with SQL Server and probably a lot of other drivers.  We'll bind as a
-    // string.  Unfortunately, the Decimal class doesn't seem to have a way to force it to return a string without
-    // exponents, so we'll have to build it ourselves.
+    // Used when the value can't be bound as a SQL_NUMERIC_STRUCT by GetNumericInfo: the connection's numeric_struct
+    // is off (the structure only works if the precision and scale are set in the descriptor, which ODBC 2 drivers don't
+    // have), the parameter is an output parameter, or the value needs more than 38 digits.  Unfortunately, the Decimal
+    // class doesn't seem to have a way to force it to return a string without exponents, so we'll have to build it
+    // ourselves.
 
     Object t = PyObject_CallMethod(param, "as_tuple", 0);
     if (!t)
@@ -601,7 +1069,7 @@ static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
 
     I(info.ColumnSize >= (SQLULEN)info.DecimalDigits);
 
-    info.ParameterValuePtr = CreateDecimalString(sign, digits, exp, ostr_len);
+    info.ParameterValuePtr = CreateDecimalString(cur->paramarena, sign, digits, exp, ostr_len);
     if (!info.ParameterValuePtr)
     {
         PyErr_NoMemory();
@@ -643,8 +1111,9 @@ static bool GetBufferInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamI
             if (obuf_len < cb) {
                 obuf_len = (int)cb;
             }
-            void* buf = pyodbc_malloc(obuf_len);
+            void* buf = Arena_Alloc(cur->paramarena, obuf_len);
             if (buf == NULL) {
+                PyErr_NoMemory();
                 return false;
             }
             if (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT) {
@@ -684,6 +1153,14 @@ static bool GetByteArrayInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
     info.ValueType = SQL_C_BINARY;
 
     Py_ssize_t cb = PyByteArray_Size(param);
+    info.fnToPyObject = ToByteArrayInfo;
+
+    if (IsOutputStream(info.InputOutputType))
+    {
+        info.ParameterType = SQL_LONGVARBINARY;
+        return GetOutputStreamInfo(cur, cb, info);
+    }
+
     if (cb <= cur->cnxn->binary_maxlength)
     {
         info.ParameterType = SQL_VARBINARY;
@@ -696,8 +1173,9 @@ static bool GetByteArrayInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
             if (obuf_len < cb) {
                 obuf_len = (int)cb;
             }
-            void* buf = pyodbc_malloc(obuf_len);
+            void* buf = Arena_Alloc(cur->paramarena, obuf_len);
             if (buf == NULL) {
+                PyErr_NoMemory();
                 return false;
             }
             if (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT) {
@@ -717,42 +1195,306 @@ static bool GetByteArrayInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
         info.BufferLength      = sizeof(PyObject*); // How big is ParameterValuePtr; ODBC copies it and gives it back in SQLParamData
         info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)cb) : SQL_DATA_AT_EXEC;
     }
-    
-    info.fnToPyObject = ToByteArrayInfo;
+
     return true;
 }
 #endif
 
-static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
+#if PY_VERSION_HEX >= 0x02060000
+static bool GetBufferViewInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
-    // Determines the type of SQL parameter that will be used for this parameter based on the Python data type.
-    //
-    // Populates `info`.
+    // Any other object exporting a contiguous buffer, such as a memoryview, an array, a numpy array, or an mmap.  The
+    // exporter's memory is bound directly, like bytes, so large arrays aren't copied just to be sent.
 
-    // Hold a reference to param until info is freed, because info will often be holding data borrowed from param.
-    int ostr_len = 0;
-    if (PyObject_TypeCheck(param, (PyTypeObject*)SQLParameter_type))
+    if (info.InputOutputType != SQL_PARAM_INPUT)
     {
-        info.pParam = ((SQLParameter*)param)->value;
-        Py_INCREF(info.pParam);
-        info.InputOutputType = ((SQLParameter*)param)->type;
-        ostr_len = ((SQLParameter*)param)->ostr_len;
+        RaiseErrorV("HY105", ProgrammingError, "Buffer objects can only be input parameters.  param-index=%zd", index);
+        return false;
     }
-    else
+
+    Py_buffer* view = (Py_buffer*)Arena_Alloc(cur->paramarena, sizeof(Py_buffer));
+    if (view == 0)
     {
-        info.pParam = param;
-        Py_INCREF(info.pParam);
-        info.InputOutputType = SQL_PARAM_INPUT;
+        PyErr_NoMemory();
+        return false;
     }
 
-    if (info.pParam == Py_None)
-        return GetNullInfo(cur, index, info);
+    if (PyObject_GetBuffer(param, view, PyBUF_SIMPLE) != 0)
+    {
+        Arena_Rewind(cur->paramarena, view);
+        return false;
+    }
 
-    if (info.pParam == null_binary)
-        return GetNullBinaryInfo(cur, index, info);
+    Py_ssize_t cb = view->len;
+    info.ValueType = SQL_C_BINARY;
 
-    if (PyBytes_Check(info.pParam))
-        return GetBytesInfo(cur, index, info.pParam, info, ostr_len);
+    if (cb <= cur->cnxn->binary_maxlength)
+    {
+        info.ParameterType     = SQL_VARBINARY;
+        info.ColumnSize        = (SQLUINTEGER)max(cb, 1);
+        info.ParameterValuePtr = view->buf;
+        info.BufferLength      = cb;
+        info.StrLen_or_Ind     = cb;
+        info.pView             = view;
+    }
+    else
+    {
+        // Sent from a view of its own by ReadDataAtExecutionParameters.
+        PyBuffer_Release(view);
+        Arena_Rewind(cur->paramarena, view);
+
+        info.ParameterType     = SQL_LONGVARBINARY;
+        info.ParameterValuePtr = param;
+        info.ColumnSize        = (SQLUINTEGER)cb;
+        info.BufferLength      = sizeof(PyObject*); // How big is ParameterValuePtr; ODBC copies it and gives it back in SQLParamData
+        info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)cb) : SQL_DATA_AT_EXEC;
+    }
+
+    return true;
+}
+#endif
+
+static bool IsStream(PyObject* param)
+{
+    // Returns true for the parameters GetStreamInfo accepts: file-like objects with a read method and iterators.
+    return PyObject_HasAttrString(param, "read") || PyIter_Check(param);
+}
+
+static SQLLEN GetStreamLength(PyObject* param)
+{
+    // Returns the number of bytes left in a seekable file-like object, or -1 if it can't be determined.  The position
+    // is restored.
+
+    if (!PyObject_HasAttrString(param, "seek") || !PyObject_HasAttrString(param, "tell"))
+        return -1;
+
+    Object pos(PyObject_CallMethod(param, "tell", 0));
+    Object end(pos ? PyObject_CallMethod(param, "seek", "ii", 0, 2) : 0);
+    Object restored(end ? PyObject_CallMethod(param, "seek", "O", pos.Get()) : 0);
+
+    if (!restored)
+    {
+        PyErr_Clear();
+        return -1;
+    }
+
+    Py_ssize_t cbPos = PyNumber_AsSsize_t(pos, 0);
+    Py_ssize_t cbEnd = PyNumber_AsSsize_t(end, 0);
+    if (PyErr_Occurred())
+    {
+        PyErr_Clear();
+        return -1;
+    }
+
+    return (SQLLEN)max(cbEnd - cbPos, (Py_ssize_t)0);
+}
+
+static bool GetStreamInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
+{
+    // A readable binary file or an iterator of bytes chunks, bound with SQL_DATA_AT_EXEC and sent in pieces by
+    // ReadDataAtExecutionParameters so it never has to be in memory at once.
+
+    if (info.InputOutputType != SQL_PARAM_INPUT)
+    {
+        RaiseErrorV("HY105", ProgrammingError, "File-like objects and iterators can only be input parameters.  param-index=%zd", index);
+        return false;
+    }
+
+    // The length is only needed by drivers that require it up front.  They are given the remaining size of seekable
+    // files; other streams are sent without it and it is up to the driver whether that works.
+    SQLLEN cb = cur->cnxn->need_long_data_len ? GetStreamLength(param) : -1;
+
+    info.ValueType         = SQL_C_BINARY;
+    info.ParameterType     = SQL_LONGVARBINARY;
+    info.ColumnSize        = (SQLULEN)max(cb, (SQLLEN)0);
+    info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC(max(cb, (SQLLEN)0)) : SQL_DATA_AT_EXEC;
+    info.ParameterValuePtr = param;
+    return true;
+}
+
+static bool GetGuidInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
+{
+    // A uuid.UUID.  Its bytes attribute is the 16 bytes in big-endian (network) order, which is the order of the
+    // SQLGUID fields regardless of the platform's byte order.
+
+    Object bytes(PyObject_GetAttrString(param, "bytes"));
+    if (!bytes)
+        return false;
+    if (!PyBytes_Check(bytes) || PyBytes_GET_SIZE(bytes.Get()) != 16)
+    {
+        RaiseErrorV("HY105", ProgrammingError, "The UUID's bytes attribute is not 16 bytes.  param-index=%zd", index);
+        return false;
+    }
+
+    const unsigned char* pb = (const unsigned char*)PyBytes_AS_STRING(bytes.Get());
+    info.Data.guid.Data1 = ((unsigned int)pb[0] << 24) | ((unsigned int)pb[1] << 16) | ((unsigned int)pb[2] << 8) | pb[3];
+    info.Data.guid.Data2 = (unsigned short)((pb[4] << 8) | pb[5]);
+    info.Data.guid.Data3 = (unsigned short)((pb[6] << 8) | pb[7]);
+    memcpy(info.Data.guid.Data4, &pb[8], 8);
+
+    info.ValueType         = SQL_C_GUID;
+    info.ParameterType     = SQL_GUID;
+    info.ColumnSize        = 36;
+    info.ParameterValuePtr = &info.Data.guid;
+    info.BufferLength      = sizeof(info.Data.guid);
+    info.StrLen_or_Ind     = sizeof(info.Data.guid);
+    return true;
+}
+
+static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info);
+
+static bool GetAdaptedInfo(Cursor* cur, Py_ssize_t index, ParamInfo& info, bool& fBound)
+{
+    // Binds info.pParam using the connection's input adapter for its type, if it has one.  Otherwise fBound is set
+    // to false.
+
+    fBound = false;
+
+    InputAdapter adapter;
+    if (!InputAdapters_Lookup(cur->cnxn, Py_TYPE(info.pParam), adapter))
+        return false;
+
+    switch (adapter.kind)
+    {
+    case ADAPTER_INTEGER:
+    {
+        // __index__ returns an exact int, so values too large for a BIGINT can fall back to a NUMERIC.
+        Object value(PyNumber_Index(info.pParam));
+        if (!value)
+            return false;
+        fBound = true;
+        return GetLongInfo(cur, index, value, info);
+    }
+
+    case ADAPTER_FLOAT:
+        fBound = true;
+        return GetFloatInfo(cur, index, info.pParam, info) && !PyErr_Occurred();
+
+    case ADAPTER_BOOLEAN:
+    {
+        int n = PyObject_IsTrue(info.pParam);
+        if (n == -1)
+            return false;
+        fBound = true;
+        return GetBooleanInfo(cur, index, n ? Py_True : Py_False, info);
+    }
+
+    case ADAPTER_GUID:
+        fBound = true;
+        return GetGuidInfo(cur, index, info.pParam, info);
+
+    case ADAPTER_CALLABLE:
+    {
+        if (info.InputOutputType != SQL_PARAM_INPUT)
+            return true;
+
+        Object func(adapter.func);
+        Py_INCREF(func.Get());
+
+        Object value(PyObject_CallFunctionObjArgs(func, info.pParam, 0));
+        if (!value)
+            return false;
+        if (Py_TYPE(value.Get()) == Py_TYPE(info.pParam))
+        {
+            RaiseErrorV("HY105", ProgrammingError, "The input adapter for %s returned the same type.  param-index=%zd",
+                        Py_TYPE(info.pParam)->tp_name, index);
+            return false;
+        }
+
+        // The converted value replaces the original, since the binding may point into it.
+        Py_DECREF(info.pParam);
+        info.pParam = 0;
+        fBound = true;
+        return GetParameterInfo(cur, index, value, info);
+    }
+    }
+
+    return true;
+}
+
+static bool AdaptValue(Cursor* cur, PyObject* value, Object& adapted)
+{
+    // Used when copying a value into an existing binding.  If `value` has an input adapter that converts it to another
+    // type, `adapted` is set to the converted value.  UUIDs are copied by SetFixedParamValue directly.
+
+    InputAdapter adapter;
+    if (!InputAdapters_Lookup(cur->cnxn, Py_TYPE(value), adapter))
+        return false;
+
+    switch (adapter.kind)
+    {
+    case ADAPTER_INTEGER:
+        adapted = PyNumber_Index(value);
+        return adapted.IsValid();
+
+    case ADAPTER_FLOAT:
+        adapted = PyNumber_Float(value);
+        return adapted.IsValid();
+
+    case ADAPTER_BOOLEAN:
+    {
+        int n = PyObject_IsTrue(value);
+        if (n == -1)
+            return false;
+        adapted = PyBool_FromLong(n);
+        return true;
+    }
+
+    case ADAPTER_CALLABLE:
+    {
+        Object func(adapter.func);
+        Py_INCREF(func.Get());
+        adapted = PyObject_CallFunctionObjArgs(func, value, 0);
+        if (!adapted)
+            return false;
+        if (Py_TYPE(adapted.Get()) == Py_TYPE(value))
+            adapted = 0;        // reported as an invalid type by the caller
+        return true;
+    }
+    }
+
+    return true;
+}
+
+static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
+{
+    // Determines the type of SQL parameter that will be used for this parameter based on the Python data type.
+    //
+    // Populates `info`.
+
+    // Hold a reference to param until info is freed, because info will often be holding data borrowed from param.
+    int ostr_len = 0;
+    if (PyObject_TypeCheck(param, (PyTypeObject*)SQLParameter_type))
+    {
+        info.pParam = ((SQLParameter*)param)->value;
+        Py_INCREF(info.pParam);
+        info.InputOutputType = ((SQLParameter*)param)->type;
+        ostr_len = ((SQLParameter*)param)->ostr_len;
+    }
+    else
+    {
+        info.pParam = param;
+        Py_INCREF(info.pParam);
+        info.InputOutputType = SQL_PARAM_INPUT;
+    }
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+    if (IsOutputStream(info.InputOutputType) && !SupportsOutputStreams(cur, info.pParam))
+    {
+        // The driver (or the type) can't stream, so fall back to an ordinary output parameter bound to an ostr_len
+        // buffer.
+        info.InputOutputType = (info.InputOutputType == SQL_PARAM_OUTPUT_STREAM) ? SQL_PARAM_OUTPUT : SQL_PARAM_INPUT_OUTPUT;
+    }
+#endif
+
+    if (info.pParam == Py_None)
+        return GetNullInfo(cur, index, info);
+
+    if (info.pParam == null_binary)
+        return GetNullBinaryInfo(cur, index, info);
+
+    if (PyBytes_Check(info.pParam))
+        return GetBytesInfo(cur, index, info.pParam, info, ostr_len);
 
     if (PyBool_Check(info.pParam))
         return GetBooleanInfo(cur, index, info.pParam, info);
@@ -776,7 +1518,14 @@ static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
         return GetFloatInfo(cur, index, info.pParam, info);
 
     if (PyDecimal_Check(info.pParam))
+    {
+        bool fBound;
+        if (!GetNumericInfo(cur, index, info.pParam, info, fBound))
+            return false;
+        if (fBound)
+            return true;
         return GetDecimalInfo(cur, index, info.pParam, info, ostr_len);
+    }
 
 #if PY_VERSION_HEX >= 0x02060000
     if (PyByteArray_Check(info.pParam))
@@ -791,10 +1540,61 @@ static bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
         return GetBufferInfo(cur, index, info.pParam, info, ostr_len);
 #endif
 
+    bool fAdapted;
+    if (!GetAdaptedInfo(cur, index, info, fAdapted))
+        return false;
+    if (fAdapted)
+        return true;
+
+#if PY_VERSION_HEX >= 0x02060000
+    // Before the streams, since an mmap has a read method but is better bound in place.
+    if (PyObject_CheckBuffer(info.pParam))
+        return GetBufferViewInfo(cur, index, info.pParam, info);
+#endif
+
+    if (IsStream(info.pParam))
+        return GetStreamInfo(cur, index, info.pParam, info);
+
     RaiseErrorV("HY105", ProgrammingError, "Invalid parameter type.  param-index=%zd param-type=%s", index, Py_TYPE(info.pParam)->tp_name);
     return false;
 }
 
+static bool SetNumericDescriptor(Cursor* cur, Py_ssize_t index, const ParamInfo& info)
+{
+    // SQLBindParameter doesn't pass the precision and scale of a SQL_C_NUMERIC buffer to the driver -- ColumnSize and
+    // DecimalDigits describe the SQL type -- so most drivers assume a scale of 0 and truncate the value.  They have to
+    // be set in the application parameter descriptor.  Setting any field but SQL_DESC_DATA_PTR unbinds the record, so
+    // the data pointer is set again last.
+
+    SQLHDESC hdesc = 0;
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetStmtAttr(cur->hstmt, SQL_ATTR_APP_PARAM_DESC, &hdesc, 0, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetDescField(hdesc, (SQLSMALLINT)(index + 1), SQL_DESC_TYPE, (SQLPOINTER)SQL_C_NUMERIC, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetDescField(hdesc, (SQLSMALLINT)(index + 1), SQL_DESC_PRECISION, (SQLPOINTER)(SQLLEN)info.ColumnSize, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetDescField(hdesc, (SQLSMALLINT)(index + 1), SQL_DESC_SCALE, (SQLPOINTER)(SQLLEN)info.DecimalDigits, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetDescField(hdesc, (SQLSMALLINT)(index + 1), SQL_DESC_DATA_PTR, info.ParameterValuePtr, 0);
+    Py_END_ALLOW_THREADS
+
+    if (GetConnection(cur)->hdbc == SQL_NULL_HANDLE)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle("SQLSetDescField", GetConnection(cur)->hdbc, cur->hstmt);
+        return false;
+    }
+
+    return true;
+}
+
 bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
 {
     TRACE("BIND: param=%d InputOutputType=%d (%s) ValueType=%d (%s) ParameterType=%d (%s) ColumnSize=%d DecimalDigits=%d BufferLength=%d *pcb=%d\n",
@@ -803,7 +1603,8 @@ bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
 
     SQLRETURN ret = -1;
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLBindParameter(cur->hstmt, (SQLUSMALLINT)(index + 1), info.InputOutputType, info.ValueType, info.ParameterType, info.ColumnSize, info.DecimalDigits, info.ParameterValuePtr, info.BufferLength, &info.StrLen_or_Ind);
+    ret = SQLBindParameter(cur->hstmt, (SQLUSMALLINT)(index + 1), info.InputOutputType, info.ValueType, info.ParameterType, info.ColumnSize, info.DecimalDigits, info.ParameterValuePtr, info.BufferLength,
+                           info.StrLen_or_IndArray ? info.StrLen_or_IndArray : &info.StrLen_or_Ind);
     Py_END_ALLOW_THREADS;
 
     if (GetConnection(cur)->hdbc == SQL_NULL_HANDLE)
@@ -819,6 +1620,9 @@ bool BindParameter(Cursor* cur, Py_ssize_t index, ParamInfo& info)
         return false;
     }
 
+    if (info.ValueType == SQL_C_NUMERIC)
+        return SetNumericDescriptor(cur, index, info);
+
     return true;
 }
 
@@ -840,6 +1644,35 @@ void FreeParameterData(Cursor* cur)
         FreeInfos(cur->paramInfos, cur->paramcount);
         cur->paramInfos = 0;
     }
+
+    Arena_Reset(cur->paramarena);
+}
+
+void ReleaseParameterViews(Cursor* cur)
+{
+    // Called after the statement executes.  The bindings are kept, but buffer objects are let go entirely so they can
+    // be resized: the views bound in place and the objects too large to bind, which were sent at execution from views
+    // of their own.  Those parameters are bound again if the statement is executed again.
+
+    if (cur->paramInfos == 0)
+        return;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        ParamInfo& info = cur->paramInfos[i];
+
+        ReleaseView(info);
+
+#if PY_VERSION_HEX >= 0x02060000
+        if (info.pParam && info.ParameterValuePtr == (SQLPOINTER)info.pParam && info.ValueType == SQL_C_BINARY &&
+            PyObject_CheckBuffer(info.pParam) && !PyBytes_Check(info.pParam) && !PyByteArray_Check(info.pParam) &&
+            !PyUnicode_Check(info.pParam))
+        {
+            Py_CLEAR(info.pParam);
+            info.ParameterValuePtr = 0;
+        }
+#endif
+    }
 }
 
 void FreeParameterInfo(Cursor* cur)
@@ -859,13 +1692,12 @@ bool BindParams(Cursor* cur, PyObject* original_params, bool skip_first)
     int        params_offset = skip_first ? 1 : 0;
     Py_ssize_t cParams       = original_params == 0 ? 0 : PySequence_Length(original_params) - params_offset;
 
-    cur->paramInfos = (ParamInfo*)pyodbc_malloc(sizeof(ParamInfo) * cParams);
+    // Release the bindings kept from the previous execute, if any.
+    FreeParameterData(cur);
+
+    cur->paramInfos = AllocParamInfos(cur, cParams);
     if (cur->paramInfos == 0)
-    {
-        PyErr_NoMemory();
-        return 0;
-    }
-    memset(cur->paramInfos, 0, sizeof(ParamInfo) * cParams);
+        return false;
 
     // Since you can't call SQLDesribeParam *after* calling SQLBindParameter, we'll loop through all of the
     // GetParameterInfos first, then bind.
@@ -899,11 +1731,70 @@ bool BindParams(Cursor* cur, PyObject* original_params, bool skip_first)
     // statement.
     cur->paramcount = (int)cParams;
 
+    // Remember how much the bindings needed.  See RebindParams.
+    Arena_Mark(cur->paramarena);
+
     return true;
 }
 
-bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool skip_first)
+// The most statements whose parameter types are kept by a connection.  When full, the cache is emptied and starts over.
+static const Py_ssize_t cMaxCachedParamTypes = 500;
+
+static bool LoadParamTypes(Cursor* cur)
+{
+    // Copies the parameter types described by another cursor for the same SQL, if any, into cur->paramtypes.
+
+    Connection* cnxn = GetConnection(cur);
+
+    if (cnxn->paramtypes_cache == 0 || cur->paramtypes != 0 || cur->paramcount == 0)
+        return true;
+
+    PyObject* types = PyDict_GetItem(cnxn->paramtypes_cache, cur->pPreparedSQL);
+    if (types == 0 || PyBytes_GET_SIZE(types) != (Py_ssize_t)(sizeof(SQLSMALLINT) * cur->paramcount))
+        return true;
+
+    cur->paramtypes = (SQLSMALLINT*)pyodbc_malloc(sizeof(SQLSMALLINT) * cur->paramcount);
+    if (cur->paramtypes == 0)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    memcpy(cur->paramtypes, PyBytes_AS_STRING(types), sizeof(SQLSMALLINT) * cur->paramcount);
+    return true;
+}
+
+static bool SaveParamTypes(Cursor* cur)
+{
+    // Stores cur->paramtypes in the connection so other cursors preparing the same SQL can skip SQLDescribeParam.
+
+    Connection* cnxn = GetConnection(cur);
+
+    if (cur->pPreparedSQL == 0)
+        return true;            // callproc binds without preparing
+
+    if (cnxn->paramtypes_cache == 0)
+    {
+        cnxn->paramtypes_cache = PyDict_New();
+        if (cnxn->paramtypes_cache == 0)
+            return false;
+    }
+    else if (PyDict_Size(cnxn->paramtypes_cache) >= cMaxCachedParamTypes)
+    {
+        PyDict_Clear(cnxn->paramtypes_cache);
+    }
+
+    Object types(PyBytes_FromStringAndSize((const char*)cur->paramtypes, sizeof(SQLSMALLINT) * cur->paramcount));
+    if (!types)
+        return false;
+
+    return PyDict_SetItem(cnxn->paramtypes_cache, cur->pPreparedSQL, types) == 0;
+}
+
+bool Prepare(Cursor* cur, PyObject* pSql)
 {
+    // Prepares the SQL if it isn't already the cursor's prepared statement, setting pPreparedSQL and paramcount.
+
 #if PY_MAJOR_VERSION >= 3
     if (!PyUnicode_Check(pSql))
     {
@@ -912,33 +1803,40 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
     }
 #endif
 
-    //
-    // Normalize the parameter variables.
-    //
-
-    // Since we may replace parameters (we replace objects with Py_True/Py_False when writing to a bit/bool column),
-    // allocate an array and use it instead of the original sequence
-
-    int        params_offset = skip_first ? 1 : 0;
-    Py_ssize_t cParams       = original_params == 0 ? 0 : PySequence_Length(original_params) - params_offset;
-
-    //
-    // Prepare the SQL if necessary.
-    //
+    if (pSql != cur->pPreparedSQL && IsSameSQL(pSql, cur->pPreparedSQL))
+    {
+        // The same SQL in a different object, such as a string built again by the caller.  Hold the new object so the
+        // next execute with it is found by the pointer comparison.
+        Py_INCREF(pSql);
+        Py_DECREF(cur->pPreparedSQL);
+        cur->pPreparedSQL = pSql;
+    }
 
     if (pSql != cur->pPreparedSQL)
     {
+        // The bindings belong to the current statement, so they can't follow it into the cache or survive preparing
+        // a different one.
+        FreeParameterData(cur);
+
+        bool fPrepared;
+        if (!StatementCache_Prepare(cur, pSql, fPrepared))
+            return false;
+        if (fPrepared)
+            return LoadParamTypes(cur);
+
         FreeParameterInfo(cur);
 
         SQLRETURN ret = 0;
         SQLSMALLINT cParamsT = 0;
         const char* szErrorFunc = "SQLPrepare";
 
-        if (PyUnicode_Check(pSql))
+        if (PyUnicode_Check(pSql) && cur->cnxn->encoding)
         {
-            SQLWChar sql(pSql);
+            Object sql(Connection_EncodeText(cur->cnxn, pSql));
+            if (!sql)
+                return false;
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLPrepareW(cur->hstmt, sql, SQL_NTS);
+            ret = SQLPrepare(cur->hstmt, (SQLCHAR*)PyBytes_AS_STRING(sql.Get()), SQL_NTS);
             if (SQL_SUCCEEDED(ret))
             {
                 szErrorFunc = "SQLNumParams";
@@ -946,49 +1844,1720 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
             }
             Py_END_ALLOW_THREADS
         }
-#if PY_MAJOR_VERSION < 3
-        else
+        else if (PyUnicode_Check(pSql))
         {
-            TRACE("SQLPrepare(%s)\n", PyString_AS_STRING(pSql));
+            SQLWChar sql(pSql);
             Py_BEGIN_ALLOW_THREADS
-            ret = SQLPrepare(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
+            ret = SQLPrepareW(cur->hstmt, sql, SQL_NTS);
+            if (SQL_SUCCEEDED(ret))
+            {
+                szErrorFunc = "SQLNumParams";
+                ret = SQLNumParams(cur->hstmt, &cParamsT);
+            }
+            Py_END_ALLOW_THREADS
+        }
+#if PY_MAJOR_VERSION < 3
+        else
+        {
+            TRACE("SQLPrepare(%s)\n", PyString_AS_STRING(pSql));
+            Py_BEGIN_ALLOW_THREADS
+            ret = SQLPrepare(cur->hstmt, (SQLCHAR*)PyString_AS_STRING(pSql), SQL_NTS);
             if (SQL_SUCCEEDED(ret))
             {
-                szErrorFunc = "SQLNumParams";
-                ret = SQLNumParams(cur->hstmt, &cParamsT);
+                szErrorFunc = "SQLNumParams";
+                ret = SQLNumParams(cur->hstmt, &cParamsT);
+            }
+            Py_END_ALLOW_THREADS
+        }
+#endif
+
+        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        {
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+            return false;
+        }
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle(szErrorFunc, GetConnection(cur)->hdbc, cur->hstmt);
+            return false;
+        }
+
+        cur->paramcount = (int)cParamsT;
+
+        cur->pPreparedSQL = pSql;
+        Py_INCREF(cur->pPreparedSQL);
+
+        if (!LoadParamTypes(cur))
+            return false;
+    }
+
+    return true;
+}
+
+static bool MakeFixedParamInfo(Cursor* cur, Py_ssize_t index, ParamInfo& info, Py_ssize_t cchCapacity);
+static bool SetFixedParamValue(Cursor* cur, Py_ssize_t index, PyObject* value, ParamInfo& info);
+static bool GetArrayValueLength(Cursor* cur, PyObject* value, Py_ssize_t& cch);
+static bool IsArrayCompatible(PyObject* value, PyObject* prototype);
+
+enum IntWidth
+{
+    INT_NONE,                   // not an int (or a bool)
+    INT_LONG,                   // fits a C long
+    INT_BIGINT,                 // fits a BIGINT
+    INT_LARGER,                 // bound as a NUMERIC or decimal string by GetLongInfo
+};
+
+static bool GetIntWidth(PyObject* value, IntWidth& width)
+{
+    // Determines the smallest binding an integer fits, since a binding made from one int is reused for others.
+
+    width = INT_NONE;
+
+    if (PyBool_Check(value))
+        return true;
+
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(value))
+    {
+        width = INT_LONG;
+        return true;
+    }
+#endif
+
+    if (!PyLong_Check(value))
+        return true;
+
+    PY_LONG_LONG n = PyLong_AsLongLong(value);
+    if (n == -1 && PyErr_Occurred())
+    {
+        if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+            return false;
+        PyErr_Clear();
+        width = INT_LARGER;
+        return true;
+    }
+
+    width = (n >= LONG_MIN && n <= LONG_MAX) ? INT_LONG : INT_BIGINT;
+    return true;
+}
+
+static bool CanReuseBinding(Cursor* cur, const ParamInfo& info, PyObject* value, bool& fReuse)
+{
+    // Determines whether `value` can be copied into the buffer already bound for a parameter.  This requires a value
+    // of the same Python type as the one the binding was made from and, for strings and binary values, a buffer we
+    // own that is large enough.
+
+    fReuse = false;
+
+    if (value == Py_None)
+    {
+        fReuse = true;          // only the indicator changes
+        return true;
+    }
+
+    if (info.pParam == 0)
+        return true;            // a buffer object, released by ReleaseView
+
+    if (info.ParameterValuePtr != 0 && info.ParameterValuePtr == (SQLPOINTER)info.pParam)
+        return true;            // SQL_DATA_AT_EXEC, which is bound to the object itself
+
+    if (!IsArrayCompatible(value, info.pParam))
+        return true;
+
+    if (info.ValueType == SQL_C_SBIGINT || info.ValueType == SQL_C_LONG)
+    {
+        // Reusable if the value fits the bound C type.  Larger ints are bound again, as a NUMERIC by GetLongInfo.
+        IntWidth width;
+        if (!GetIntWidth(value, width))
+            return false;
+        fReuse = (width == INT_LONG) || (width == INT_BIGINT && info.ValueType == SQL_C_SBIGINT);
+        return true;
+    }
+
+    if (info.ValueType == SQL_C_NUMERIC)
+    {
+        // Reusable if the value fits the bound precision and scale.
+        SQL_NUMERIC_STRUCT num;
+        bool fFits;
+        if (!GetNumericValue(value, num, fFits))
+            return false;
+        fReuse = fFits && RescaleNumeric(num, (int)info.ColumnSize, info.DecimalDigits);
+        return true;
+    }
+
+    Py_ssize_t cch;
+    if (!GetArrayValueLength(cur, value, cch))
+        return false;
+    if (cch < 0)
+        return true;
+
+    switch (info.ValueType)
+    {
+    case SQL_C_WCHAR:
+        fReuse = info.allocated && (SQLULEN)cch <= info.ColumnSize && (SQLLEN)((cch + 1) * sizeof(SQLWCHAR)) <= info.BufferLength;
+        break;
+
+    case SQL_C_CHAR:
+        fReuse = info.allocated && (SQLULEN)cch <= info.ColumnSize && (SQLLEN)(cch + 1) <= info.BufferLength;
+        break;
+
+    case SQL_C_BINARY:
+        fReuse = info.allocated && (SQLULEN)cch <= info.ColumnSize && (SQLLEN)cch <= info.BufferLength;
+        break;
+
+    default:
+        fReuse = true;
+        break;
+    }
+
+    return true;
+}
+
+static Py_ssize_t RebindCapacity(Cursor* cur, const ParamInfo& info, Py_ssize_t cch)
+{
+    // The buffer size, in characters or bytes, to give a string or binary parameter that is being bound again.  This
+    // is rounded up so a value that grows a little doesn't force another SQLBindParameter on the next execute.
+
+    int cchMax;
+    switch (info.ValueType)
+    {
+    case SQL_C_WCHAR:
+        cchMax = cur->cnxn->wvarchar_maxlength;
+        break;
+    case SQL_C_BINARY:
+        cchMax = cur->cnxn->binary_maxlength;
+        break;
+    default:
+        cchMax = cur->cnxn->varchar_maxlength;
+        break;
+    }
+
+    Py_ssize_t cchCapacity = 16;
+    while (cchCapacity < cch)
+        cchCapacity *= 2;
+
+    return max(cch, min(cchCapacity, (Py_ssize_t)cchMax));
+}
+
+static bool RebindParameter(Cursor* cur, Py_ssize_t index, PyObject* value, ParamInfo& info)
+{
+    // Replaces the binding for one parameter whose type or size changed.  Strings and binary values are moved into a
+    // buffer owned by the binding so later values can be copied in.
+
+    ParamInfo fresh;
+    memset(&fresh, 0, sizeof(fresh));
+
+    if (!GetParameterInfo(cur, index, value, fresh))
+    {
+        FreeInfo(fresh);
+        return false;
+    }
+
+    if ((fresh.ValueType == SQL_C_WCHAR || fresh.ValueType == SQL_C_CHAR || fresh.ValueType == SQL_C_BINARY) &&
+        !(fresh.ParameterValuePtr != 0 && fresh.ParameterValuePtr == (SQLPOINTER)fresh.pParam))
+    {
+        Py_ssize_t cch;
+        if (!GetArrayValueLength(cur, value, cch) ||
+            (cch >= 0 && !MakeFixedParamInfo(cur, index, fresh, RebindCapacity(cur, fresh, cch))))
+        {
+            FreeInfo(fresh);
+            return false;
+        }
+    }
+
+    if (fresh.ValueType == SQL_C_NUMERIC)
+    {
+        // Allow for larger values with the same scale, so only a change of scale binds it again.
+        fresh.ColumnSize             = cMaxNumericPrecision;
+        fresh.Data.numeric.precision = cMaxNumericPrecision;
+    }
+
+    FreeInfo(info);
+    info = fresh;
+
+    // Fixed size values point into the ParamInfo's own Data, so the pointer has to follow the copy.
+    if (fresh.ParameterValuePtr == (SQLPOINTER)&fresh.Data)
+        info.ParameterValuePtr = &info.Data;
+
+    return BindParameter(cur, index, info);
+}
+
+static bool RebindParams(Cursor* cur, PyObject* params, bool skip_first, bool& fReused)
+{
+    // Called when the statement whose parameters are still bound is executed again.  Values that fit the existing
+    // bindings are copied into the bound buffers and only the parameters whose type or size changed are bound again,
+    // so the GetParameterInfo chain and SQLBindParameter are skipped for the rest.
+    //
+    // If fReused is false on return, the caller must bind everything from scratch.
+
+    fReused = false;
+
+    // Bindings that are replaced leave their buffers in the arena until it is reset, which only happens when binding
+    // from scratch.  Once rebinding has used as much again as the original bindings (or a few KB for bindings that
+    // needed almost nothing), start over so an executemany whose types keep changing can't grow it without bound.
+    Arena& arena = cur->paramarena;
+    if (arena.used - arena.mark > max(arena.mark, (size_t)4096))
+        return true;
+
+    int params_offset = skip_first ? 1 : 0;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        ParamInfo& info = cur->paramInfos[i];
+
+        if (info.InputOutputType != SQL_PARAM_INPUT)
+            return true;
+
+        Object value(PySequence_GetItem(params, i + params_offset));
+        if (!value)
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+
+        if (PyObject_TypeCheck(value.Get(), (PyTypeObject*)SQLParameter_type))
+            return true;
+
+        bool fReuse;
+        if (!CanReuseBinding(cur, info, value, fReuse) ||
+            !(fReuse ? SetFixedParamValue(cur, i, value, info) : RebindParameter(cur, i, value, info)))
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+    }
+
+    fReused = true;
+    return true;
+}
+
+bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool skip_first)
+{
+    //
+    // Normalize the parameter variables.
+    //
+
+    // Since we may replace parameters (we replace objects with Py_True/Py_False when writing to a bit/bool column),
+    // allocate an array and use it instead of the original sequence
+
+    int        params_offset = skip_first ? 1 : 0;
+    Py_ssize_t cParams       = original_params == 0 ? 0 : PySequence_Length(original_params) - params_offset;
+
+    //
+    // If this statement was executed last, its parameters are still bound.  Copy the new values into the bound
+    // buffers where they fit.
+    //
+
+    if (cur->paramInfos != 0 && IsSameSQL(cur->pPreparedSQL, pSql) && cParams == cur->paramcount)
+    {
+        bool fReused;
+        if (!RebindParams(cur, original_params, skip_first, fReused))
+            return false;
+        if (fReused)
+            return true;
+    }
+
+    //
+    // Prepare the SQL if necessary.
+    //
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    if (cParams != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but %d parameters were supplied",
+                    cur->paramcount, cParams);
+        return false;
+    }
+
+    return BindParams(cur, original_params, skip_first);
+}
+
+static bool MakeFixedParamInfo(Cursor* cur, Py_ssize_t index, ParamInfo& info, Py_ssize_t cchCapacity)
+{
+    // Moves a variable length value into a buffer owned by `info` with room for at least cchCapacity characters (or
+    // bytes), so the binding stays valid when later values are copied in by SetFixedParams.  Fixed size values already
+    // live in info.Data; NUMERICs are given the largest precision so later values only need the same or fewer
+    // decimals.
+
+    if (info.ValueType == SQL_C_NUMERIC)
+    {
+        info.ColumnSize             = cMaxNumericPrecision;
+        info.Data.numeric.precision = cMaxNumericPrecision;
+        return true;
+    }
+
+    if (info.ValueType != SQL_C_WCHAR && info.ValueType != SQL_C_CHAR && info.ValueType != SQL_C_BINARY)
+        return true;
+
+    if (info.ParameterValuePtr == (SQLPOINTER)&info)
+        return true;            // a streamed output parameter, which has no buffer
+
+    if (info.ParameterValuePtr != 0 && info.ParameterValuePtr == (SQLPOINTER)info.pParam)
+    {
+        RaiseErrorV(0, ProgrammingError, "Parameter %zd is too large to be bound once; pass it to callproc instead.", index + 1);
+        return false;
+    }
+
+    SQLLEN cbChar = (info.ValueType == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+    SQLLEN cbNull = (info.ValueType == SQL_C_BINARY) ? 0 : cbChar;
+
+    SQLLEN cbValue = (info.ParameterValuePtr != 0 && info.StrLen_or_Ind > 0) ? info.StrLen_or_Ind : 0;
+
+    SQLLEN cbNeeded = max(cbValue, (SQLLEN)cchCapacity * cbChar) + cbNull;
+
+    if (!info.allocated || info.BufferLength < cbNeeded)
+    {
+        char* pb = (char*)Arena_Alloc(cur->paramarena, (size_t)cbNeeded);
+        if (!pb)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+        memset(pb, 0, (size_t)cbNeeded);
+        if (cbValue)
+            memcpy(pb, info.ParameterValuePtr, (size_t)cbValue);
+
+        // A smaller buffer from the arena is abandoned until the arena is reset.
+        info.ParameterValuePtr = pb;
+        info.allocated         = true;
+
+        // The value has been copied out of a buffer object's memory, so its view is no longer needed.
+        ReleaseView(info);
+    }
+
+    info.BufferLength = cbNeeded;
+    info.ColumnSize   = (SQLULEN)max((SQLLEN)info.ColumnSize, (cbNeeded - cbNull) / cbChar);
+
+    if (info.ParameterType == SQL_BINARY)
+        info.ParameterType = SQL_VARBINARY; // from BinaryNull
+
+    return true;
+}
+
+bool PrepareAndBindFixed(Cursor* cur, PyObject* pSql, PyObject* signature)
+{
+    // Prepares `pSql` and binds one parameter for each entry in `signature` into buffers owned by the cursor's
+    // ParamInfos.  Unlike BindParams, nothing is bound into the Python objects, so the bindings remain valid and later
+    // calls only need SetFixedParams and SQLExecute.
+    //
+    // Each entry in `signature` is a prototype value or SQLParameter that determines the parameter's type.  Strings and
+    // binary values are given room for their SQLParameter's ostr_len characters, or cchDefaultOutputString for bare
+    // prototypes.
+
+    FreeParameterData(cur);
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    Py_ssize_t cParams = PySequence_Length(signature);
+    if (cParams != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but %d parameters were supplied",
+                    cur->paramcount, cParams);
+        return false;
+    }
+
+    cur->paramInfos = AllocParamInfos(cur, cParams);
+    if (cur->paramInfos == 0)
+        return false;
+
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        // GetParameterInfo takes its own reference, so the one returned by PySequence_GetItem is released here.
+        Object param(PySequence_GetItem(signature, i));
+        int cchCapacity = cchDefaultOutputString;
+        if (param && PyObject_TypeCheck(param.Get(), (PyTypeObject*)SQLParameter_type))
+            cchCapacity = ((SQLParameter*)param.Get())->ostr_len;
+
+        if (!param || !GetParameterInfo(cur, i, param, cur->paramInfos[i]) || !MakeFixedParamInfo(cur, i, cur->paramInfos[i], cchCapacity))
+        {
+            FreeInfos(cur->paramInfos, cParams);
+            cur->paramInfos = 0;
+            return false;
+        }
+    }
+
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        if (!BindParameter(cur, i, cur->paramInfos[i]))
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool SetVariableLengthValue(Py_ssize_t index, const void* pv, Py_ssize_t cb, ParamInfo& info)
+{
+    SQLLEN cbNull = (info.ValueType == SQL_C_BINARY) ? 0 : 1;
+    if ((SQLLEN)cb + cbNull > info.BufferLength)
+    {
+        RaiseErrorV("22001", ProgrammingError, "Parameter %zd is too long: %zd bytes does not fit in the %zd byte buffer.",
+                    index + 1, cb, (Py_ssize_t)(info.BufferLength - cbNull));
+        return false;
+    }
+
+    memcpy(info.ParameterValuePtr, pv, (size_t)cb);
+    if (cbNull)
+        ((char*)info.ParameterValuePtr)[cb] = 0;
+    info.StrLen_or_Ind = (SQLLEN)cb;
+    return true;
+}
+
+static bool SetFixedParamValue(Cursor* cur, Py_ssize_t index, PyObject* value, ParamInfo& info)
+{
+    // Copies `value` into the buffer bound by PrepareAndBindFixed.  The binding is not changed, so the value must be
+    // of the type the parameter was bound with.
+
+    if (value == Py_None)
+    {
+        info.StrLen_or_Ind = SQL_NULL_DATA;
+        return true;
+    }
+
+    switch (info.ValueType)
+    {
+    case SQL_C_WCHAR:
+        if (PyUnicode_Check(value))
+        {
+            Py_ssize_t len = SQLWCHAR_Length(value);
+            if (len == -1)
+                return false;
+            if ((SQLLEN)((len + 1) * sizeof(SQLWCHAR)) > info.BufferLength)
+            {
+                RaiseErrorV("22001", ProgrammingError, "Parameter %zd is too long: %zd characters does not fit in the %zd character buffer.",
+                            index + 1, len, (Py_ssize_t)(info.BufferLength / sizeof(SQLWCHAR) - 1));
+                return false;
+            }
+            if (!SQLWCHAR_Copy((SQLWCHAR*)info.ParameterValuePtr, value))
+                return false;
+            info.StrLen_or_Ind = (SQLLEN)(len * sizeof(SQLWCHAR));
+            return true;
+        }
+        break;
+
+    case SQL_C_CHAR:
+        if (PyUnicode_Check(value) && cur->cnxn->encoding)
+        {
+            Object encoded;
+            Py_ssize_t cb;
+            const char* pch = GetEncodedText(cur, value, cb, encoded);
+            if (!pch)
+                return false;
+            return SetVariableLengthValue(index, pch, cb, info);
+        }
+        if (PyDecimal_Check(value))
+        {
+            // The string is only needed until it is copied into the bound buffer, so it is given back to the arena
+            // right away.  Otherwise procedures, whose bindings are never released, would grow it on every call.
+            ParamInfo tmp;
+            memset(&tmp, 0, sizeof(tmp));
+            if (!GetDecimalInfo(cur, index, value, tmp, 0))
+                return false;
+            bool ok = SetVariableLengthValue(index, tmp.ParameterValuePtr, (Py_ssize_t)tmp.StrLen_or_Ind, info);
+            Arena_Rewind(cur->paramarena, tmp.ParameterValuePtr);
+            return ok;
+        }
+#if PY_MAJOR_VERSION < 3
+        if (PyString_Check(value))
+            return SetVariableLengthValue(index, PyString_AS_STRING(value), PyString_GET_SIZE(value), info);
+#endif
+        break;
+
+    case SQL_C_BINARY:
+        if (PyBytes_Check(value))
+            return SetVariableLengthValue(index, PyBytes_AS_STRING(value), PyBytes_GET_SIZE(value), info);
+#if PY_VERSION_HEX >= 0x02060000
+        if (PyByteArray_Check(value))
+            return SetVariableLengthValue(index, PyByteArray_AS_STRING(value), PyByteArray_GET_SIZE(value), info);
+#endif
+#if PY_MAJOR_VERSION < 3
+        if (PyBuffer_Check(value))
+        {
+            const char* pb;
+            Py_ssize_t  cb = PyBuffer_GetMemory(value, &pb);
+            if (cb != -1)
+                return SetVariableLengthValue(index, pb, cb, info);
+        }
+#endif
+#if PY_VERSION_HEX >= 0x02060000
+        if (PyObject_CheckBuffer(value))
+        {
+            Py_buffer view;
+            if (PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) != 0)
+                return false;
+            bool ok = SetVariableLengthValue(index, view.buf, view.len, info);
+            PyBuffer_Release(&view);
+            return ok;
+        }
+#endif
+        break;
+
+    case SQL_C_BIT:
+        if (PyBool_Check(value))
+            return GetBooleanInfo(cur, index, value, info);
+        break;
+
+    case SQL_C_SBIGINT:
+    case SQL_C_LONG:
+#if PY_MAJOR_VERSION < 3
+        if (PyLong_Check(value) || PyInt_Check(value))
+#else
+        if (PyLong_Check(value))
+#endif
+        {
+            if (info.ValueType == SQL_C_SBIGINT)
+            {
+                info.Data.i64      = (INT64)PyLong_AsLongLong(value);
+                info.StrLen_or_Ind = sizeof(info.Data.i64);
+            }
+            else
+            {
+                info.Data.l        = PyInt_AsLong(value);
+                info.StrLen_or_Ind = sizeof(info.Data.l);
+            }
+            if (PyErr_Occurred())
+                return false;
+            return true;
+        }
+        break;
+
+    case SQL_C_DOUBLE:
+        if (PyFloat_Check(value))
+            return GetFloatInfo(cur, index, value, info);
+        break;
+
+    case SQL_C_NUMERIC:
+#if PY_MAJOR_VERSION < 3
+        if (PyDecimal_Check(value) || PyLong_Check(value) || PyInt_Check(value))
+#else
+        if (PyDecimal_Check(value) || PyLong_Check(value))
+#endif
+        {
+            SQL_NUMERIC_STRUCT num;
+            bool fFits;
+            if (!GetNumericValue(value, num, fFits))
+                return false;
+            if (!fFits || !RescaleNumeric(num, (int)info.ColumnSize, info.DecimalDigits))
+            {
+                RaiseErrorV("22003", ProgrammingError, "Parameter %zd does not fit the bound NUMERIC(%d, %d).",
+                            index + 1, (int)info.ColumnSize, (int)info.DecimalDigits);
+                return false;
+            }
+            info.Data.numeric  = num;
+            info.StrLen_or_Ind = sizeof(info.Data.numeric);
+            return true;
+        }
+        break;
+
+    case SQL_C_TIMESTAMP:
+        if (PyDateTime_Check(value))
+            return GetDateTimeInfo(cur, index, value, info);
+        break;
+
+    case SQL_C_TYPE_DATE:
+        if (PyDate_Check(value) && !PyDateTime_Check(value))
+            return GetDateInfo(cur, index, value, info);
+        break;
+
+    case SQL_C_TYPE_TIME:
+        if (PyTime_Check(value))
+            return GetTimeInfo(cur, index, value, info);
+        break;
+
+    case SQL_C_GUID:
+    {
+        InputAdapter adapter;
+        if (!InputAdapters_Lookup(cur->cnxn, Py_TYPE(value), adapter))
+            return false;
+        if (adapter.kind == ADAPTER_GUID)
+            return GetGuidInfo(cur, index, value, info);
+        break;
+    }
+    }
+
+    // A type with an input adapter, such as a numpy integer, is converted and tried again.
+    Object adapted;
+    if (!AdaptValue(cur, value, adapted))
+        return false;
+    if (adapted)
+        return SetFixedParamValue(cur, index, adapted, info);
+
+    RaiseErrorV("HY105", ProgrammingError, "Invalid parameter type for the bound %s parameter.  param-index=%zd param-type=%s",
+                CTypeName(info.ValueType), index, Py_TYPE(value)->tp_name);
+    return false;
+}
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+static bool SetFixedStreamValue(Cursor* cur, Py_ssize_t index, PyObject* value, ParamInfo& info)
+{
+    // The input half of an INPUT_OUTPUT_STREAM parameter is sent with SQLPutData from info.pParam when the driver asks
+    // for it, so there is no buffer to copy into -- just swap the object.
+
+    if (Py_TYPE(value) != Py_TYPE(info.pParam))
+    {
+        RaiseErrorV("HY105", ProgrammingError, "Invalid parameter type for the bound %s parameter.  param-index=%zd param-type=%s",
+                    Py_TYPE(info.pParam)->tp_name, index, Py_TYPE(value)->tp_name);
+        return false;
+    }
+
+    SQLLEN cb;
+    if (PyUnicode_Check(value))
+    {
+        Py_ssize_t len = SQLWCHAR_Length(value);
+        if (len == -1)
+            return false;
+        cb = (SQLLEN)(len * sizeof(SQLWCHAR));
+    }
+#if PY_VERSION_HEX >= 0x02060000
+    else if (PyByteArray_Check(value))
+        cb = (SQLLEN)PyByteArray_GET_SIZE(value);
+#endif
+    else
+        cb = (SQLLEN)PyBytes_GET_SIZE(value);
+
+    Py_INCREF(value);
+    Py_DECREF(info.pParam);
+    info.pParam = value;
+
+    info.StrLen_or_Ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC(cb) : SQL_DATA_AT_EXEC;
+    return true;
+}
+#endif
+
+bool SetFixedParams(Cursor* cur, PyObject* params)
+{
+    // Copies the values in `params` into the buffers bound by PrepareAndBindFixed.  One value is expected for each
+    // input and input/output parameter; output parameters are skipped.  A SQLParameter may be passed, in which case
+    // its value is used.
+
+    Py_ssize_t cValues = PySequence_Length(params);
+    Py_ssize_t iValue  = 0;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        ParamInfo& info = cur->paramInfos[i];
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+        bool fInputStream = (info.InputOutputType == SQL_PARAM_INPUT_OUTPUT_STREAM);
+#else
+        bool fInputStream = false;
+#endif
+
+        if (info.InputOutputType != SQL_PARAM_INPUT && info.InputOutputType != SQL_PARAM_INPUT_OUTPUT && !fInputStream)
+        {
+            // Output buffers are written by the driver, but reset the indicator so a NULL from the last call doesn't
+            // stick.
+            if (info.ParameterValuePtr != (SQLPOINTER)&info)
+                info.StrLen_or_Ind = 0;
+            continue;
+        }
+
+        if (iValue >= cValues)
+        {
+            RaiseErrorV(0, ProgrammingError, "Not enough parameters: %zd were supplied for %d input parameters.", cValues, i + 1);
+            return false;
+        }
+
+        Object value(PySequence_GetItem(params, iValue++));
+        if (!value)
+            return false;
+
+        PyObject* p = value.Get();
+        if (PyObject_TypeCheck(p, (PyTypeObject*)SQLParameter_type))
+            p = ((SQLParameter*)p)->value;
+
+#ifdef SQL_PARAM_OUTPUT_STREAM
+        if (fInputStream)
+        {
+            if (!SetFixedStreamValue(cur, i, p, info))
+                return false;
+            continue;
+        }
+#endif
+
+        if (!SetFixedParamValue(cur, i, p, info))
+            return false;
+    }
+
+    if (iValue != cValues)
+    {
+        RaiseErrorV(0, ProgrammingError, "Too many parameters: %zd were supplied for %zd input parameters.", cValues, iValue);
+        return false;
+    }
+
+    return true;
+}
+
+static bool GetAdaptedValueLength(Cursor* cur, PyObject* value, Py_ssize_t& cch, bool& fAdapted)
+{
+    // The GetArrayValueLength of a value with an input adapter.  Sets fAdapted to false if the type doesn't have one.
+
+    fAdapted = false;
+
+    InputAdapter adapter;
+    if (!InputAdapters_Lookup(cur->cnxn, Py_TYPE(value), adapter))
+        return false;
+    if (adapter.kind == ADAPTER_NONE)
+        return true;
+
+    fAdapted = true;
+
+    if (adapter.kind != ADAPTER_CALLABLE)
+    {
+        cch = 0;                // a fixed size binding
+        return true;
+    }
+
+    Object adapted;
+    if (!AdaptValue(cur, value, adapted))
+        return false;
+    if (!adapted)
+    {
+        cch = -1;
+        return true;
+    }
+    return GetArrayValueLength(cur, adapted, cch);
+}
+
+static bool GetBufferValueLength(Cursor* cur, PyObject* value, Py_ssize_t& cch)
+{
+    // The GetArrayValueLength of any other object, which is bound by GetBufferViewInfo if it exports a contiguous
+    // buffer.
+
+    cch = -1;
+
+#if PY_VERSION_HEX >= 0x02060000
+    if (PyObject_CheckBuffer(value))
+    {
+        Py_buffer view;
+        if (PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) != 0)
+        {
+            PyErr_Clear();      // not contiguous, so let GetParameterInfo report it
+            return true;
+        }
+        cch = view.len;
+        PyBuffer_Release(&view);
+        if (cch > cur->cnxn->binary_maxlength)
+            cch = -1;
+    }
+#endif
+
+    return true;
+}
+
+static bool GetArrayValueLength(Cursor* cur, PyObject* value, Py_ssize_t& cch)
+{
+    // Determines how many characters (or bytes) `value` needs in a parameter array.  Sets cch to 0 for fixed size
+    // types and to -1 if the value can't be array bound, in which case the batch is executed one row at a time.
+
+    cch = 0;
+
+    if (PyBool_Check(value) || PyLong_Check(value) || PyFloat_Check(value) || PyDateTime_Check(value) ||
+        PyDate_Check(value) || PyTime_Check(value))
+    {
+        return true;
+    }
+#if PY_MAJOR_VERSION < 3
+    if (PyInt_Check(value))
+        return true;
+#endif
+
+    if (PyUnicode_Check(value) && cur->cnxn->encoding)
+    {
+        // Bound as SQL_C_CHAR by GetEncodedTextInfo, so the length is in encoded bytes.
+        Object encoded;
+        if (!GetEncodedText(cur, value, cch, encoded))
+            return false;
+        if (cch > cur->cnxn->varchar_maxlength)
+            cch = -1;
+    }
+    else if (PyUnicode_Check(value))
+    {
+        cch = SQLWCHAR_Length(value);
+        if (cch == -1)
+            return false;
+        if (cch > cur->cnxn->wvarchar_maxlength)
+            cch = -1;
+    }
+#if PY_MAJOR_VERSION < 3
+    else if (PyString_Check(value))
+    {
+        cch = PyString_GET_SIZE(value);
+        if (cch > cur->cnxn->varchar_maxlength)
+            cch = -1;
+    }
+    else if (PyBuffer_Check(value))
+    {
+        const char* pb;
+        cch = PyBuffer_GetMemory(value, &pb);
+        if (cch > cur->cnxn->binary_maxlength)
+            cch = -1;
+    }
+#else
+    else if (PyBytes_Check(value))
+    {
+        cch = PyBytes_GET_SIZE(value);
+        if (cch > cur->cnxn->binary_maxlength)
+            cch = -1;
+    }
+#endif
+#if PY_VERSION_HEX >= 0x02060000
+    else if (PyByteArray_Check(value))
+    {
+        cch = PyByteArray_GET_SIZE(value);
+        if (cch > cur->cnxn->binary_maxlength)
+            cch = -1;
+    }
+#endif
+    else if (PyDecimal_Check(value))
+    {
+        // Decimals are bound as strings built by CreateDecimalString.  The digits, the zeros added by the exponent, a
+        // sign, a decimal point and a leading zero is an upper bound on the length.
+
+        Object t(PyObject_CallMethod(value, "as_tuple", 0));
+        if (!t)
+            return false;
+
+        PyObject* exp = PyTuple_GET_ITEM(t.Get(), 2);
+#if PY_MAJOR_VERSION < 3
+        if (!PyInt_Check(exp) && !PyLong_Check(exp))
+#else
+        if (!PyLong_Check(exp))
+#endif
+        {
+            cch = -1;               // NaN or Infinity
+            return true;
+        }
+
+        long l = PyInt_AsLong(exp);
+        cch = PyTuple_GET_SIZE(PyTuple_GET_ITEM(t.Get(), 1)) + (l < 0 ? -l : l) + 3;
+    }
+    else
+    {
+        bool fAdapted;
+        if (!GetAdaptedValueLength(cur, value, cch, fAdapted))
+            return false;
+        if (!fAdapted && !GetBufferValueLength(cur, value, cch))
+            return false;
+    }
+
+    return true;
+}
+
+static bool IsArrayCompatible(PyObject* value, PyObject* prototype)
+{
+    // Returns true if `value` can be copied into a parameter array bound using `prototype`'s type.
+
+    if (value == Py_None || Py_TYPE(value) == Py_TYPE(prototype))
+        return true;
+
+#if PY_MAJOR_VERSION < 3
+    // ints and longs are both copied by SetFixedParamValue, but bools are bound as bits.
+    if ((PyInt_Check(value) || PyLong_Check(value)) && (PyInt_Check(prototype) || PyLong_Check(prototype)))
+        return !PyBool_Check(value) && !PyBool_Check(prototype);
+#endif
+
+    return false;
+}
+
+static SQLLEN ArrayElementSize(const ParamInfo& info)
+{
+    // The size of one element in a column-wise parameter array.  For fixed size C types the driver ignores
+    // BufferLength and steps by the size of the type.
+
+    switch (info.ValueType)
+    {
+    case SQL_C_CHAR:
+    case SQL_C_WCHAR:
+    case SQL_C_BINARY:
+        return info.BufferLength;
+    case SQL_C_BIT:
+        return sizeof(info.Data.ch);
+    case SQL_C_LONG:
+        return sizeof(SQLINTEGER);
+    case SQL_C_SBIGINT:
+        return sizeof(info.Data.i64);
+    case SQL_C_DOUBLE:
+        return sizeof(info.Data.dbl);
+    case SQL_C_NUMERIC:
+        return sizeof(SQL_NUMERIC_STRUCT);
+    case SQL_C_GUID:
+        return sizeof(SQLGUID);
+    case SQL_C_TIMESTAMP:
+        return sizeof(TIMESTAMP_STRUCT);
+    case SQL_C_TYPE_DATE:
+        return sizeof(DATE_STRUCT);
+    case SQL_C_TYPE_TIME:
+        return sizeof(TIME_STRUCT);
+    }
+
+    return 0;                   // SQL_C_DEFAULT for a column of NULLs
+}
+
+static bool PlanNumericArray(Cursor* cur, Py_ssize_t index, PyObject* rows, ParamInfo& info, bool& fArrayBound)
+{
+    // The descriptor holds one precision and scale for the whole array, so it is widened to the most integer digits
+    // and the most decimals in the column.  If that needs more than 38 digits the rows are executed one at a time.
+
+    int cIntegerMax = 0;
+    int cScaleMax   = 0;
+
+    Py_ssize_t cRows = PyList_GET_SIZE(rows);
+    for (Py_ssize_t iRow = 0; iRow < cRows; iRow++)
+    {
+        Object value(PySequence_GetItem(PyList_GET_ITEM(rows, iRow), index));
+        if (!value)
+            return false;
+        if (value.Get() == Py_None)
+            continue;
+
+        // Values with an input adapter function are measured after conversion, as FillParamArray will copy them.
+        Object adapted;
+        if (!PyDecimal_Check(value) && !PyLong_Check(value) && !AdaptValue(cur, value, adapted))
+            return false;
+
+        SQL_NUMERIC_STRUCT num;
+        bool fFits;
+        if (!GetNumericValue(adapted ? adapted.Get() : value.Get(), num, fFits))
+            return false;
+        if (!fFits)
+        {
+            fArrayBound = false;
+            return true;
+        }
+
+        cIntegerMax = max(cIntegerMax, (int)num.precision - (int)num.scale);
+        cScaleMax   = max(cScaleMax, (int)num.scale);
+    }
+
+    if (cIntegerMax + cScaleMax > cMaxNumericPrecision)
+    {
+        fArrayBound = false;
+        return true;
+    }
+
+    info.ColumnSize    = (SQLULEN)max(cIntegerMax + cScaleMax, 1);
+    info.DecimalDigits = (SQLSMALLINT)cScaleMax;
+    return true;
+}
+
+static bool PlanParamArray(Cursor* cur, Py_ssize_t index, PyObject* rows, ParamInfo& info, bool& fArrayBound)
+{
+    // Chooses the binding for column `index` of `rows` from its first non-NULL value and sizes it for the longest
+    // value in the column.  Clears fArrayBound if the column can't be array bound.
+    //
+    // For ints the binding is chosen from the widest instead, so a column starting with small values can hold the
+    // large ones too: a C long, a BIGINT, or a NUMERIC (PlanNumericArray) for ints beyond a BIGINT.
+
+    Py_ssize_t cRows    = PyList_GET_SIZE(rows);
+    Object     prototype;
+    Py_ssize_t cchMax   = 1;
+    Object     widest;
+    IntWidth   widthMax = INT_NONE;
+
+    for (Py_ssize_t iRow = 0; iRow < cRows; iRow++)
+    {
+        Object value(PySequence_GetItem(PyList_GET_ITEM(rows, iRow), index));
+        if (!value)
+            return false;
+
+        if (PyObject_TypeCheck(value.Get(), (PyTypeObject*)SQLParameter_type) || InList_Check(value.Get()))
+        {
+            fArrayBound = false;
+            return true;
+        }
+
+        if (value.Get() == Py_None)
+            continue;
+
+        if (prototype && !IsArrayCompatible(value, prototype))
+        {
+            fArrayBound = false;
+            return true;
+        }
+
+        Py_ssize_t cch;
+        if (!GetArrayValueLength(cur, value, cch))
+            return false;
+        if (cch < 0)
+        {
+            fArrayBound = false;
+            return true;
+        }
+        cchMax = max(cchMax, cch);
+
+        IntWidth width;
+        if (!GetIntWidth(value, width))
+            return false;
+        if (width > widthMax)
+        {
+            widthMax = width;
+            widest   = value.Get();
+            Py_INCREF(widest.Get());
+        }
+
+        if (!prototype)
+            prototype = value.Detach();
+    }
+
+    if (!prototype)
+    {
+        prototype = Py_None;
+        Py_INCREF(Py_None);
+    }
+
+    if (!GetParameterInfo(cur, index, widest ? widest.Get() : prototype.Get(), info))
+        return false;
+
+    if (widthMax == INT_LARGER && info.ValueType != SQL_C_NUMERIC)
+    {
+        fArrayBound = false;    // bound as a decimal string, which SetFixedParamValue can't copy ints into
+        return true;
+    }
+
+    switch (info.ValueType)
+    {
+    case SQL_C_CHAR:
+    case SQL_C_WCHAR:
+    case SQL_C_BINARY:
+        if (info.ParameterValuePtr != 0 && info.ParameterValuePtr == (SQLPOINTER)info.pParam)
+        {
+            fArrayBound = false;    // the prototype needs SQL_DATA_AT_EXEC
+            return true;
+        }
+        return MakeFixedParamInfo(cur, index, info, cchMax);
+
+    case SQL_C_NUMERIC:
+        return PlanNumericArray(cur, index, rows, info, fArrayBound);
+
+    case SQL_C_BIT:
+    case SQL_C_LONG:
+    case SQL_C_SBIGINT:
+    case SQL_C_DOUBLE:
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_DATE:
+    case SQL_C_TYPE_TIME:
+    case SQL_C_GUID:
+    case SQL_C_DEFAULT:
+        return true;
+    }
+
+    fArrayBound = false;
+    return true;
+}
+
+static bool IsMemoizedType(SQLSMALLINT ValueType)
+{
+    // The bindings worth memoizing.  Copying a slot isn't any faster than converting an int, a float, or bytes.
+
+    switch (ValueType)
+    {
+    case SQL_C_CHAR:
+    case SQL_C_WCHAR:
+    case SQL_C_NUMERIC:
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_DATE:
+    case SQL_C_TYPE_TIME:
+    case SQL_C_GUID:
+        return true;
+    }
+    return false;
+}
+
+static bool HasTimeZone(PyObject* value)
+{
+    // GetDateTimeInfo and GetTimeInfo ignore the tzinfo, so equal times in different zones are bound differently.
+    if (!PyDateTime_Check(value) && !PyTime_Check(value))
+        return false;
+    return ((_PyDateTime_BaseTZInfo*)value)->hastzinfo != 0;
+}
+
+static bool FillParamArray(Cursor* cur, Py_ssize_t index, PyObject* rows, ParamInfo& info, ParamMemo* memo)
+{
+    // Copies column `index` of every row into a newly allocated parameter array and indicator array, and points
+    // `info` at them.
+
+    Py_ssize_t cRows  = PyList_GET_SIZE(rows);
+    SQLLEN     cbElem = ArrayElementSize(info);
+
+    char*   pbValues     = 0;
+    SQLLEN* pIndicators  = (SQLLEN*)Arena_Alloc(cur->paramarena, sizeof(SQLLEN) * cRows);
+    if (pIndicators && cbElem)
+        pbValues = (char*)Arena_Alloc(cur->paramarena, (size_t)(cbElem * cRows));
+
+    if (!pIndicators || (cbElem && !pbValues))
+    {
+        if (pIndicators)
+            Arena_Rewind(cur->paramarena, pIndicators);
+        PyErr_NoMemory();
+        return false;
+    }
+
+    bool fVariable = (info.ValueType == SQL_C_CHAR || info.ValueType == SQL_C_WCHAR || info.ValueType == SQL_C_BINARY);
+
+    // Strings are memoized with their null terminator.
+    SQLLEN cbNull = (info.ValueType == SQL_C_WCHAR) ? sizeof(SQLWCHAR) : 1;
+
+    if (memo && !IsMemoizedType(info.ValueType))
+        memo = 0;
+
+    for (Py_ssize_t iRow = 0; iRow < cRows; iRow++)
+    {
+        Object value(PySequence_GetItem(PyList_GET_ITEM(rows, iRow), index));
+        if (!value)
+        {
+            Arena_Rewind(cur->paramarena, pIndicators);
+            return false;
+        }
+
+        char* pbSlot = pbValues + (cbElem * iRow);
+
+        Py_hash_t hash = -1;
+        if (memo && value.Get() != Py_None)
+        {
+            const ParamMemoEntry* entry;
+            if (!ParamMemo_Find(*memo, index, info.ValueType, info.DecimalDigits, value, HasTimeZone(value), cbElem, hash,
+                                entry))
+            {
+                Arena_Rewind(cur->paramarena, pIndicators);
+                return false;
+            }
+            if (entry)
+            {
+                memcpy(pbSlot, entry->pb, (size_t)entry->cb);
+                pIndicators[iRow] = entry->ind;
+                continue;
+            }
+        }
+
+        // Convert through a copy of the binding so variable length values are written straight into their slot and
+        // fixed size values land in the copy's Data.
+
+        ParamInfo cell = info;
+        if (fVariable)
+        {
+            cell.ParameterValuePtr = pbSlot;
+            cell.BufferLength      = cbElem;
+        }
+
+        if (!SetFixedParamValue(cur, index, value, cell))
+        {
+            Arena_Rewind(cur->paramarena, pIndicators);
+            return false;
+        }
+
+        if (!fVariable && cbElem)
+            memcpy(pbSlot, &cell.Data, (size_t)cbElem);
+
+        pIndicators[iRow] = cell.StrLen_or_Ind;
+
+        if (hash != -1)
+        {
+            SQLLEN cb = fVariable ? cell.StrLen_or_Ind + cbNull : cbElem;
+            if (!ParamMemo_Add(*memo, index, info.ValueType, info.DecimalDigits, value, hash, pbSlot, cb, cell.StrLen_or_Ind))
+            {
+                Arena_Rewind(cur->paramarena, pIndicators);
+                return false;
+            }
+        }
+    }
+
+    info.ParameterValuePtr  = pbValues;
+    info.allocated          = (pbValues != 0);
+    info.StrLen_or_IndArray = pIndicators;
+    if (fVariable)
+        info.BufferLength = cbElem;
+
+    return true;
+}
+
+bool BindParamArrays(Cursor* cur, PyObject* pSql, PyObject* rows, bool& fArrayBound, ParamMemo* memo)
+{
+    // Prepares `pSql` and binds the list of parameter sequences `rows` column-wise, one array per parameter, so the
+    // whole batch can be sent by a single SQLExecute with SQL_ATTR_PARAMSET_SIZE set to the number of rows.  The
+    // caller sets the statement attributes.
+    //
+    // If the rows can't be array bound -- mixed types in a column, a value that needs SQL_DATA_AT_EXEC, a
+    // SQLParameter or InList, or rows of the wrong length -- nothing is bound and fArrayBound is set to false so the caller can
+    // execute them one at a time, which also reports any errors in the usual way.
+    //
+    // If `memo` is not zero, values it has already seen are copied from it instead of being converted again.
+
+    fArrayBound = false;
+
+    FreeParameterData(cur);
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    Py_ssize_t cRows = PyList_GET_SIZE(rows);
+    if (cur->paramcount == 0 || cRows == 0)
+        return true;
+
+    for (Py_ssize_t iRow = 0; iRow < cRows; iRow++)
+    {
+        PyObject* row = PyList_GET_ITEM(rows, iRow);
+        if (!PySequence_Check(row) || PyString_Check(row) || PyUnicode_Check(row) || PySequence_Size(row) != cur->paramcount)
+        {
+            PyErr_Clear();
+            return true;
+        }
+    }
+
+    cur->paramInfos = AllocParamInfos(cur, cur->paramcount);
+    if (cur->paramInfos == 0)
+        return false;
+
+    fArrayBound = true;
+
+    // As in BindParams, every column is planned (which may call SQLDescribeParam) before anything is bound.
+
+    for (int i = 0; i < cur->paramcount && fArrayBound; i++)
+    {
+        if (!PlanParamArray(cur, i, rows, cur->paramInfos[i], fArrayBound) ||
+            (fArrayBound && !FillParamArray(cur, i, rows, cur->paramInfos[i], memo)))
+        {
+            fArrayBound = false;
+            FreeInfos(cur->paramInfos, cur->paramcount);
+            cur->paramInfos = 0;
+            return false;
+        }
+    }
+
+    if (!fArrayBound)
+    {
+        FreeInfos(cur->paramInfos, cur->paramcount);
+        cur->paramInfos = 0;
+        return true;
+    }
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        if (!BindParameter(cur, i, cur->paramInfos[i]))
+        {
+            fArrayBound = false;
+            FreeParameterData(cur);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#if PY_VERSION_HEX >= 0x02060000
+static Py_buffer* GetColumnView(Cursor* cur, PyObject* obj, int flags)
+{
+    // Returns a view of `obj` allocated from the paramarena, or zero with an exception set.
+
+    Py_buffer* view = (Py_buffer*)Arena_Alloc(cur->paramarena, sizeof(Py_buffer));
+    if (view == 0)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+
+    if (PyObject_GetBuffer(obj, view, flags) != 0)
+        return 0;               // the arena is reset by the caller
+
+    return view;
+}
+
+static bool SetColumnType(Py_ssize_t index, const Py_buffer* view, ParamInfo& info)
+{
+    // Chooses the binding for a column from its buffer's struct module format, which must be a single native value
+    // per element.  Integers are chosen by itemsize since the size of 'l' varies.
+
+    const char* fmt = view->format ? view->format : "B";
+
+    const int one = 1;
+    bool fLittle = *(const char*)&one == 1;
+
+    if (*fmt == '@' || *fmt == '=' || (*fmt == '<' && fLittle) || ((*fmt == '>' || *fmt == '!') && !fLittle))
+        fmt++;
+
+    // A repeat count is the length of a string ("10s").  For anything else it is the number of values in each element,
+    // which must be one.
+    long count = 1;
+    if (*fmt >= '0' && *fmt <= '9')
+    {
+        char* end;
+        count = strtol(fmt, &end, 10);
+        fmt = end;
+    }
+
+    Py_ssize_t cb = view->itemsize;
+
+    info.ValueType     = 0;
+    info.BufferLength  = (SQLLEN)cb;
+    info.DecimalDigits = 0;
+
+    if (fmt[0] != 0 && fmt[1] == 0 && (count == 1 || fmt[0] == 's'))
+    {
+        switch (fmt[0])
+        {
+        case '?':
+            if (cb == 1)
+            {
+                info.ValueType     = SQL_C_BIT;
+                info.ParameterType = SQL_BIT;
+                info.ColumnSize    = 1;
+            }
+            break;
+
+        case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+        case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+        {
+            // Unsigned values are given the next larger SQL type so they always fit.  There is no integer type larger
+            // than BIGINT, so 64-bit unsigned values are sent as a NUMERIC(20).
+            bool fSigned = (fmt[0] >= 'a');
+            switch (cb)
+            {
+            case 1:
+                info.ValueType     = fSigned ? SQL_C_STINYINT : SQL_C_UTINYINT;
+                info.ParameterType = fSigned ? SQL_SMALLINT : SQL_TINYINT;
+                info.ColumnSize    = 3;
+                break;
+            case 2:
+                info.ValueType     = fSigned ? SQL_C_SSHORT : SQL_C_USHORT;
+                info.ParameterType = fSigned ? SQL_SMALLINT : SQL_INTEGER;
+                info.ColumnSize    = fSigned ? 5 : 10;
+                break;
+            case 4:
+                info.ValueType     = fSigned ? SQL_C_SLONG : SQL_C_ULONG;
+                info.ParameterType = fSigned ? SQL_INTEGER : SQL_BIGINT;
+                info.ColumnSize    = fSigned ? 10 : 19;
+                break;
+            case 8:
+                info.ValueType     = fSigned ? SQL_C_SBIGINT : SQL_C_UBIGINT;
+                info.ParameterType = fSigned ? SQL_BIGINT : SQL_NUMERIC;
+                info.ColumnSize    = fSigned ? 19 : 20;
+                break;
+            }
+            break;
+        }
+
+        case 'f':
+            if (cb == 4)
+            {
+                info.ValueType     = SQL_C_FLOAT;
+                info.ParameterType = SQL_REAL;
+                info.ColumnSize    = 7;
+            }
+            break;
+
+        case 'd':
+            if (cb == 8)
+            {
+                info.ValueType     = SQL_C_DOUBLE;
+                info.ParameterType = SQL_DOUBLE;
+                info.ColumnSize    = 15;
+            }
+            break;
+
+        case 's':
+            // Fixed width byte strings, such as numpy's 'S' dtype, padded with NULs.
+            if (cb >= 1)
+            {
+                info.ValueType     = SQL_C_CHAR;
+                info.ParameterType = SQL_VARCHAR;
+                info.ColumnSize    = (SQLULEN)cb;
+            }
+            break;
+        }
+    }
+
+    if (info.ValueType == 0)
+    {
+        RaiseErrorV(0, PyExc_TypeError, "executemany_columns column %zd has an unsupported format '%s' (itemsize %zd)",
+                    index, view->format ? view->format : "B", cb);
+        return false;
+    }
+
+    return true;
+}
+
+bool BindParamColumns(Cursor* cur, PyObject* pSql, PyObject* columns, Py_ssize_t cChunkRows, Py_ssize_t& cRows)
+{
+    // Prepares `pSql` and sets up one parameter array per column for executemany_columns.  Each column is an object
+    // exporting a contiguous one-dimensional buffer, or a (values, null_mask) pair where the mask has a byte per row.
+    // The columns' memory is bound directly; only the indicator arrays, cChunkRows long, are allocated.  The views
+    // are held by the ParamInfos until FreeParameterData.
+    //
+    // BindParamColumnRows then binds each chunk of rows before it is executed.  cRows is set to the number of rows.
+
+    cRows = 0;
+
+    FreeParameterData(cur);
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    Py_ssize_t cColumns = PySequence_Size(columns);
+    if (cColumns == -1)
+        return false;
+
+    if (cColumns != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but %zd columns were supplied",
+                    cur->paramcount, cColumns);
+        return false;
+    }
+
+    if (cColumns == 0)
+        return true;
+
+    cur->paramInfos = AllocParamInfos(cur, cColumns);
+    if (cur->paramInfos == 0)
+        return false;
+
+    for (Py_ssize_t i = 0; i < cColumns; i++)
+    {
+        ParamInfo& info = cur->paramInfos[i];
+        info.InputOutputType = SQL_PARAM_INPUT;
+
+        Object column(PySequence_GetItem(columns, i));
+        if (!column)
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+
+        PyObject* values = column.Get();
+        PyObject* mask   = 0;
+        if (PyTuple_Check(values))
+        {
+            if (PyTuple_GET_SIZE(values) != 2)
+            {
+                RaiseErrorV(0, PyExc_TypeError, "executemany_columns column %zd must be a buffer or a (values, null_mask) tuple", i);
+                FreeParameterData(cur);
+                return false;
+            }
+            mask   = PyTuple_GET_ITEM(values, 1);
+            values = PyTuple_GET_ITEM(values, 0);
+            if (mask == Py_None)
+                mask = 0;
+        }
+
+        info.pParam = values;
+        Py_INCREF(values);
+
+        // PyBUF_ND asks for a C contiguous buffer, which a one dimensional one is.
+        info.pView = GetColumnView(cur, values, PyBUF_FORMAT | PyBUF_ND);
+        if (!info.pView)
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+
+        if (info.pView->ndim != 1 || info.pView->itemsize < 1)
+        {
+            RaiseErrorV(0, PyExc_TypeError, "executemany_columns column %zd must be one dimensional", i);
+            FreeParameterData(cur);
+            return false;
+        }
+
+        if (!SetColumnType(i, info.pView, info))
+        {
+            FreeParameterData(cur);
+            return false;
+        }
+
+        Py_ssize_t cColumnRows = info.pView->len / info.pView->itemsize;
+        if (i == 0)
+            cRows = cColumnRows;
+
+        if (cColumnRows != cRows)
+        {
+            RaiseErrorV(0, ProgrammingError, "executemany_columns column %zd has %zd rows, but column 0 has %zd", i, cColumnRows, cRows);
+            FreeParameterData(cur);
+            return false;
+        }
+
+        if (mask)
+        {
+            info.pNullMask = GetColumnView(cur, mask, PyBUF_SIMPLE);
+            if (!info.pNullMask)
+            {
+                FreeParameterData(cur);
+                return false;
+            }
+            if (info.pNullMask->len != cRows)
+            {
+                RaiseErrorV(0, ProgrammingError, "The null mask of executemany_columns column %zd has %zd bytes for %zd rows",
+                            i, info.pNullMask->len, cRows);
+                FreeParameterData(cur);
+                return false;
+            }
+        }
+
+        info.StrLen_or_IndArray = (SQLLEN*)Arena_Alloc(cur->paramarena, sizeof(SQLLEN) * (size_t)max(min(cRows, cChunkRows), (Py_ssize_t)1));
+        if (!info.StrLen_or_IndArray)
+        {
+            PyErr_NoMemory();
+            FreeParameterData(cur);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BindParamColumnRows(Cursor* cur, Py_ssize_t iFirstRow, Py_ssize_t cRows)
+{
+    // Points the parameter arrays set up by BindParamColumns at rows [iFirstRow, iFirstRow + cRows) and binds them.
+    // Only the indicators are written; the values are read by the driver from the columns' own memory.
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        ParamInfo&    info  = cur->paramInfos[i];
+        Py_ssize_t    cb    = info.pView->itemsize;
+        const char*   pb    = (const char*)info.pView->buf + (iFirstRow * cb);
+        const char*   pMask = info.pNullMask ? (const char*)info.pNullMask->buf + iFirstRow : 0;
+        SQLLEN*       pInd  = info.StrLen_or_IndArray;
+
+        for (Py_ssize_t iRow = 0; iRow < cRows; iRow++)
+        {
+            if (pMask && pMask[iRow])
+            {
+                pInd[iRow] = SQL_NULL_DATA;
+            }
+            else if (info.ValueType == SQL_C_CHAR)
+            {
+                // The text ends at the first NUL, if it doesn't fill the element.
+                const char* pch = pb + (iRow * cb);
+                const char* pNul = (const char*)memchr(pch, 0, (size_t)cb);
+                pInd[iRow] = pNul ? (SQLLEN)(pNul - pch) : (SQLLEN)cb;
+            }
+            else
+            {
+                pInd[iRow] = (SQLLEN)cb;
             }
-            Py_END_ALLOW_THREADS
         }
+
+        info.ParameterValuePtr = (SQLPOINTER)pb;
+
+        if (!BindParameter(cur, i, info))
+            return false;
+    }
+
+    return true;
+}
 #endif
 
-        if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+#if PY_VERSION_HEX >= 0x02070000
+bool BindParamArrowColumns(Cursor* cur, PyObject* pSql, const ArrowSchema* schema, Py_ssize_t cChunkRows)
+{
+    // Prepares `pSql` and sets up a parameter array for each field of an Arrow stream's struct schema, like
+    // BindParamColumns.  Nothing is bound until BindParamArrowRows is given a batch.
+
+    FreeParameterData(cur);
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    if (schema->format == 0 || strcmp(schema->format, "+s") != 0)
+    {
+        RaiseErrorV(0, ProgrammingError, "executemany_arrow requires a stream of record batches (struct arrays), not '%s'",
+                    schema->format ? schema->format : "");
+        return false;
+    }
+
+    if (schema->n_children != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but the Arrow stream has %d columns",
+                    cur->paramcount, (int)schema->n_children);
+        return false;
+    }
+
+    if (cur->paramcount == 0)
+        return true;
+
+    cur->paramInfos = AllocParamInfos(cur, cur->paramcount);
+    if (cur->paramInfos == 0)
+        return false;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        ParamInfo& info = cur->paramInfos[i];
+
+        info.StrLen_or_IndArray = (SQLLEN*)Arena_Alloc(cur->paramarena, sizeof(SQLLEN) * (size_t)max(cChunkRows, (Py_ssize_t)1));
+        if (!info.StrLen_or_IndArray)
         {
-            // The connection was closed by another thread in the ALLOW_THREADS block above.
-            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+            PyErr_NoMemory();
+            FreeParameterData(cur);
             return false;
         }
 
-        if (!SQL_SUCCEEDED(ret))
+        if (!Arrow_SetColumnType(cur->cnxn, i, schema->children[i], info))
         {
-            RaiseErrorFromHandle(szErrorFunc, GetConnection(cur)->hdbc, cur->hstmt);
+            FreeParameterData(cur);
             return false;
         }
+    }
 
-        cur->paramcount = (int)cParamsT;
+    return true;
+}
 
-        cur->pPreparedSQL = pSql;
-        Py_INCREF(cur->pPreparedSQL);
+bool BindParamArrowRows(Cursor* cur, const ArrowSchema* schema, const ArrowArray* batch, Py_ssize_t iFirstRow, Py_ssize_t& cRows, void*& pChunk)
+{
+    // Binds rows [iFirstRow, iFirstRow + cRows) of an Arrow record batch.  cRows is reduced if long strings would make
+    // the converted buffers too large (see Arrow_ChunkRows), so the caller must use it to find the next row.  pChunk is
+    // set to a marker allocated before any buffers the rows were converted into; the caller passes it to Arena_Rewind
+    // after executing them.
+
+    pChunk = Arena_Alloc(cur->paramarena, 1);
+    if (!pChunk)
+    {
+        PyErr_NoMemory();
+        return false;
     }
 
-    if (cParams != cur->paramcount)
+    if (batch->n_children != cur->paramcount)
     {
-        RaiseErrorV(0, ProgrammingError, "The SQL contains %d parameter markers, but %d parameters were supplied",
-                    cur->paramcount, cParams);
+        RaiseErrorV(0, ProgrammingError, "An Arrow batch has %d columns, but the stream's schema has %d",
+                    (int)batch->n_children, cur->paramcount);
         return false;
     }
 
-    return BindParams(cur, original_params, skip_first);
+    if (batch->null_count != 0 && batch->n_buffers > 0 && batch->buffers[0] != 0)
+    {
+        RaiseErrorV(0, NotSupportedError, "executemany_arrow does not support null rows in a record batch");
+        return false;
+    }
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        const ArrowArray* column = batch->children[i];
+        if (column->length < batch->offset + batch->length)
+        {
+            RaiseErrorV(0, ProgrammingError, "Arrow column %d is shorter than its record batch", i);
+            return false;
+        }
+    }
+
+    cRows = Arrow_ChunkRows(cur, schema, batch, iFirstRow, cRows);
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        const ArrowArray* column = batch->children[i];
+        INT64 iRow = column->offset + batch->offset + iFirstRow;
+        if (!Arrow_FillColumn(cur, i, schema->children[i], column, iRow, cRows, cur->paramInfos[i]) ||
+            !BindParameter(cur, i, cur->paramInfos[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
+#endif
 
 static bool GetParamType(Cursor* cur, Py_ssize_t index, SQLSMALLINT& type)
 {
@@ -1022,20 +3591,42 @@ static bool GetParamType(Cursor* cur, Py_ssize_t index, SQLSMALLINT& type)
 
     if (cur->paramtypes[index] == SQL_UNKNOWN_TYPE)
     {
-        SQLULEN ParameterSizePtr;
-        SQLSMALLINT DecimalDigitsPtr;
-        SQLSMALLINT NullablePtr;
-        SQLRETURN ret;
+        // Describe all of the parameters at once.  Drivers like SQL Server's describe the entire statement in one
+        // round trip on the first call anyway, and the complete set of types can then be kept by the connection for
+        // other cursors that prepare the same SQL.
+
+        SQLSMALLINT* paramtypes = cur->paramtypes;
+        SQLUSMALLINT cParams = (SQLUSMALLINT)cur->paramcount;
+        HSTMT hstmt = cur->hstmt;
 
         Py_BEGIN_ALLOW_THREADS
-        ret = SQLDescribeParam(cur->hstmt, (SQLUSMALLINT)(index + 1), &cur->paramtypes[index], &ParameterSizePtr, &DecimalDigitsPtr, &NullablePtr);
+        for (SQLUSMALLINT i = 0; i < cParams; i++)
+        {
+            if (paramtypes[i] != SQL_UNKNOWN_TYPE)
+                continue;
+
+            SQLULEN ParameterSizePtr;
+            SQLSMALLINT DecimalDigitsPtr;
+            SQLSMALLINT NullablePtr;
+
+            SQLRETURN ret = SQLDescribeParam(hstmt, (SQLUSMALLINT)(i + 1), &paramtypes[i], &ParameterSizePtr, &DecimalDigitsPtr, &NullablePtr);
+            if (!SQL_SUCCEEDED(ret))
+            {
+                // This can happen with ("select ?", None).  We'll default to VARCHAR which works with most types.
+                paramtypes[i] = SQL_VARCHAR;
+            }
+        }
         Py_END_ALLOW_THREADS
 
-        if (!SQL_SUCCEEDED(ret))
+        if (GetConnection(cur)->hdbc == SQL_NULL_HANDLE)
         {
-            // This can happen with ("select ?", None).  We'll default to VARCHAR which works with most types.
-            cur->paramtypes[index] = SQL_VARCHAR;
+            // The connection was closed by another thread in the ALLOW_THREADS block above.
+            RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+            return false;
         }
+
+        if (!SaveParamTypes(cur))
+            return false;
     }
 
     type = cur->paramtypes[index];
@@ -1107,7 +3698,7 @@ static PyObject* SQLParameter_new(PyTypeObject* type, PyObject* args, PyObject*
         Py_INCREF(Py_None);
         self->value = Py_None;
         self->type = SQL_PARAM_INPUT; // iODBC's default is INPUT_OUTPUT.
-        self->ostr_len = 2048;
+        self->ostr_len = cchDefaultOutputString;
     }
 
     return (PyObject*)self;
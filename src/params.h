@@ -7,10 +7,23 @@ bool Params_init();
 extern PyObject* SQLParameter_type;
 
 struct Cursor;
+struct ParamMemo;
 
 bool BindParams(Cursor* cur, PyObject* params, bool skip_first);
+bool Prepare(Cursor* cur, PyObject* pSql);
 bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first);
+bool PrepareAndBindFixed(Cursor* cur, PyObject* pSql, PyObject* signature);
+bool SetFixedParams(Cursor* cur, PyObject* params);
+bool BindParamArrays(Cursor* cur, PyObject* pSql, PyObject* rows, bool& fArrayBound, ParamMemo* memo);
+bool BindParamColumns(Cursor* cur, PyObject* pSql, PyObject* columns, Py_ssize_t cChunkRows, Py_ssize_t& cRows);
+bool BindParamColumnRows(Cursor* cur, Py_ssize_t iFirstRow, Py_ssize_t cRows);
+
+struct ArrowSchema;
+struct ArrowArray;
+bool BindParamArrowColumns(Cursor* cur, PyObject* pSql, const ArrowSchema* schema, Py_ssize_t cChunkRows);
+bool BindParamArrowRows(Cursor* cur, const ArrowSchema* schema, const ArrowArray* batch, Py_ssize_t iFirstRow, Py_ssize_t& cRows, void*& pChunk);
 void FreeParameterData(Cursor* cur);
 void FreeParameterInfo(Cursor* cur);
+void ReleaseParameterViews(Cursor* cur);
 
 #endif
@@ -0,0 +1,524 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A pool of open connections.  The driver manager's pooling (the module's `pooling` flag) can't be sized, measured, or
+// told how to reset a connection, so Pool keeps Connection objects itself.
+//
+// The free list is only changed while holding the GIL, which makes it a simple stack.  A thread that finds the pool
+// empty and at its maximum size waits on the pool's signal lock with the GIL released, and is woken when another
+// thread returns or discards a connection.  Returned connections are rolled back and have their settings (autocommit,
+// timeout, statement cache size, etc.) and converters restored so the next user sees a new connection.
+
+#include "pyodbc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "pool.h"
+#include "errors.h"
+#include "wrapper.h"
+
+// The default maximum number of connections.
+#define DEFAULT_POOL_SIZE 10
+
+static bool ParseTimeout(PyObject* value, double& timeout)
+{
+    // Reads a timeout in seconds, where None means forever (-1).
+
+    if (value == 0 || value == Py_None)
+    {
+        timeout = -1;
+        return true;
+    }
+
+    timeout = PyFloat_AsDouble(value);
+    if (timeout == -1 && PyErr_Occurred())
+        return false;
+
+    if (timeout < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "The pool timeout cannot be negative.");
+        return false;
+    }
+
+#if PY_VERSION_HEX < 0x03020000
+    // Only Python 3.2 added timed waits on a lock.
+    RaiseErrorV(0, NotSupportedError, "A pool timeout requires Python 3.2 or later.");
+    return false;
+#else
+    return true;
+#endif
+}
+
+static void Signal(Pool* pool)
+{
+    // Wakes a waiting thread, which checks the pool again.  It passes the signal on if there is more for the others.
+
+    if (pool->waiting > 0 && !pool->fSignaled)
+    {
+        pool->fSignaled = true;
+        PyThread_release_lock(pool->signal);
+    }
+}
+
+static Connection* NewConnection(Pool* pool)
+{
+    // Opens a new connection, which the caller has already counted in pool->size.
+
+    PyObject* cnxn = mod_connect(0, pool->args, pool->kwargs);
+    if (!cnxn)
+        return 0;
+
+    pool->created++;
+    Connection_GetSettings((Connection*)cnxn, pool->settings);
+
+    return (Connection*)cnxn;
+}
+
+static void CloseConnection(Pool* pool, Connection* cnxn)
+{
+    // Closes a connection that belongs to the pool but is not checked out, and steals the reference to it.
+
+    pool->size--;
+    pool->discarded++;
+
+    Object result(PyObject_CallMethod((PyObject*)cnxn, "close", 0));
+    if (!result)
+        PyErr_Clear();
+
+    Py_DECREF(cnxn);
+
+    Signal(pool);
+}
+
+static void CloseIdle(Pool* pool)
+{
+    while (pool->idle_count > 0)
+        CloseConnection(pool, pool->idle[--pool->idle_count]);
+}
+
+void Pool_Discard(PyObject* self)
+{
+    Pool* pool = (Pool*)self;
+    pool->size--;
+    pool->discarded++;
+    Signal(pool);
+}
+
+static PyObject* Pool_new(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    // Pool(connstr, min=0, max=10, acquire_timeout=None, **kwargs).  The connection string and the keywords the pool
+    // doesn't use are passed to connect.
+
+    PyObject* connstr;
+    int minsize = 0;
+    int maxsize = DEFAULT_POOL_SIZE;
+
+    Object connectKwargs(kwargs ? PyDict_Copy(kwargs) : PyDict_New());
+    if (!connectKwargs)
+        return 0;
+
+    PyObject* value = PyDict_GetItemString(connectKwargs, "min");
+    if (value)
+    {
+        minsize = (int)PyInt_AsLong(value);
+        if (minsize == -1 && PyErr_Occurred())
+            return 0;
+        PyDict_DelItemString(connectKwargs, "min");
+    }
+
+    value = PyDict_GetItemString(connectKwargs, "max");
+    if (value)
+    {
+        maxsize = (int)PyInt_AsLong(value);
+        if (maxsize == -1 && PyErr_Occurred())
+            return 0;
+        PyDict_DelItemString(connectKwargs, "max");
+    }
+
+    // (The connect keyword `timeout` is the login timeout, so the pool's is named differently.)
+    value = PyDict_GetItemString(connectKwargs, "acquire_timeout");
+    double timeout;
+    if (!ParseTimeout(value, timeout))
+        return 0;
+    if (value)
+        PyDict_DelItemString(connectKwargs, "acquire_timeout");
+
+    if (!PyArg_ParseTuple(args, "O|ii", &connstr, &minsize, &maxsize))
+        return 0;
+
+    if (maxsize < 1 || minsize < 0 || minsize > maxsize)
+    {
+        PyErr_SetString(PyExc_ValueError, "The pool sizes must satisfy 0 <= min <= max and max >= 1.");
+        return 0;
+    }
+
+    Pool* pool = (Pool*)type->tp_alloc(type, 0);
+    if (!pool)
+        return 0;
+
+    Object result((PyObject*)pool);
+
+    pool->args       = Py_BuildValue("(O)", connstr);
+    pool->kwargs     = connectKwargs.Detach();
+    pool->minsize    = minsize;
+    pool->maxsize    = maxsize;
+    pool->timeout    = timeout;
+    pool->idle       = 0;
+    pool->idle_count = 0;
+    pool->size       = 0;
+    pool->signal     = 0;
+    pool->fSignaled  = false;
+    pool->waiting    = 0;
+    pool->closed     = false;
+    pool->checkouts  = 0;
+    pool->waits      = 0;
+    pool->timeouts   = 0;
+    pool->created    = 0;
+    pool->discarded  = 0;
+    pool->wait_time  = 0;
+
+    if (!pool->args)
+        return 0;
+
+    pool->idle = (Connection**)pyodbc_malloc(sizeof(Connection*) * maxsize);
+    if (!pool->idle)
+        return PyErr_NoMemory();
+
+    pool->signal = PyThread_allocate_lock();
+    if (!pool->signal)
+        return RaiseErrorV(0, PyExc_MemoryError, "Unable to allocate the pool's lock.");
+    PyThread_acquire_lock(pool->signal, NOWAIT_LOCK);
+
+    // Open the minimum number of connections now so the first users don't wait for them.
+
+    while (pool->size < minsize)
+    {
+        pool->size++;
+        Connection* cnxn = NewConnection(pool);
+        if (!cnxn)
+        {
+            pool->size--;
+            return 0;
+        }
+        pool->idle[pool->idle_count++] = cnxn;
+    }
+
+    return result.Detach();
+}
+
+static void Pool_dealloc(PyObject* self)
+{
+    Pool* pool = (Pool*)self;
+
+    // Connections that are checked out hold a reference to the pool, so only idle ones are left.
+
+    if (pool->idle)
+    {
+        CloseIdle(pool);
+        pyodbc_free(pool->idle);
+    }
+
+    if (pool->signal)
+    {
+        if (!pool->fSignaled)
+            PyThread_release_lock(pool->signal);
+        PyThread_free_lock(pool->signal);
+    }
+
+    Py_XDECREF(pool->args);
+    Py_XDECREF(pool->kwargs);
+
+    Py_TYPE(self)->tp_free(self);
+}
+
+static char acquire_doc[] =
+    "acquire(timeout=None) --> Connection\n"
+    "\n"
+    "Check out a connection.  If none are idle and the pool has `max` connections\n"
+    "open, wait until one is released.  The timeout is in seconds and defaults to\n"
+    "the pool's; OperationalError is raised if it expires.";
+
+static PyObject* Pool_acquire(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Pool* pool = (Pool*)self;
+
+    PyObject* pTimeout = 0;
+    static char* kwlist[] = { "timeout", 0 };
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &pTimeout))
+        return 0;
+
+    double timeout = pool->timeout;
+    if (pTimeout && !ParseTimeout(pTimeout, timeout))
+        return 0;
+
+    Connection* cnxn = 0;
+    double start = 0;
+
+    for (;;)
+    {
+        if (pool->closed)
+            return RaiseErrorV(0, ProgrammingError, "The pool is closed.");
+
+        if (pool->idle_count > 0)
+        {
+            // Replace connections the driver knows are dead, usually without a round trip.  (This releases the
+            // GIL, but the connection is already off the stack and still counted in size.)
+            cnxn = pool->idle[--pool->idle_count];
+            if (!Connection_IsAlive(cnxn, true))
+            {
+                CloseConnection(pool, cnxn);
+                continue;
+            }
+            break;
+        }
+
+        if (pool->size < pool->maxsize)
+        {
+            pool->size++;
+            cnxn = NewConnection(pool);
+            if (!cnxn)
+            {
+                pool->size--;
+                Signal(pool);
+                return 0;
+            }
+            break;
+        }
+
+        // Wait for a connection to be returned.  While waiting, the count in `waiting` tells threads returning
+        // connections to signal.
+
+        double now = MonotonicSeconds();
+        if (start == 0)
+        {
+            start = now;
+            pool->waits++;
+        }
+
+        int acquired;
+        pool->waiting++;
+        Py_BEGIN_ALLOW_THREADS
+#if PY_VERSION_HEX >= 0x03020000
+        if (timeout < 0)
+            acquired = PyThread_acquire_lock(pool->signal, WAIT_LOCK);
+        else
+        {
+            // The wait is in microseconds, which overflows PY_TIMEOUT_T for very long timeouts.
+            double remaining = (start + timeout - now) * 1e6;
+            PY_TIMEOUT_T microseconds;
+            if (remaining <= 0)
+                microseconds = 0;
+            else if (remaining >= (double)PY_TIMEOUT_MAX)
+                microseconds = PY_TIMEOUT_MAX;
+            else
+                microseconds = (PY_TIMEOUT_T)remaining;
+            acquired = PyThread_acquire_lock_timed(pool->signal, microseconds, 0) == PY_LOCK_ACQUIRED;
+        }
+#else
+        acquired = PyThread_acquire_lock(pool->signal, WAIT_LOCK);
+#endif
+        Py_END_ALLOW_THREADS
+        pool->waiting--;
+
+        if (acquired)
+        {
+            pool->fSignaled = false;
+        }
+        else
+        {
+            pool->timeouts++;
+            pool->wait_time += MonotonicSeconds() - start;
+            return RaiseErrorV(0, OperationalError, "Timed out waiting for a connection from the pool.");
+        }
+    }
+
+    if (start != 0)
+        pool->wait_time += MonotonicSeconds() - start;
+
+    // If there is more to hand out, wake the next waiting thread.
+    if (pool->idle_count > 0 || pool->size < pool->maxsize)
+        Signal(pool);
+
+    pool->checkouts++;
+
+    // The reference the pool held (or the new one) is returned to the caller.  The connection holds a reference to the
+    // pool until it is released, closed, or deleted.
+
+    Py_INCREF(self);
+    cnxn->pool = self;
+
+    return (PyObject*)cnxn;
+}
+
+static char release_doc[] =
+    "release(connection) --> None\n"
+    "\n"
+    "Return a connection checked out with acquire.  It is rolled back, its\n"
+    "attributes such as autocommit, timeout, and statement_cache_size are set\n"
+    "back to their values when it was opened, and its converters are removed,\n"
+    "so it must not be used afterwards.  Closing a checked out connection\n"
+    "instead is allowed; the pool will open another when needed.";
+
+static PyObject* Pool_release(PyObject* self, PyObject* args)
+{
+    Pool* pool = (Pool*)self;
+
+    PyObject* obj;
+    if (!PyArg_ParseTuple(args, "O!", &ConnectionType, &obj))
+        return 0;
+
+    Connection* cnxn = (Connection*)obj;
+
+    // A connection closed while checked out was already discarded.
+    if (cnxn->pool == 0 && cnxn->hdbc == SQL_NULL_HANDLE)
+        Py_RETURN_NONE;
+
+    if (cnxn->pool != self)
+        return RaiseErrorV(0, ProgrammingError, "The connection was not acquired from this pool.");
+
+    // Take back the connection's reference to the pool (in `keep`) and give the pool a reference to the connection.
+
+    Object keep(cnxn->pool);
+    cnxn->pool = 0;
+    Py_INCREF(cnxn);
+
+    if (pool->closed || !Connection_Reset(cnxn, pool->settings))
+    {
+        // A connection that can't be rolled back is probably broken, so it is replaced rather than returned.
+        PyErr_Clear();
+        CloseConnection(pool, cnxn);
+        Py_RETURN_NONE;
+    }
+
+    I(pool->idle_count < pool->maxsize);
+    pool->idle[pool->idle_count++] = cnxn;
+
+    Signal(pool);
+
+    Py_RETURN_NONE;
+}
+
+static char close_doc[] =
+    "close() --> None\n"
+    "\n"
+    "Close the idle connections.  Connections that are checked out are closed when\n"
+    "they are released, and acquire raises ProgrammingError from now on.";
+
+static PyObject* Pool_close(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Pool* pool = (Pool*)self;
+
+    pool->closed = true;
+    CloseIdle(pool);
+
+    // Wake any waiting threads so they raise.
+    Signal(pool);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* Pool_getidle(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyInt_FromLong(((Pool*)self)->idle_count);
+}
+
+static PyMethodDef Pool_methods[] =
+{
+    { "acquire", (PyCFunction)Pool_acquire, METH_VARARGS|METH_KEYWORDS, acquire_doc },
+    { "release", Pool_release,              METH_VARARGS,               release_doc },
+    { "close",   Pool_close,                METH_NOARGS,                close_doc   },
+    { 0, 0, 0, 0 }
+};
+
+static PyGetSetDef Pool_getseters[] = {
+    { "idle", Pool_getidle, 0, "The number of open connections that are not checked out.", 0 },
+    { 0 }
+};
+
+static PyMemberDef Pool_members[] =
+{
+    { "min",       T_INT,    offsetof(Pool, minsize),   READONLY, "The number of connections opened when the pool is created." },
+    { "max",       T_INT,    offsetof(Pool, maxsize),   READONLY, "The maximum number of open connections." },
+    { "size",      T_INT,    offsetof(Pool, size),      READONLY, "The number of open connections, idle and checked out." },
+    { "checkouts", T_LONG,   offsetof(Pool, checkouts), READONLY, "The number of connections handed out by acquire." },
+    { "waits",     T_LONG,   offsetof(Pool, waits),     READONLY, "The number of acquires that had to wait." },
+    { "timeouts",  T_LONG,   offsetof(Pool, timeouts),  READONLY, "The number of acquires that timed out." },
+    { "wait_time", T_DOUBLE, offsetof(Pool, wait_time), READONLY, "The total seconds acquire has spent waiting." },
+    { "created",   T_LONG,   offsetof(Pool, created),   READONLY, "The number of connections opened." },
+    { "discarded", T_LONG,   offsetof(Pool, discarded), READONLY, "The number of connections closed or replaced." },
+    { 0 }
+};
+
+static char pool_doc[] =
+    "Pool(connstr, min=0, max=10, acquire_timeout=None, **kwargs)\n"
+    "\n"
+    "A pool of open connections.  The connection string and any other keywords are\n"
+    "passed to connect.  `min` connections are opened immediately and up to `max`\n"
+    "are opened as needed.  `acquire_timeout` is the default number of seconds\n"
+    "acquire waits when all `max` are checked out; None waits forever.\n"
+    "\n"
+    "  cnxn = pool.acquire()\n"
+    "  try:\n"
+    "      cnxn.execute(...)\n"
+    "      cnxn.commit()\n"
+    "  finally:\n"
+    "      pool.release(cnxn)";
+
+PyTypeObject PoolType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.Pool",              // tp_name
+    sizeof(Pool),               // tp_basicsize
+    0,                          // tp_itemsize
+    Pool_dealloc,               // destructor tp_dealloc
+    0,                          // tp_print
+    0,                          // tp_getattr
+    0,                          // tp_setattr
+    0,                          // tp_compare
+    0,                          // tp_repr
+    0,                          // tp_as_number
+    0,                          // tp_as_sequence
+    0,                          // tp_as_mapping
+    0,                          // tp_hash
+    0,                          // tp_call
+    0,                          // tp_str
+    0,                          // tp_getattro
+    0,                          // tp_setattro
+    0,                          // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,         // tp_flags
+    pool_doc,                   // tp_doc
+    0,                          // tp_traverse
+    0,                          // tp_clear
+    0,                          // tp_richcompare
+    0,                          // tp_weaklistoffset
+    0,                          // tp_iter
+    0,                          // tp_iternext
+    Pool_methods,               // tp_methods
+    Pool_members,               // tp_members
+    Pool_getseters,             // tp_getset
+    0,                          // tp_base
+    0,                          // tp_dict
+    0,                          // tp_descr_get
+    0,                          // tp_descr_set
+    0,                          // tp_dictoffset
+    0,                          // tp_init
+    0,                          // tp_alloc
+    Pool_new,                   // tp_new
+    0,                          // tp_free
+    0,                          // tp_is_gc
+    0,                          // tp_bases
+    0,                          // tp_mro
+    0,                          // tp_cache
+    0,                          // tp_subclasses
+    0,                          // tp_weaklist
+};
@@ -0,0 +1,70 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <pythread.h>
+
+extern PyTypeObject PoolType;
+
+struct Pool
+{
+    PyObject_HEAD
+
+    // The arguments passed to connect for each new connection.
+    PyObject* args;
+    PyObject* kwargs;
+
+    int minsize;
+    int maxsize;
+
+    // The number of seconds acquire waits for a connection by default.  Negative waits forever.
+    double timeout;
+
+    // The connections that are not checked out, an array of maxsize used as a stack so the most recently used
+    // connection is handed out first.  The pool holds a reference to each.
+    Connection** idle;
+    int idle_count;
+
+    // The number of open connections, idle and checked out.  Never more than maxsize.
+    int size;
+
+    // The settings of new connections, restored when a connection is returned.
+    ConnectionSettings settings;
+
+    // Threads waiting for a connection block on `signal` with the GIL released.  It is used as an event: it is held
+    // by the pool except while fSignaled is true, which is set (and the lock released) when a connection is returned
+    // or discarded while `waiting` is non-zero.  Everything else is only changed while holding the GIL.
+    PyThread_type_lock signal;
+    bool fSignaled;
+    int waiting;
+
+    bool closed;
+
+    // Counters for Pool's attributes of the same names.
+    long checkouts;
+    long waits;
+    long timeouts;
+    long created;
+    long discarded;
+    double wait_time;
+};
+
+#define Pool_Check(op) PyObject_TypeCheck(op, &PoolType)
+
+/*
+ * Called when a connection checked out from `pool` is closed or deleted instead of being released, so its place can
+ * be used by a new connection.
+ */
+void Pool_Discard(PyObject* pool);
+
+#endif // POOL_H
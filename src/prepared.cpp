@@ -0,0 +1,192 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A statement prepared once and executed many times.  A cursor keeps its prepared statement only until it executes
+// other SQL, so programs that create a cursor per request never execute the same statement twice on one.  A
+// PreparedStatement keeps the statement on a private cursor that only it executes, so the handle, the parameter count,
+// the described parameter types, and the bindings from the last execute are all reused.
+
+#include "pyodbc.h"
+#include "prepared.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "params.h"
+#include "errors.h"
+#include "wrapper.h"
+
+PyObject* PreparedStatement_New(Connection* cnxn, PyObject* pSql)
+{
+    if (!PyString_Check(pSql) && !PyUnicode_Check(pSql))
+    {
+        PyErr_SetString(PyExc_TypeError, "The SQL to prepare must be a string or unicode object.");
+        return 0;
+    }
+
+    PreparedStatement* stmt = PyObject_NEW(PreparedStatement, &PreparedStatementType);
+    if (!stmt)
+        return 0;
+
+    stmt->cursor = 0;
+    stmt->pSql   = pSql;
+    Py_INCREF(pSql);
+
+    Object result((PyObject*)stmt);
+
+    stmt->cursor = Cursor_New(cnxn);
+    if (!stmt->cursor)
+        return 0;
+
+    if (!Prepare(stmt->cursor, pSql))
+        return 0;
+
+    return result.Detach();
+}
+
+static void PreparedStatement_dealloc(PyObject* self)
+{
+    PreparedStatement* stmt = (PreparedStatement*)self;
+
+    Py_XDECREF(stmt->cursor);
+    Py_XDECREF(stmt->pSql);
+
+    PyObject_Del(self);
+}
+
+static PyObject* PreparedStatement_execute(PyObject* self, PyObject* args)
+{
+    // Executes the statement on the private cursor using Cursor.execute, which takes the SQL as its first argument.
+    // Since the cursor's pPreparedSQL is the same object, it is not prepared again and the parameters from the last
+    // execute are rebound only if they have changed.
+
+    PreparedStatement* stmt = (PreparedStatement*)self;
+
+    Py_ssize_t cArgs = PyTuple_GET_SIZE(args);
+
+    Object cursorArgs(PyTuple_New(cArgs + 1));
+    if (!cursorArgs)
+        return 0;
+
+    Py_INCREF(stmt->pSql);
+    PyTuple_SET_ITEM(cursorArgs.Get(), 0, stmt->pSql);
+
+    for (Py_ssize_t i = 0; i < cArgs; i++)
+    {
+        PyObject* param = PyTuple_GET_ITEM(args, i);
+        Py_INCREF(param);
+        PyTuple_SET_ITEM(cursorArgs.Get(), i + 1, param);
+    }
+
+    return Cursor_execute((PyObject*)stmt->cursor, cursorArgs);
+}
+
+static PyObject* PreparedStatement_executemany(PyObject* self, PyObject* args)
+{
+    PreparedStatement* stmt = (PreparedStatement*)self;
+
+    PyObject* param_seq;
+    if (!PyArg_ParseTuple(args, "O", &param_seq))
+        return 0;
+
+    return PyObject_CallMethod((PyObject*)stmt->cursor, "executemany", "OO", stmt->pSql, param_seq);
+}
+
+static char execute_doc[] =
+    "execute([params]) --> Cursor\n"
+    "\n"
+    "Execute the statement.  Parameters are passed as they are to Cursor.execute,\n"
+    "either as a sequence or one after another.  Returns the statement's cursor,\n"
+    "from which the results can be fetched.  Each execute replaces the results of\n"
+    "the last.";
+
+static char executemany_doc[] =
+    "executemany(seq_of_params) --> None\n"
+    "\n"
+    "Execute the statement once for each sequence of parameters, as\n"
+    "Cursor.executemany does.";
+
+static PyMethodDef PreparedStatement_methods[] =
+{
+    { "execute",     PreparedStatement_execute,     METH_VARARGS, execute_doc     },
+    { "executemany", PreparedStatement_executemany, METH_VARARGS, executemany_doc },
+    { 0, 0, 0, 0 }
+};
+
+static char preparedstatement_doc[] =
+    "A statement that is prepared once and executed many times.  Created by\n"
+    "Connection.prepare.\n"
+    "\n"
+    "The statement is kept on a private cursor, so it stays prepared however many\n"
+    "other cursors are created and used on the connection.";
+
+static char cursor_doc[] =
+    "The Cursor the statement is executed on.  Use it to fetch results.  Executing\n"
+    "other statements on it is allowed, but the next execute will have to prepare\n"
+    "the statement again.";
+
+static char sql_doc[] =
+    "The SQL passed to Connection.prepare.";
+
+static PyMemberDef PreparedStatement_members[] =
+{
+    { "cursor", T_OBJECT_EX, offsetof(PreparedStatement, cursor), READONLY, cursor_doc },
+    { "sql",    T_OBJECT_EX, offsetof(PreparedStatement, pSql),   READONLY, sql_doc },
+    { 0 }
+};
+
+PyTypeObject PreparedStatementType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.PreparedStatement", // tp_name
+    sizeof(PreparedStatement),  // tp_basicsize
+    0,                          // tp_itemsize
+    PreparedStatement_dealloc,  // destructor tp_dealloc
+    0,                          // tp_print
+    0,                          // tp_getattr
+    0,                          // tp_setattr
+    0,                          // tp_compare
+    0,                          // tp_repr
+    0,                          // tp_as_number
+    0,                          // tp_as_sequence
+    0,                          // tp_as_mapping
+    0,                          // tp_hash
+    0,                          // tp_call
+    0,                          // tp_str
+    0,                          // tp_getattro
+    0,                          // tp_setattro
+    0,                          // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,         // tp_flags
+    preparedstatement_doc,      // tp_doc
+    0,                          // tp_traverse
+    0,                          // tp_clear
+    0,                          // tp_richcompare
+    0,                          // tp_weaklistoffset
+    0,                          // tp_iter
+    0,                          // tp_iternext
+    PreparedStatement_methods,  // tp_methods
+    PreparedStatement_members,  // tp_members
+    0,                          // tp_getset
+    0,                          // tp_base
+    0,                          // tp_dict
+    0,                          // tp_descr_get
+    0,                          // tp_descr_set
+    0,                          // tp_dictoffset
+    0,                          // tp_init
+    0,                          // tp_alloc
+    0,                          // tp_new
+    0,                          // tp_free
+    0,                          // tp_is_gc
+    0,                          // tp_bases
+    0,                          // tp_mro
+    0,                          // tp_cache
+    0,                          // tp_subclasses
+    0,                          // tp_weaklist
+};
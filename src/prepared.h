@@ -0,0 +1,41 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef PREPARED_H
+#define PREPARED_H
+
+struct Connection;
+struct Cursor;
+
+extern PyTypeObject PreparedStatementType;
+
+struct PreparedStatement
+{
+    PyObject_HEAD
+
+    // The private cursor that owns the prepared statement handle, the parameter count, and the parameter types once
+    // they are described.  Each execute returns it so the results can be fetched.
+    Cursor* cursor;
+
+    // The SQL.  The cursor's pPreparedSQL is this object while the statement is still prepared on it, so Prepare and
+    // PrepareAndBind find it by pointer.
+    PyObject* pSql;
+};
+
+#define PreparedStatement_Check(op) PyObject_TypeCheck(op, &PreparedStatementType)
+
+/*
+ * Used by Connection.prepare to create a new prepared statement.  The SQL is prepared before returning.  If an error
+ * occurs, an exception is set and zero is returned.
+ */
+PyObject* PreparedStatement_New(Connection* cnxn, PyObject* pSql);
+
+#endif // PREPARED_H
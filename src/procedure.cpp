@@ -0,0 +1,218 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// A stored procedure call that is prepared and bound once.  callproc rebuilds the statement, rediscovers every
+// parameter's type, and rebinds on every call; a Procedure keeps its ParamInfos bound to buffers it owns so each call
+// only copies the new input values in and calls SQLExecute.
+
+#include "pyodbc.h"
+#include "procedure.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "params.h"
+#include "errors.h"
+#include "wrapper.h"
+
+static PyObject* MakeCallStatement(PyObject* name, Py_ssize_t cParams)
+{
+    // Returns "{ CALL name(?,?,...) }" with one marker for each parameter.
+
+    if (!PyString_Check(name) && !PyUnicode_Check(name))
+    {
+        PyErr_SetString(PyExc_TypeError, "The procedure name must be a string or unicode object.");
+        return 0;
+    }
+
+    // One byte for each '?' and one for each ',' (or the '\0' after the last).
+    Py_ssize_t cbParameterList = cParams ? 2 * cParams : 1;
+    char* pszParameterList = (char*)pyodbc_malloc(cbParameterList);
+    if (!pszParameterList)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+
+    for (Py_ssize_t ix = 0; ix < cParams; ++ix)
+    {
+        pszParameterList[2 * ix] = '?';
+        pszParameterList[2 * ix + 1] = ',';
+    }
+    pszParameterList[cbParameterList - 1] = '\0';
+
+    // As in callproc, the name is assumed to be ASCII.
+    PyObject* pCall = 0;
+#if PY_MAJOR_VERSION < 3
+    if (PyString_Check(name))
+    {
+        pCall = PyString_FromFormat("{ CALL %s(%s) }", PyString_AS_STRING(name), pszParameterList);
+    }
+    else
+#endif
+    {
+        Object ascii(PyUnicode_AsASCIIString(name));
+        if (ascii)
+            pCall = PyString_FromFormat("{ CALL %s(%s) }", PyBytes_AS_STRING(ascii.Get()), pszParameterList);
+    }
+
+    pyodbc_free(pszParameterList);
+    return pCall;
+}
+
+PyObject* Procedure_New(Connection* cnxn, PyObject* name, PyObject* signature)
+{
+    if (!PySequence_Check(signature) || PyString_Check(signature) || PyUnicode_Check(signature))
+    {
+        PyErr_SetString(PyExc_TypeError, "The procedure signature must be a sequence of prototype values or SQLParameters.");
+        return 0;
+    }
+
+    Py_ssize_t cParams = PySequence_Length(signature);
+    if (cParams < 0)
+        return 0;
+
+    Procedure* proc = PyObject_NEW(Procedure, &ProcedureType);
+    if (!proc)
+        return 0;
+
+    proc->cursor    = 0;
+    proc->pCall     = 0;
+    proc->signature = signature;
+    Py_INCREF(signature);
+
+    Object result((PyObject*)proc);
+
+    proc->pCall = MakeCallStatement(name, cParams);
+    if (!proc->pCall)
+        return 0;
+
+    TRACE("procedure: %s\n", PyBytes_Check(proc->pCall) ? PyBytes_AS_STRING(proc->pCall) : "(unicode)");
+
+    proc->cursor = Cursor_New(cnxn);
+    if (!proc->cursor)
+        return 0;
+
+    if (!PrepareAndBindFixed(proc->cursor, proc->pCall, signature))
+        return 0;
+
+    return result.Detach();
+}
+
+static void Procedure_dealloc(PyObject* self)
+{
+    Procedure* proc = (Procedure*)self;
+
+    Py_XDECREF(proc->cursor);
+    Py_XDECREF(proc->pCall);
+    Py_XDECREF(proc->signature);
+
+    PyObject_Del(self);
+}
+
+static PyObject* Procedure_call(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Procedure* proc = (Procedure*)self;
+    Cursor* cur = proc->cursor;
+
+    if (kwargs && PyDict_Size(kwargs) != 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Procedure calls do not accept keyword arguments.");
+        return 0;
+    }
+
+    if (cur->cnxn == 0 || cur->hstmt == SQL_NULL_HANDLE)
+        return RaiseErrorV(0, ProgrammingError, "Attempt to use a closed cursor.");
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+        return RaiseErrorV(0, ProgrammingError, "The cursor's connection has been closed.");
+
+    // If the cursor was used to execute something else, the call has to be prepared and bound again.  Otherwise the
+    // bindings from the last call are still in place.
+
+    if (cur->pPreparedSQL != proc->pCall || cur->paramInfos == 0)
+    {
+        if (!PrepareAndBindFixed(cur, proc->pCall, proc->signature))
+            return 0;
+    }
+
+    if (!SetFixedParams(cur, args))
+        return 0;
+
+    return Cursor_ExecuteProcedure(cur);
+}
+
+static char procedure_doc[] =
+    "A stored procedure call that is prepared and bound once.  Created by\n"
+    "Connection.procedure.\n"
+    "\n"
+    "Calling the object with the input and input/output values executes the\n"
+    "procedure and returns a tuple of the output and input/output parameter\n"
+    "values.  Result sets can be read from the `cursor` attribute.";
+
+static char cursor_doc[] =
+    "The Cursor used to execute the procedure.  Use it to fetch any result sets the\n"
+    "procedure returns.  Executing other statements on it is allowed, but the next\n"
+    "call will have to prepare and bind the procedure again.";
+
+static PyMemberDef Procedure_members[] =
+{
+    { "cursor", T_OBJECT_EX, offsetof(Procedure, cursor), READONLY, cursor_doc },
+    { 0 }
+};
+
+PyTypeObject ProcedureType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.Procedure",         // tp_name
+    sizeof(Procedure),          // tp_basicsize
+    0,                          // tp_itemsize
+    Procedure_dealloc,          // destructor tp_dealloc
+    0,                          // tp_print
+    0,                          // tp_getattr
+    0,                          // tp_setattr
+    0,                          // tp_compare
+    0,                          // tp_repr
+    0,                          // tp_as_number
+    0,                          // tp_as_sequence
+    0,                          // tp_as_mapping
+    0,                          // tp_hash
+    Procedure_call,             // tp_call
+    0,                          // tp_str
+    0,                          // tp_getattro
+    0,                          // tp_setattro
+    0,                          // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,         // tp_flags
+    procedure_doc,              // tp_doc
+    0,                          // tp_traverse
+    0,                          // tp_clear
+    0,                          // tp_richcompare
+    0,                          // tp_weaklistoffset
+    0,                          // tp_iter
+    0,                          // tp_iternext
+    0,                          // tp_methods
+    Procedure_members,          // tp_members
+    0,                          // tp_getset
+    0,                          // tp_base
+    0,                          // tp_dict
+    0,                          // tp_descr_get
+    0,                          // tp_descr_set
+    0,                          // tp_dictoffset
+    0,                          // tp_init
+    0,                          // tp_alloc
+    0,                          // tp_new
+    0,                          // tp_free
+    0,                          // tp_is_gc
+    0,                          // tp_bases
+    0,                          // tp_mro
+    0,                          // tp_cache
+    0,                          // tp_subclasses
+    0,                          // tp_weaklist
+};
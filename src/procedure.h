@@ -0,0 +1,44 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef PROCEDURE_H
+#define PROCEDURE_H
+
+struct Connection;
+struct Cursor;
+
+extern PyTypeObject ProcedureType;
+
+struct Procedure
+{
+    PyObject_HEAD
+
+    // The private cursor the call is prepared and bound on.  It is exposed so result sets produced by the procedure
+    // can be fetched.
+    Cursor* cursor;
+
+    // The "{ CALL name(?,...) }" statement.  The cursor's pPreparedSQL is compared against this pointer to detect when
+    // the cursor has been used for something else and the call must be prepared and bound again.
+    PyObject* pCall;
+
+    // The sequence passed to Connection.procedure, one prototype value or SQLParameter per parameter marker.
+    PyObject* signature;
+};
+
+#define Procedure_Check(op) PyObject_TypeCheck(op, &ProcedureType)
+
+/*
+ * Used by Connection.procedure to create a new procedure object.  The call is prepared and bound before returning.  If
+ * an error occurs, an exception is set and zero is returned.
+ */
+PyObject* Procedure_New(Connection* cnxn, PyObject* name, PyObject* signature);
+
+#endif // PROCEDURE_H
@@ -1,6 +1,22 @@
 
 #include "pyodbc.h"
 
+#include <time.h>
+
+double MonotonicSeconds()
+{
+#ifdef _MSC_VER
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
 bool Text_EqualsI(PyObject* lhs, const char* rhs)
 {
 #if PY_MAJOR_VERSION < 3
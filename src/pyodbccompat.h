@@ -68,6 +68,11 @@ inline void PyString_ConcatAndDel(PyObject** lhs, PyObject* rhs)
 
 #endif
 
+// Py_hash_t was introduced in 3.2.  Before that, hashes were longs.
+#if PY_VERSION_HEX < 0x03020000
+typedef long Py_hash_t;
+#endif
+
 inline PyObject* Text_New(Py_ssize_t length)
 {
     // Returns a new, uninitialized String (Python 2) or Unicode object (Python 3) object.
@@ -101,6 +106,10 @@ inline bool Text_Check(PyObject* o)
     return o && PyUnicode_Check(o);
 }
 
+double MonotonicSeconds();
+// Returns the seconds from an arbitrary start on a clock that is not affected by changes to the system time.  Used for
+// the wait and liveness timers.  (Not a Python 2/3 difference, but a platform one.)
+
 bool Text_EqualsI(PyObject* lhs, const char* rhs);
 // Case-insensitive comparison for a Python string object (Unicode in Python 3, ASCII or Unicode in Python 2) against
 // an ASCII string.  If lhs is 0 or None, false is returned.
@@ -19,6 +19,10 @@
 #include "getdata.h"
 #include "cnxninfo.h"
 #include "params.h"
+#include "procedure.h"
+#include "prepared.h"
+#include "pool.h"
+#include "inlist.h"
 #include "dbspecific.h"
 #include <datetime.h>
 
@@ -179,6 +183,8 @@ static bool import_types()
     GetData_init();
     if (!Params_init())
         return false;
+    if (!InList_init())
+        return false;
 
     PyObject* decimalmod = PyImport_ImportModule("decimal");
     if (!decimalmod)
@@ -244,7 +250,7 @@ static keywordmap keywordmaps[] =
 };
 
 
-static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
+PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
 {
     UNUSED(self);
 
@@ -254,6 +260,7 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
     int fUnicodeResults = 0;
     int fReadOnly = 0;
     long timeout = 0;
+    Object encoding;            // the codec name as bytes, if any
 
     Py_ssize_t size = args ? PyTuple_Size(args) : 0;
 
@@ -323,6 +330,24 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
                 fReadOnly = PyObject_IsTrue(value);
                 continue;
             }
+            if (Text_EqualsI(key, "encoding"))
+            {
+                if (value == Py_None)
+                    continue;
+#if PY_MAJOR_VERSION < 3
+                if (PyString_Check(value))
+                {
+                    Py_INCREF(value);
+                    encoding.Attach(value);
+                    continue;
+                }
+#endif
+                if (!PyUnicode_Check(value))
+                    return PyErr_Format(PyExc_TypeError, "encoding must be a string or None");
+                if (!encoding.Attach(PyUnicode_AsASCIIString(value)))
+                    return 0;
+                continue;
+            }
             
             // Map DB API recommended names to ODBC names (e.g. user --> uid).
 
@@ -368,7 +393,8 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
             return 0;
     }
 
-    return (PyObject*)Connection_New(pConnectString.Get(), fAutoCommit != 0, fAnsi != 0, fUnicodeResults != 0, timeout, fReadOnly != 0);
+    return (PyObject*)Connection_New(pConnectString.Get(), fAutoCommit != 0, fAnsi != 0, fUnicodeResults != 0, timeout, fReadOnly != 0,
+                                     encoding.Get());
 }
 
 
@@ -469,8 +495,8 @@ static char connect_doc[] =
     "documentation or the documentation of your ODBC driver for details.\n"
     "\n"
     "The connection string can be passed as the string `str`, as a list of keywords,\n"
-    "or a combination of the two.  Any keywords except autocommit, ansi, and timeout\n"
-    "(see below) are simply added to the connection string.\n"
+    "or a combination of the two.  Any keywords except autocommit, ansi, timeout,\n"
+    "and encoding (see below) are simply added to the connection string.\n"
     "\n"
     "  connect('server=localhost;user=me')\n"
     "  connect(server='localhost', user='me')\n"
@@ -503,7 +529,16 @@ static char connect_doc[] =
     "  timeout\n"
     "    An integer login timeout in seconds, used to set the SQL_ATTR_LOGIN_TIMEOUT\n"
     "    attribute of the connection.  The default is 0 which means the database's\n"
-    "    default timeout, if any, is used.\n";
+    "    default timeout, if any, is used.\n"
+    "   \n"
+    "  encoding\n"
+    "    The name of a Python codec, such as 'utf-8', used to exchange text with the\n"
+    "    driver as SQL_C_CHAR instead of the Unicode (SQLWCHAR) functions and types.\n"
+    "    Character columns are fetched and decoded, Unicode input parameters are\n"
+    "    encoded and bound as varchar, and SQL is executed with the ANSI functions.\n"
+    "    This avoids converting to and from UTF-16 for drivers that use UTF-8\n"
+    "    natively, such as MySQL, PostgreSQL, and SQLite.  The default, None, uses\n"
+    "    the Unicode functions.\n";
 
 static char timefromticks_doc[] =
     "TimeFromTicks(ticks) --> datetime.time\n"
@@ -813,6 +848,10 @@ static const ConstantDef aConstants[] = {
     MAKECONST(SQL_PARAM_INPUT),
     MAKECONST(SQL_PARAM_INPUT_OUTPUT),
     MAKECONST(SQL_PARAM_OUTPUT),
+#ifdef SQL_PARAM_OUTPUT_STREAM
+    MAKECONST(SQL_PARAM_INPUT_OUTPUT_STREAM),
+    MAKECONST(SQL_PARAM_OUTPUT_STREAM),
+#endif
     MAKECONST(SQL_RETURN_VALUE),
     MAKECONST(SQL_RESULT_COL),
     MAKECONST(SQL_PROCEDURES),
@@ -917,7 +956,9 @@ initpyodbc(void)
 {
     ErrorInit();
 
-    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0)
+    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0 ||
+        PyType_Ready(&ProcedureType) < 0 || PyType_Ready(&PreparedStatementType) < 0 ||
+        PyType_Ready(&PoolType) < 0)
         return MODRETURN(0);
 
     Object module;
@@ -952,6 +993,12 @@ initpyodbc(void)
     Py_INCREF((PyObject*)&CursorType);
     PyModule_AddObject(module, "Row", (PyObject*)&RowType);
     Py_INCREF((PyObject*)&RowType);
+    PyModule_AddObject(module, "Procedure", (PyObject*)&ProcedureType);
+    Py_INCREF((PyObject*)&ProcedureType);
+    PyModule_AddObject(module, "PreparedStatement", (PyObject*)&PreparedStatementType);
+    Py_INCREF((PyObject*)&PreparedStatementType);
+    PyModule_AddObject(module, "Pool", (PyObject*)&PoolType);
+    Py_INCREF((PyObject*)&PoolType);
 
     // Add the SQL_XXX defines from ODBC.
     for (unsigned int i = 0; i < _countof(aConstants); i++)
@@ -989,6 +1036,9 @@ initpyodbc(void)
     Py_INCREF(SQLParameter_type);
     PyModule_AddObject(module, "SQLParameter", SQLParameter_type);
 
+    Py_INCREF(&InListType);
+    PyModule_AddObject(module, "InList", (PyObject*)&InListType);
+
     PyModule_AddIntConstant(module, "UNICODE_SIZE", sizeof(Py_UNICODE));
     PyModule_AddIntConstant(module, "SQLWCHAR_SIZE", sizeof(SQLWCHAR));
 
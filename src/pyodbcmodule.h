@@ -44,6 +44,9 @@ extern PyTypeObject ConnectionType;
 // Thd pyodbc module.
 extern PyObject* pModule;
 
+// The module's connect function, also used by Pool to open its connections.
+PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs);
+
 inline bool lowercase()
 {
     return PyObject_GetAttrString(pModule, "lowercase") == Py_True;
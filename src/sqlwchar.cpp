@@ -2,10 +2,11 @@
 #include "pyodbc.h"
 #include "sqlwchar.h"
 #include "wrapper.h"
+#include "utf16.h"
 
 Py_ssize_t SQLWCHAR_SIZE = sizeof(SQLWCHAR);
 
-#ifdef HAVE_WCHAR_H
+#if PY_VERSION_HEX < 0x03030000 && defined(HAVE_WCHAR_H)
 static int WCHAR_T_SIZE  = sizeof(wchar_t);
 #endif
 
@@ -31,9 +32,11 @@ static Py_UNICODE MAX_SQLWCHAR = CalculateMaxSQL();
 
 // If SQLWCHAR is larger than Py_UNICODE, this is the largest value that can be held in a Py_UNICODE.  Because it is
 // stored in a Py_UNICODE, it is undefined when sizeof(SQLWCHAR) <= sizeof(Py_UNICODE).
+#if PY_VERSION_HEX < 0x03030000
 static const SQLWCHAR MAX_PY_UNICODE = (SQLWCHAR)PyUnicode_GetMax();
+#endif
 
-static bool sqlwchar_copy(SQLWCHAR* pdest, const Py_UNICODE* psrc, Py_ssize_t len)
+bool sqlwchar_copy(SQLWCHAR* pdest, const Py_UNICODE* psrc, Py_ssize_t len)
 {
     // Copies a Python Unicode string to a SQLWCHAR buffer.  Note that this does copy the NULL terminator, but `len`
     // should not include it.  That is, it copies (len + 1) characters.
@@ -63,6 +66,151 @@ static bool sqlwchar_copy(SQLWCHAR* pdest, const Py_UNICODE* psrc, Py_ssize_t le
     return true;
 }
 
+#if PY_VERSION_HEX >= 0x03030000
+
+// Python 3.3 (PEP 393) stores each string with 1, 2, or 4 bytes per character, whichever is the smallest that holds
+// its largest character.  Reading that directly avoids PyUnicode_AsUnicode, which builds and keeps a wchar_t copy of
+// the string.  When SQLWCHAR is 2 bytes, the strings are converted to UTF-16, so characters outside the BMP become
+// surrogate pairs.
+
+Py_ssize_t SQLWCHAR_Length(PyObject* o)
+{
+    if (PyUnicode_READY(o) == -1)
+        return -1;
+
+    Py_ssize_t len = PyUnicode_GET_LENGTH(o);
+
+    if (SQLWCHAR_SIZE == 2 && PyUnicode_KIND(o) == PyUnicode_4BYTE_KIND)
+    {
+        const Py_UCS4* p = PyUnicode_4BYTE_DATA(o);
+        Py_ssize_t cch = len;
+        for (Py_ssize_t i = 0; i < len; i++)
+        {
+            if (p[i] > 0xFFFF)
+                cch++;
+        }
+        return cch;
+    }
+
+    return len;
+}
+
+const SQLWCHAR* SQLWCHAR_Borrow(PyObject* o)
+{
+    // Strings stored with the same character size as SQLWCHAR are already in the right form, including the NULL
+    // terminator.  (A 2-byte string has no characters outside the BMP, so it is valid UTF-16 as is.  Encoding it would
+    // produce the same code units, so there is nothing to check first.)
+
+    if (PyUnicode_READY(o) == -1)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    if ((SQLWCHAR_SIZE == 2 && PyUnicode_KIND(o) == PyUnicode_2BYTE_KIND) ||
+        (SQLWCHAR_SIZE == 4 && PyUnicode_KIND(o) == PyUnicode_4BYTE_KIND))
+    {
+        return (const SQLWCHAR*)PyUnicode_DATA(o);
+    }
+
+    return 0;
+}
+
+bool SQLWCHAR_Copy(SQLWCHAR* pdest, PyObject* o)
+{
+    if (PyUnicode_READY(o) == -1)
+        return false;
+
+    Py_ssize_t len = PyUnicode_GET_LENGTH(o);
+
+    switch (PyUnicode_KIND(o))
+    {
+    case PyUnicode_1BYTE_KIND:
+    {
+        const Py_UCS1* p = PyUnicode_1BYTE_DATA(o);
+        if (SQLWCHAR_SIZE == 2)
+        {
+            UTF16_Widen(p, len, (Py_UCS2*)pdest);
+            pdest += len;
+        }
+        else
+        {
+            for (Py_ssize_t i = 0; i < len; i++)
+                *pdest++ = (SQLWCHAR)p[i];
+        }
+        break;
+    }
+
+    case PyUnicode_2BYTE_KIND:
+    {
+        const Py_UCS2* p = PyUnicode_2BYTE_DATA(o);
+        if (SQLWCHAR_SIZE == 2)
+        {
+            memcpy(pdest, p, sizeof(Py_UCS2) * len);
+            pdest += len;
+        }
+        else
+        {
+            for (Py_ssize_t i = 0; i < len; i++)
+                *pdest++ = (SQLWCHAR)p[i];
+        }
+        break;
+    }
+
+    default:
+    {
+        const Py_UCS4* p = PyUnicode_4BYTE_DATA(o);
+        if (SQLWCHAR_SIZE == 2)
+        {
+            for (Py_ssize_t i = 0; i < len; i++)
+            {
+                Py_UCS4 ch = p[i];
+                if (ch > 0xFFFF)
+                {
+                    ch -= 0x10000;
+                    *pdest++ = (SQLWCHAR)(0xD800 | (ch >> 10));
+                    *pdest++ = (SQLWCHAR)(0xDC00 | (ch & 0x3FF));
+                }
+                else
+                {
+                    *pdest++ = (SQLWCHAR)ch;
+                }
+            }
+        }
+        else
+        {
+            for (Py_ssize_t i = 0; i < len; i++)
+                *pdest++ = (SQLWCHAR)p[i];
+        }
+        break;
+    }
+    }
+
+    *pdest = 0;
+    return true;
+}
+
+#else
+
+Py_ssize_t SQLWCHAR_Length(PyObject* o)
+{
+    return PyUnicode_GET_SIZE(o);
+}
+
+const SQLWCHAR* SQLWCHAR_Borrow(PyObject* o)
+{
+    if (SQLWCHAR_SIZE == Py_UNICODE_SIZE)
+        return (const SQLWCHAR*)PyUnicode_AS_UNICODE(o);
+    return 0;
+}
+
+bool SQLWCHAR_Copy(SQLWCHAR* pdest, PyObject* o)
+{
+    return sqlwchar_copy(pdest, PyUnicode_AS_UNICODE(o), PyUnicode_GET_SIZE(o));
+}
+
+#endif
+
 SQLWChar::SQLWChar(PyObject* o)
 {
     // Converts from a Python Unicode string.
@@ -93,14 +241,16 @@ bool SQLWChar::Convert(PyObject* o)
         return false;
     }
 
-    Py_UNICODE* pU   = (Py_UNICODE*)PyUnicode_AS_UNICODE(o);
-    Py_ssize_t  lenT = PyUnicode_GET_SIZE(o);
+    Py_ssize_t lenT = SQLWCHAR_Length(o);
+    if (lenT == -1)
+        return false;
 
-    if (SQLWCHAR_SIZE == Py_UNICODE_SIZE)
+    const SQLWCHAR* pBorrowed = SQLWCHAR_Borrow(o);
+    if (pBorrowed)
     {
-        // The ideal case - SQLWCHAR and Py_UNICODE are the same, so we point into the Unicode object.
+        // The ideal case - the string is already stored as SQLWCHARs, so we point into the Unicode object.
 
-        pch         = (SQLWCHAR*)pU;
+        pch         = (SQLWCHAR*)pBorrowed;
         len         = lenT;
         owns_memory = false;
         return true;
@@ -114,7 +264,7 @@ bool SQLWChar::Convert(PyObject* o)
             return false;
         }
 
-        if (!sqlwchar_copy(pchT, pU, lenT))
+        if (!SQLWCHAR_Copy(pchT, o))
         {
             pyodbc_free(pchT);
             return false;
@@ -127,6 +277,83 @@ bool SQLWChar::Convert(PyObject* o)
     }
 }
 
+#if PY_VERSION_HEX >= 0x03030000
+
+static PyObject* DecodeSurrogates(const Py_UCS2* p, Py_ssize_t cch)
+{
+    // Used when the text has surrogates, so each valid pair must be combined into one character.  A surrogate that
+    // isn't part of a pair is kept as is rather than raising an error, as it always has been.
+
+    Py_ssize_t len     = 0;
+    Py_UCS4    maxchar = 0;
+
+    for (Py_ssize_t i = 0; i < cch; i++, len++)
+    {
+        Py_UCS4 ch = p[i];
+        if (Py_UNICODE_IS_HIGH_SURROGATE(ch) && i + 1 < cch && Py_UNICODE_IS_LOW_SURROGATE(p[i + 1]))
+            ch = Py_UNICODE_JOIN_SURROGATES(ch, p[++i]);
+        if (ch > maxchar)
+            maxchar = ch;
+    }
+
+    PyObject* result = PyUnicode_New(len, maxchar);
+    if (!result)
+        return 0;
+
+    int   kind = PyUnicode_KIND(result);
+    void* data = PyUnicode_DATA(result);
+
+    Py_ssize_t j = 0;
+    for (Py_ssize_t i = 0; i < cch; i++, j++)
+    {
+        Py_UCS4 ch = p[i];
+        if (Py_UNICODE_IS_HIGH_SURROGATE(ch) && i + 1 < cch && Py_UNICODE_IS_LOW_SURROGATE(p[i + 1]))
+            ch = Py_UNICODE_JOIN_SURROGATES(ch, p[++i]);
+        PyUnicode_WRITE(kind, data, j, ch);
+    }
+
+    return result;
+}
+
+PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch)
+{
+    // Create a Python Unicode object from a zero-terminated SQLWCHAR.
+    //
+    // UTF-16 text is scanned first to find the smallest PEP 393 kind that holds it, so the string can be created in
+    // its final form and filled with a single copy.  Most database text is ASCII or latin-1, which is narrowed to one
+    // byte per character.
+
+    if (SQLWCHAR_SIZE == 4)
+        return PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, sz, cch);
+
+    const Py_UCS2* p = (const Py_UCS2*)sz;
+
+    Py_UCS2 bits;
+    bool surrogates;
+    UTF16_Scan(p, cch, bits, surrogates);
+
+    if (surrogates)
+        return DecodeSurrogates(p, cch);
+
+    // `bits` has every bit set that is set in any code unit, so it is below 0x80 only if every character is, and
+    // likewise for 0x100.  The kind is therefore exactly the one PyUnicode_New would choose for the real maximum.
+
+    if (bits < 0x100)
+    {
+        PyObject* result = PyUnicode_New(cch, (bits < 0x80) ? 0x7F : 0xFF);
+        if (result)
+            UTF16_Narrow(p, cch, PyUnicode_1BYTE_DATA(result));
+        return result;
+    }
+
+    PyObject* result = PyUnicode_New(cch, 0xFFFF);
+    if (result)
+        memcpy(PyUnicode_2BYTE_DATA(result), p, sizeof(Py_UCS2) * cch);
+    return result;
+}
+
+#else
+
 PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch)
 {
     // Create a Python Unicode object from a zero-terminated SQLWCHAR.
@@ -174,6 +401,8 @@ PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch)
     return result.Detach();
 }
 
+#endif
+
 void SQLWChar::dump()
 {
     printf("sqlwchar=%ld pch=%p len=%ld owns=%d\n", sizeof(SQLWCHAR), pch, len, (int)owns_memory);
@@ -57,6 +57,24 @@ extern Py_ssize_t SQLWCHAR_SIZE;
 // Allocate a new Unicode object, initialized from the given SQLWCHAR string.
 PyObject* PyUnicode_FromSQLWCHAR(const SQLWCHAR* sz, Py_ssize_t cch);
 
+// Copies `len` characters plus the NULL terminator into `pdest`, which must be large enough.  Returns false with a
+// ValueError if a character can't be represented as a SQLWCHAR.
+bool sqlwchar_copy(SQLWCHAR* pdest, const Py_UNICODE* psrc, Py_ssize_t len);
+
+// Returns the number of SQLWCHARs needed for the Unicode object `o`, not including the NULL terminator.  This can be
+// more than the length of the string when characters outside the BMP are stored as UTF-16 surrogate pairs.  Returns
+// -1 with an exception set on error.
+Py_ssize_t SQLWCHAR_Length(PyObject* o);
+
+// If the characters of the Unicode object `o` are already stored as NULL terminated SQLWCHARs, returns a pointer to
+// them, which is valid as long as `o` is.  Otherwise returns zero (without an exception) and the string must be
+// copied with SQLWCHAR_Copy.
+const SQLWCHAR* SQLWCHAR_Borrow(PyObject* o);
+
+// Copies the Unicode object `o` and a NULL terminator to `pdest`, which must hold SQLWCHAR_Length(o) + 1 SQLWCHARs.
+// Returns false with an exception set on error.
+bool SQLWCHAR_Copy(SQLWCHAR* pdest, PyObject* o);
+
 SQLWCHAR* SQLWCHAR_FromUnicode(const Py_UNICODE* pch, Py_ssize_t len, int buff_len = -1);
 
 #endif // _PYODBCSQLWCHAR_H
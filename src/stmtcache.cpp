@@ -0,0 +1,427 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// The per-connection prepared statement cache.
+//
+// A cursor owns one statement handle, and a prepared statement lives on a handle, so switching SQL used to throw the
+// previous preparation away.  With the cache enabled, a cursor that moves to different SQL parks its handle (still
+// prepared) in its connection's cache and takes over a cached handle prepared from the new SQL, if there is one.
+// Cursors also park their handle when closed, so short-lived cursors executing the same SQL share the preparations.
+//
+// The cache is a small array ordered from least to most recently used, like the output converters, so lookups are
+// a linear scan comparing hashes first.  All changes are made while holding the GIL, and an entry is always removed
+// from the array before the GIL is released to free its handle.
+//
+// Statement handles themselves are pooled too.  Allocating a handle is a round trip to the server with some drivers,
+// and programs that create a cursor per request pay it every time, so freed handles are reset and kept in a small
+// per-connection stack (up to statement_handle_pool_size of them) for the next cursor.
+
+#include "pyodbc.h"
+#include "stmtcache.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "cursor.h"
+#include "params.h"
+#include "errors.h"
+
+bool AllocStatementHandle(Connection* cnxn, HSTMT& hstmt)
+{
+    if (cnxn->hstmtpool_count > 0)
+    {
+        hstmt = cnxn->hstmtpool[--cnxn->hstmtpool_count];
+        return true;
+    }
+
+    hstmt = SQL_NULL_HANDLE;
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle("SQLAllocHandle", cnxn->hdbc, SQL_NULL_HANDLE);
+        hstmt = SQL_NULL_HANDLE;
+        return false;
+    }
+
+    if (cnxn->timeout)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLSetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)cnxn->timeout, 0);
+        Py_END_ALLOW_THREADS
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle("SQLSetStmtAttr(SQL_ATTR_QUERY_TIMEOUT)", cnxn->hdbc, hstmt);
+
+            Py_BEGIN_ALLOW_THREADS
+            SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+            Py_END_ALLOW_THREADS
+            hstmt = SQL_NULL_HANDLE;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FreeStatementHandle(Connection* cnxn, HSTMT hstmt)
+{
+    // MS ODBC will crash if we use an HSTMT after the HDBC has been freed.
+    if (cnxn->hdbc == SQL_NULL_HANDLE || hstmt == SQL_NULL_HANDLE)
+        return;
+
+    if (cnxn->hstmtpool_count < cnxn->hstmtpool_capacity)
+    {
+        // Reset everything a cursor may have left on the handle: results, column and parameter bindings, and the
+        // noscan attribute.  (A prepared statement is left, but is replaced by the next prepare or execute.)
+
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLFreeStmt(hstmt, SQL_CLOSE);
+        if (SQL_SUCCEEDED(ret))
+            ret = SQLFreeStmt(hstmt, SQL_UNBIND);
+        if (SQL_SUCCEEDED(ret))
+            ret = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+        if (SQL_SUCCEEDED(ret))
+            SQLSetStmtAttr(hstmt, SQL_ATTR_NOSCAN, (SQLPOINTER)SQL_NOSCAN_OFF, 0);
+        Py_END_ALLOW_THREADS
+
+        // The connection may have been closed, freeing the handle, or the pool filled while the GIL was released.
+
+        if (cnxn->hdbc == SQL_NULL_HANDLE)
+            return;
+
+        if (SQL_SUCCEEDED(ret) && cnxn->hstmtpool_count < cnxn->hstmtpool_capacity)
+        {
+            cnxn->hstmtpool[cnxn->hstmtpool_count++] = hstmt;
+            return;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+    Py_END_ALLOW_THREADS
+}
+
+static void FreePooledHandles(Connection* cnxn, HSTMT* handles, int count)
+{
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+        return;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (int i = 0; i < count; i++)
+        SQLFreeHandle(SQL_HANDLE_STMT, handles[i]);
+    Py_END_ALLOW_THREADS
+}
+
+bool HandlePool_Resize(Connection* cnxn, int capacity)
+{
+    HSTMT* pool = 0;
+
+    if (capacity > 0)
+    {
+        pool = (HSTMT*)pyodbc_malloc(sizeof(HSTMT) * capacity);
+        if (!pool)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+    }
+
+    // Keep the handles that fit and free the rest once the new array is in place.
+
+    HSTMT* old   = cnxn->hstmtpool;
+    int    count = cnxn->hstmtpool_count;
+    int    keep  = min(count, capacity);
+
+    if (keep)
+        memcpy(pool, old, sizeof(HSTMT) * keep);
+
+    cnxn->hstmtpool          = pool;
+    cnxn->hstmtpool_count    = keep;
+    cnxn->hstmtpool_capacity = capacity;
+
+    FreePooledHandles(cnxn, &old[keep], count - keep);
+
+    pyodbc_free(old);
+
+    return true;
+}
+
+void HandlePool_Empty(Connection* cnxn)
+{
+    int count = cnxn->hstmtpool_count;
+    cnxn->hstmtpool_count = 0;
+    FreePooledHandles(cnxn, cnxn->hstmtpool, count);
+}
+
+void HandlePool_Clear(Connection* cnxn)
+{
+    HandlePool_Empty(cnxn);
+
+    pyodbc_free(cnxn->hstmtpool);
+    cnxn->hstmtpool          = 0;
+    cnxn->hstmtpool_capacity = 0;
+}
+
+static void FreeEntry(Connection* cnxn, CachedStatement& entry)
+{
+    // The entry must already be out of the cache array since this releases the GIL.
+
+    Py_XDECREF(entry.pPreparedSQL);
+    pyodbc_free(entry.paramtypes);
+    FreeStatementHandle(cnxn, entry.hstmt);
+}
+
+static void RemoveEntry(Connection* cnxn, int i)
+{
+    memmove(&cnxn->stmtcache[i], &cnxn->stmtcache[i + 1], sizeof(CachedStatement) * (cnxn->stmtcache_count - i - 1));
+    cnxn->stmtcache_count--;
+}
+
+static int FindEntry(Connection* cnxn, PyObject* pSql, Py_hash_t hash)
+{
+    // Returns the index of the most recently used statement prepared from pSql, or -1.
+
+    for (int i = cnxn->stmtcache_count - 1; i >= 0; i--)
+    {
+        if (cnxn->stmtcache[i].hash == hash && IsSameSQL(cnxn->stmtcache[i].pPreparedSQL, pSql))
+            return i;
+    }
+    return -1;
+}
+
+static void CopyNoScan(HSTMT hstmtFrom, HSTMT hstmtTo)
+{
+    // noscan is a statement attribute the cursor exposes, so it has to follow the cursor onto another handle.  Errors
+    // are ignored since not all drivers support it.
+
+    SQLUINTEGER noscanFrom = SQL_NOSCAN_OFF;
+    SQLUINTEGER noscanTo   = SQL_NOSCAN_OFF;
+
+    Py_BEGIN_ALLOW_THREADS
+    SQLGetStmtAttr(hstmtFrom, SQL_ATTR_NOSCAN, (SQLPOINTER)&noscanFrom, sizeof(SQLUINTEGER), 0);
+    SQLGetStmtAttr(hstmtTo,   SQL_ATTR_NOSCAN, (SQLPOINTER)&noscanTo,   sizeof(SQLUINTEGER), 0);
+    if (noscanFrom != noscanTo)
+        SQLSetStmtAttr(hstmtTo, SQL_ATTR_NOSCAN, (SQLPOINTER)(uintptr_t)noscanFrom, 0);
+    Py_END_ALLOW_THREADS
+}
+
+bool IsSameSQL(PyObject* pSql1, PyObject* pSql2)
+{
+    if (pSql1 == pSql2)
+        return true;
+
+    if (pSql1 == 0 || pSql2 == 0)
+        return false;
+
+    Py_hash_t hash1 = PyObject_Hash(pSql1);
+    Py_hash_t hash2 = PyObject_Hash(pSql2);
+    if (hash1 == -1 || hash2 == -1)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    if (hash1 != hash2)
+        return false;
+
+    int result = PyObject_RichCompareBool(pSql1, pSql2, Py_EQ);
+    if (result == -1)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    return result == 1;
+}
+
+bool StatementCache_Checkin(Cursor* cur)
+{
+    Connection* cnxn = cur->cnxn;
+
+    if (cnxn->stmtcache_capacity == 0 || cur->pPreparedSQL == 0 || cur->hstmt == SQL_NULL_HANDLE ||
+        cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    Py_hash_t hash = PyObject_Hash(cur->pPreparedSQL);
+    if (hash == -1)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    // Close any results so the next cursor starts with a clean statement.  The caller has already reset the
+    // parameters.
+
+    HSTMT hstmt = cur->hstmt;
+    Py_BEGIN_ALLOW_THREADS
+    SQLFreeStmt(hstmt, SQL_CLOSE);
+    Py_END_ALLOW_THREADS
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE || cnxn->stmtcache_capacity == 0)
+        return false;
+
+    CachedStatement evicted;
+    bool fEvicted = false;
+
+    if (cnxn->stmtcache_count == cnxn->stmtcache_capacity)
+    {
+        evicted  = cnxn->stmtcache[0];
+        fEvicted = true;
+        RemoveEntry(cnxn, 0);
+    }
+
+    CachedStatement& entry = cnxn->stmtcache[cnxn->stmtcache_count++];
+    entry.pPreparedSQL = cur->pPreparedSQL;
+    entry.hash         = hash;
+    entry.hstmt        = cur->hstmt;
+    entry.paramcount   = cur->paramcount;
+    entry.paramtypes   = cur->paramtypes;
+
+    cur->pPreparedSQL = 0;
+    cur->hstmt        = SQL_NULL_HANDLE;
+    cur->paramcount   = 0;
+    cur->paramtypes   = 0;
+
+    if (fEvicted)
+        FreeEntry(cnxn, evicted);
+
+    return true;
+}
+
+bool StatementCache_Release(Cursor* cur)
+{
+    Connection* cnxn = cur->cnxn;
+
+    if (cnxn->stmtcache_capacity == 0 || cur->pPreparedSQL == 0)
+        return true;
+
+    HSTMT hstmtNew;
+    if (!AllocStatementHandle(cnxn, hstmtNew))
+        return false;
+
+    CopyNoScan(cur->hstmt, hstmtNew);
+
+    if (!StatementCache_Checkin(cur))
+    {
+        FreeStatementHandle(cnxn, hstmtNew);
+        return true;
+    }
+
+    cur->hstmt = hstmtNew;
+    return true;
+}
+
+bool StatementCache_Prepare(Cursor* cur, PyObject* pSql, bool& fPrepared)
+{
+    fPrepared = false;
+
+    Connection* cnxn = cur->cnxn;
+
+    if (cnxn->stmtcache_capacity == 0)
+        return true;
+
+    Py_hash_t hash = PyObject_Hash(pSql);
+    if (hash == -1)
+        return false;
+
+    int i = FindEntry(cnxn, pSql, hash);
+
+    if (i == -1)
+    {
+        // Park the cursor's current statement, if any, and let the caller prepare the new SQL.
+        cnxn->stmtcache_misses++;
+        return StatementCache_Release(cur);
+    }
+
+    cnxn->stmtcache_hits++;
+
+    CachedStatement entry = cnxn->stmtcache[i];
+    RemoveEntry(cnxn, i);
+
+    CopyNoScan(cur->hstmt, entry.hstmt);
+
+    if (!StatementCache_Checkin(cur))
+    {
+        // The cursor's handle has nothing worth caching.
+        HSTMT hstmt = cur->hstmt;
+        cur->hstmt = SQL_NULL_HANDLE;
+        FreeParameterInfo(cur);
+        FreeStatementHandle(cnxn, hstmt);
+    }
+
+    cur->hstmt        = entry.hstmt;
+    cur->paramcount   = entry.paramcount;
+    cur->paramtypes   = entry.paramtypes;
+    cur->pPreparedSQL = pSql;
+    Py_INCREF(pSql);
+    Py_DECREF(entry.pPreparedSQL);
+
+    TRACE("stmtcache: hit cursor=%p hstmt=%p\n", cur, cur->hstmt);
+
+    fPrepared = true;
+    return true;
+}
+
+bool StatementCache_Resize(Connection* cnxn, int capacity)
+{
+    CachedStatement* stmtcache = 0;
+
+    if (capacity > 0)
+    {
+        stmtcache = (CachedStatement*)pyodbc_malloc(sizeof(CachedStatement) * capacity);
+        if (!stmtcache)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+    }
+
+    // Keep the most recently used statements that fit and free the rest once the new array is in place.
+
+    CachedStatement* old   = cnxn->stmtcache;
+    int              count = cnxn->stmtcache_count;
+    int              keep  = min(count, capacity);
+
+    if (keep)
+        memcpy(stmtcache, &old[count - keep], sizeof(CachedStatement) * keep);
+
+    cnxn->stmtcache          = stmtcache;
+    cnxn->stmtcache_count    = keep;
+    cnxn->stmtcache_capacity = capacity;
+
+    for (int i = 0; i < count - keep; i++)
+        FreeEntry(cnxn, old[i]);
+
+    pyodbc_free(old);
+
+    return true;
+}
+
+void StatementCache_Clear(Connection* cnxn)
+{
+    CachedStatement* old   = cnxn->stmtcache;
+    int              count = cnxn->stmtcache_count;
+
+    cnxn->stmtcache       = 0;
+    cnxn->stmtcache_count = 0;
+
+    for (int i = 0; i < count; i++)
+        FreeEntry(cnxn, old[i]);
+
+    pyodbc_free(old);
+}
@@ -0,0 +1,110 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef STMTCACHE_H
+#define STMTCACHE_H
+
+struct Connection;
+struct Cursor;
+
+// A prepared statement that is not being used by a cursor.  The fields mirror the Cursor fields of the same names and
+// are moved back into a cursor when it executes the same SQL.
+struct CachedStatement
+{
+    // The SQL the statement was prepared from.  Entries are matched by hash and then by value, so an equal string in
+    // a different object will find it.
+    PyObject* pPreparedSQL;
+    Py_hash_t hash;
+
+    HSTMT hstmt;
+
+    int paramcount;
+    SQLSMALLINT* paramtypes;
+};
+
+// The default Connection.statement_cache_size.  The cache is off unless enabled, since cached statements hold server
+// resources and some databases reject a prepared statement after the tables it uses change.
+#define DEFAULT_STATEMENT_CACHE_SIZE 0
+
+// The default Connection.statement_handle_pool_size.
+#define DEFAULT_HANDLE_POOL_SIZE 8
+
+/*
+ * Returns a statement handle from the connection's pool or allocates a new one with the connection's statement
+ * attributes (the query timeout).  If unable to, an exception is set and false is returned.
+ */
+bool AllocStatementHandle(Connection* cnxn, HSTMT& hstmt);
+
+/*
+ * Resets a statement handle that is no longer used and returns it to the connection's pool, or frees it if the pool is
+ * full.  Does nothing if the connection has been closed, since that freed the handle.
+ */
+void FreeStatementHandle(Connection* cnxn, HSTMT hstmt);
+
+/*
+ * Returns true if the two SQL objects contain the same SQL.  Unlike Prepare's pointer comparison, this finds equal
+ * strings held by different objects.
+ */
+bool IsSameSQL(PyObject* pSql1, PyObject* pSql2);
+
+/*
+ * Called before `cur` prepares `pSql`.  If the connection has a statement prepared from the same SQL, it is swapped
+ * into the cursor (along with its parameter count and types) and fPrepared is set to true.  Otherwise the cursor's
+ * current prepared statement, if any, is moved into the cache, the cursor is given a fresh statement handle, and
+ * fPrepared is false so the caller must prepare it.
+ *
+ * The caller must have freed the cursor's parameter bindings.  If an error occurs, an exception is set and false is
+ * returned.
+ */
+bool StatementCache_Prepare(Cursor* cur, PyObject* pSql, bool& fPrepared);
+
+/*
+ * Moves the cursor's prepared statement, if any, into the connection's cache and gives the cursor a fresh statement
+ * handle.  Called before the cursor's handle is used to execute SQL that is not prepared.  The caller must have freed
+ * the cursor's parameter bindings.  If an error occurs, an exception is set and false is returned.
+ */
+bool StatementCache_Release(Cursor* cur);
+
+/*
+ * Moves the cursor's prepared statement into the connection's cache, leaving the cursor without a statement handle.
+ * Returns false, leaving the cursor unchanged, if the cursor has no prepared statement or the cache is disabled.
+ */
+bool StatementCache_Checkin(Cursor* cur);
+
+/*
+ * Changes the number of statements the connection keeps, freeing the least recently used ones that no longer fit.
+ * Zero disables the cache.
+ */
+bool StatementCache_Resize(Connection* cnxn, int capacity);
+
+/*
+ * Frees every cached statement.  Called when the connection is closed.
+ */
+void StatementCache_Clear(Connection* cnxn);
+
+/*
+ * Changes the number of free statement handles the connection keeps, freeing those that no longer fit.  Zero disables
+ * the pool.
+ */
+bool HandlePool_Resize(Connection* cnxn, int capacity);
+
+/*
+ * Frees the pooled handles but keeps the pool's capacity.  Called when the connection's statement attributes change,
+ * since the pooled handles were allocated with the old ones.
+ */
+void HandlePool_Empty(Connection* cnxn);
+
+/*
+ * Frees the pooled handles and the pool.  Called when the connection is closed.
+ */
+void HandlePool_Clear(Connection* cnxn);
+
+#endif // STMTCACHE_H
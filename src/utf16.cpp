@@ -0,0 +1,268 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Vectorized loops for converting wide character data.  Every text column fetched as SQL_C_WCHAR goes through
+// UTF16_Scan and usually UTF16_Narrow, so these are worth the extra code.
+//
+// SSE2 is always available on x86-64, so those versions are compiled normally.  The AVX2 versions are compiled with
+// the target attribute (MSVC allows the intrinsics without it) and only used if the CPU and OS support them, so the
+// module still runs on older machines without special compiler flags.
+
+#include "pyodbc.h"
+#include "utf16.h"
+
+#if PY_VERSION_HEX >= 0x03030000
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UTF16_X86 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_M_X64) && defined(_MSC_VER)
+#define UTF16_X86 1
+#include <intrin.h>
+#include <immintrin.h>
+#define TARGET_AVX2
+#endif
+
+// The plain versions, also used for the tail of each buffer by the vector versions.
+
+static void ScanScalar(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates)
+{
+    Py_UCS2 acc = bits;
+    bool    sur = surrogates;
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        acc |= p[i];
+        sur |= (p[i] & 0xF800) == 0xD800;
+    }
+    bits       = acc;
+    surrogates = sur;
+}
+
+static void NarrowScalar(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest)
+{
+    for (Py_ssize_t i = 0; i < cch; i++)
+        dest[i] = (Py_UCS1)src[i];
+}
+
+static void WidenScalar(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest)
+{
+    for (Py_ssize_t i = 0; i < cch; i++)
+        dest[i] = src[i];
+}
+
+#ifdef UTF16_X86
+
+static void ScanSSE2(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates)
+{
+    const __m128i mask = _mm_set1_epi16((short)0xF800);
+    const __m128i lead = _mm_set1_epi16((short)0xD800);
+
+    __m128i acc = _mm_setzero_si128();
+    __m128i sur = _mm_setzero_si128();
+
+    Py_ssize_t i = 0;
+    for (; i + 8 <= cch; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        acc = _mm_or_si128(acc, v);
+        sur = _mm_or_si128(sur, _mm_cmpeq_epi16(_mm_and_si128(v, mask), lead));
+    }
+
+    Py_UCS2 lanes[8];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    bits = 0;
+    for (int j = 0; j < 8; j++)
+        bits |= lanes[j];
+    surrogates = _mm_movemask_epi8(sur) != 0;
+
+    ScanScalar(p + i, cch - i, bits, surrogates);
+}
+
+static void NarrowSSE2(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest)
+{
+    // packus saturates, but every code unit is already below 0x100.
+
+    Py_ssize_t i = 0;
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_packus_epi16(a, b));
+    }
+
+    NarrowScalar(src + i, cch - i, dest + i);
+}
+
+static void WidenSSE2(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    Py_ssize_t i = 0;
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dest + i),     _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i*)(dest + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+
+    WidenScalar(src + i, cch - i, dest + i);
+}
+
+TARGET_AVX2 static void ScanAVX2(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates)
+{
+    const __m256i mask = _mm256_set1_epi16((short)0xF800);
+    const __m256i lead = _mm256_set1_epi16((short)0xD800);
+
+    __m256i acc = _mm256_setzero_si256();
+    __m256i sur = _mm256_setzero_si256();
+
+    Py_ssize_t i = 0;
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        acc = _mm256_or_si256(acc, v);
+        sur = _mm256_or_si256(sur, _mm256_cmpeq_epi16(_mm256_and_si256(v, mask), lead));
+    }
+
+    Py_UCS2 lanes[16];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    bits = 0;
+    for (int j = 0; j < 16; j++)
+        bits |= lanes[j];
+    surrogates = _mm256_movemask_epi8(sur) != 0;
+
+    ScanScalar(p + i, cch - i, bits, surrogates);
+}
+
+TARGET_AVX2 static void NarrowAVX2(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest)
+{
+    // The 256-bit pack works on each 128-bit half separately, leaving the quarters in the order a0 b0 a1 b1, so the
+    // middle two are swapped back.
+
+    Py_ssize_t i = 0;
+    for (; i + 32 <= cch; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 16));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dest + i), packed);
+    }
+
+    NarrowScalar(src + i, cch - i, dest + i);
+}
+
+TARGET_AVX2 static void WidenAVX2(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest)
+{
+    Py_ssize_t i = 0;
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_cvtepu8_epi16(v));
+    }
+
+    WidenScalar(src + i, cch - i, dest + i);
+}
+
+static bool HasAVX2()
+{
+#ifdef _MSC_VER
+    // AVX2 needs the CPU feature (leaf 7, EBX bit 5) and the OS saving the YMM registers (OSXSAVE, then XCR0 bits 1
+    // and 2).
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // The GCC and clang builtins check the OS support too.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // UTF16_X86
+
+// The implementations are chosen by the first call to any of them.  This is always made while holding the GIL.
+
+static void ScanFirst(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates);
+static void NarrowFirst(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest);
+static void WidenFirst(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest);
+
+static void (*pfnScan)(const Py_UCS2*, Py_ssize_t, Py_UCS2&, bool&) = ScanFirst;
+static void (*pfnNarrow)(const Py_UCS2*, Py_ssize_t, Py_UCS1*)      = NarrowFirst;
+static void (*pfnWiden)(const Py_UCS1*, Py_ssize_t, Py_UCS2*)       = WidenFirst;
+
+static void ChooseImplementations()
+{
+#ifdef UTF16_X86
+    if (HasAVX2())
+    {
+        TRACE("utf16: using AVX2\n");
+        pfnScan   = ScanAVX2;
+        pfnNarrow = NarrowAVX2;
+        pfnWiden  = WidenAVX2;
+    }
+    else
+    {
+        pfnScan   = ScanSSE2;
+        pfnNarrow = NarrowSSE2;
+        pfnWiden  = WidenSSE2;
+    }
+#else
+    pfnScan   = ScanScalar;
+    pfnNarrow = NarrowScalar;
+    pfnWiden  = WidenScalar;
+#endif
+}
+
+static void ScanFirst(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates)
+{
+    ChooseImplementations();
+    pfnScan(p, cch, bits, surrogates);
+}
+
+static void NarrowFirst(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest)
+{
+    ChooseImplementations();
+    pfnNarrow(src, cch, dest);
+}
+
+static void WidenFirst(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest)
+{
+    ChooseImplementations();
+    pfnWiden(src, cch, dest);
+}
+
+void UTF16_Scan(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates)
+{
+    bits       = 0;
+    surrogates = false;
+    pfnScan(p, cch, bits, surrogates);
+}
+
+void UTF16_Narrow(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest)
+{
+    pfnNarrow(src, cch, dest);
+}
+
+void UTF16_Widen(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest)
+{
+    pfnWiden(src, cch, dest);
+}
+
+#endif // PY_VERSION_HEX >= 0x03030000
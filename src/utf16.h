@@ -0,0 +1,38 @@
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+// OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef UTF16_H
+#define UTF16_H
+
+#if PY_VERSION_HEX >= 0x03030000
+
+// Loops over UTF-16 code units used to move wide character data between ODBC buffers and PEP 393 strings.  Each has
+// SSE2 and AVX2 versions on x86-64, chosen the first time one is called, and a plain version for everything else.
+
+/*
+ * Scans `cch` code units.  `bits` is set to all of the code units OR'ed together, so it is below 0x80 if the text is
+ * ASCII and below 0x100 if it is latin-1.  `surrogates` is set to true if any code unit is half of a surrogate pair.
+ */
+void UTF16_Scan(const Py_UCS2* p, Py_ssize_t cch, Py_UCS2& bits, bool& surrogates);
+
+/*
+ * Copies `cch` code units, all of which must be below 0x100, to 1-byte characters.
+ */
+void UTF16_Narrow(const Py_UCS2* src, Py_ssize_t cch, Py_UCS1* dest);
+
+/*
+ * Copies `cch` 1-byte characters to code units.
+ */
+void UTF16_Widen(const Py_UCS1* src, Py_ssize_t cch, Py_UCS2* dest);
+
+#endif
+
+#endif // UTF16_H
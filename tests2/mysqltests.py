@@ -665,6 +665,24 @@ class MySqlTestCase(unittest.TestCase):
         self.assertEquals(r[0], 'nyan nyan nyan')
         self.assertEquals(r[1], 42)
 
+    def test_procedure_reuse(self):
+        self.cursor.execute('''
+                            create procedure proc1(out a varchar(30), inout b integer)
+                            begin
+                                select 'nyan nyan nyan' into a;
+                                select (b+1) into b;
+                            end
+                            ''')
+        self.cnxn.commit()
+        proc = self.cnxn.procedure('proc1', (pyodbc.SQLParameter('', pyodbc.SQL_PARAM_OUTPUT),
+                                             pyodbc.SQLParameter(0, pyodbc.SQL_PARAM_INPUT_OUTPUT)))
+        self.assertEquals(proc(41), ('nyan nyan nyan', 42))
+        self.assertEquals(proc(1), ('nyan nyan nyan', 2))
+
+        # Using the cursor for something else forces the call to be bound again.
+        proc.cursor.execute("select 1")
+        self.assertEquals(proc(2), ('nyan nyan nyan', 3))
+
     def test_callproc_output_truncate_str(self):
         self.cursor.execute('''
                             create procedure proc1(out a varchar(30), inout b integer)
@@ -795,6 +813,19 @@ class MySqlTestCase(unittest.TestCase):
         r = self.cursor.callproc('proc1', s)
         self.assertEquals(r[0], u'\u4f60\u662f\u75af\u513f\u6211\u662f\u50bb')
 
+    def test_callproc_output_stream(self):
+        # MySQL drivers don't stream output parameters, so this exercises the bound buffer fallback.
+        self.cursor.execute('''
+                            create procedure proc1(out a varchar(30))
+                            begin
+                                select 'nyan nyan nyan' into a;
+                            end
+                            ''')
+        self.cnxn.commit()
+        s = pyodbc.SQLParameter('', pyodbc.SQL_PARAM_OUTPUT_STREAM)
+        r = self.cursor.callproc('proc1', s)
+        self.assertEquals(r[0], 'nyan nyan nyan')
+
 
 def main():
     from optparse import OptionParser
@@ -996,6 +996,79 @@ class SqlServerTestCase(unittest.TestCase):
             self.assertEqual(param[1], row[1])
         
 
+    def test_executemany_rebind(self):
+        "Types and sizes that change between rows are rebound"
+        self.cursor.execute("create table t1(id int identity(1, 1), a int, b varchar(100), c float)")
+
+        params = [ (1, "a", 1.5),
+                   (None, "a much longer string than the first one", None),
+                   (3, None, 2.5),
+                   (4, "x", 3) ]
+
+        self.cursor.executemany("insert into t1(a, b, c) values (?,?,?)", params)
+
+        self.cursor.execute("select a, b, c from t1 order by id")
+        rows = self.cursor.fetchall()
+        self.assertEqual(len(rows), len(params))
+
+        for param, row in zip(params, rows):
+            self.assertEqual(param[0], row[0])
+            self.assertEqual(param[1], row[1])
+            self.assertEqual(param[2], row[2])
+
+
+    def test_null_param_new_cursors(self):
+        "NULL parameters described by one cursor are bound with the right types by others"
+        self.cursor.execute("create table t1(a varbinary(10), b int, c varchar(10))")
+        sql = "insert into t1(a, b, c) values (?,?,?)"
+        for i in range(3):
+            cursor = self.cnxn.cursor()
+            cursor.execute(sql, None, None, None)
+            cursor.close()
+        self.assertEqual(self.cursor.execute("select count(*) from t1 where a is null and b is null").fetchone()[0], 3)
+
+    def test_param_arena_reuse(self):
+        "Executing the same statement again doesn't need more parameter memory"
+        self.cursor.execute("create table t1(a int, b varchar(100))")
+        sql = "insert into t1(a, b) values (?,?)"
+        for i in range(100):
+            self.cursor.execute(sql, i, "x" * i)
+        used, highwater, capacity = self.cursor.param_arena_info()
+        self.assertTrue(highwater >= used)
+
+        for i in range(100):
+            self.cursor.execute(sql, i, "x" * i)
+        self.assertEqual(self.cursor.param_arena_info()[2], capacity)
+
+    def test_statement_cache(self):
+        "Prepared statements are reused by other cursors and after switching SQL"
+        self.cursor.execute("create table t1(a int, b varchar(20))")
+        self.cnxn.statement_cache_size = 4
+        self.assertEqual(self.cnxn.statement_cache_size, 4)
+
+        insert = "insert into t1(a, b) values (?,?)"
+        select = "select b from t1 where a = ?"
+
+        for i in range(3):
+            self.cursor.execute(insert, i, str(i))
+            self.assertEqual(self.cursor.execute(select, i).fetchone()[0], str(i))
+
+        # A new cursor, and an equal string in a different object, still find the statement.  Closing the cursor
+        # returns it to the cache.
+        cursor = self.cnxn.cursor()
+        cursor.execute("".join(list(insert)), 3, "3")
+        cursor.close()
+        self.cursor.execute(insert, 4, "4")
+        self.assertEqual(self.cursor.execute("select count(*) from t1").fetchone()[0], 5)
+
+        hits, misses, maxsize, currsize = self.cnxn.statement_cache_info()
+        self.assertEqual((hits, misses, maxsize, currsize), (6, 2, 4, 2))
+
+        self.cnxn.statement_cache_size = 0
+        hits, misses, maxsize, currsize = self.cnxn.statement_cache_info()
+        self.assertEqual((maxsize, currsize), (0, 0))
+        self.assertEqual(self.cursor.execute(select, 1).fetchone()[0], "1")
+
     def test_executemany_failure(self):
         """
         Ensure that an exception is raised if one query in an executemany fails.
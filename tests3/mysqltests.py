@@ -244,6 +244,19 @@ class MySqlTestCase(unittest.TestCase):
     def test_unicode_query(self):
         self.cursor.execute(u"select 1")
 
+    def test_encoding_utf8(self):
+        "Text is exchanged as UTF-8 SQL_C_CHAR when an encoding is passed to connect"
+        cnxn = pyodbc.connect(self.connection_string, encoding='utf-8')
+        self.assertEqual(cnxn.encoding, 'utf-8')
+        cursor = cnxn.cursor()
+        values = ['abc', '\xe9t\xe9', '\u4e2d\u6587', 'x' * 1000]
+        cursor.execute("create table t1(id int, s varchar(1000)) character set utf8")
+        for i, value in enumerate(values):
+            cursor.execute("insert into t1 values (?,?)", i, value)
+        rows = cursor.execute("select s from t1 where s <> '\u00ff' order by id").fetchall()
+        self.assertEqual([row.s for row in rows], values)
+        cnxn.close()
+
     #
     # bit
     #
@@ -335,6 +335,43 @@ class PGTestCase(unittest.TestCase):
         self.failUnlessRaises(pyodbc.Error, self.cursor.executemany, "insert into t1(a, b) value (?, ?)", params)
 
         
+    def test_fast_executemany(self):
+        self.cursor.execute("create table t1(a int, b varchar(10))")
+
+        # More rows than one batch, with NULLs mixed in.
+        params = [ (i, (i % 3) and str(i) or None) for i in range(2500) ]
+
+        self.cursor.fast_executemany = True
+        self.cursor.executemany("insert into t1(a, b) values (?,?)", params)
+
+        self.cursor.execute("select a, b from t1 order by a")
+        rows = self.cursor.fetchall()
+        self.assertEqual(len(rows), len(params))
+
+        for param, row in zip(params, rows):
+            self.assertEqual(param[0], row[0])
+            self.assertEqual(param[1], row[1])
+
+
+    def test_fast_executemany_generator(self):
+        self.cursor.execute("create table t1(a int)")
+
+        self.cursor.fast_executemany = True
+        self.cursor.executemany("insert into t1(a) values (?)", ((i,) for i in range(1500)))
+
+        row = self.cursor.execute("select cast(count(*) as int) c, min(a) mina, max(a) maxa from t1").fetchone()
+        self.assertEqual(row.c, 1500)
+        self.assertEqual(row.mina, 0)
+        self.assertEqual(row.maxa, 1499)
+
+
+    def test_fast_executemany_failure(self):
+        self.cursor.execute("create table t1(a int primary key)")
+
+        self.cursor.fast_executemany = True
+        self.failUnlessRaises(pyodbc.Error, self.cursor.executemany, "insert into t1(a) values (?)", [ (1,), (2,), (1,) ])
+
+
     def test_row_slicing(self):
         self.cursor.execute("create table t1(a int, b int, c int, d int)");
         self.cursor.execute("insert into t1 values(1,2,3,4)")
@@ -288,6 +288,24 @@ class SqlServerTestCase(unittest.TestCase):
     for value in STR_FENCEPOSTS:
         locals()['test_unicode_%s' % len(value)] = _maketest(value)
 
+    def test_unicode_kinds(self):
+        "Strings stored with 1, 2, and 4 bytes per character are all bound correctly"
+        values = ['abc', '\xe9t\xe9', '\u0101\u4e2d']
+        self.cursor.execute("create table t1(id int, s nvarchar(20))")
+        for i, value in enumerate(values):
+            self.cursor.execute("insert into t1 values (?,?)", i, value)
+        rows = self.cursor.execute("select s from t1 order by id").fetchall()
+        self.assertEqual([row.s for row in rows], values)
+
+    def test_unicode_fetch_kinds(self):
+        "Fetched text is returned with the smallest string kind, and surrogate pairs are combined"
+        values = ['x' * 100, '\xe9' * 100, '\u4e2d' * 100, 'a\U0001f600' * 50]
+        self.cursor.execute("create table t1(id int, s nvarchar(200))")
+        for i, value in enumerate(values):
+            self.cursor.execute("insert into t1 values (?,?)", i, value)
+        rows = self.cursor.execute("select s from t1 order by id").fetchall()
+        self.assertEqual([row.s for row in rows], values)
+
     def test_unicode_longmax(self):
         # Issue 188:	Segfault when fetching NVARCHAR(MAX) data over 511 bytes
 
@@ -346,6 +364,43 @@ class SqlServerTestCase(unittest.TestCase):
     for value in IMAGE_FENCEPOSTS:
         locals()['test_image_bytes_%s' % len(value)] = _maketest(value)
 
+    def test_image_stream_file(self):
+        "A file-like object is streamed into the parameter in stream_chunk_size pieces"
+        import io
+        value = bytes(range(256)) * 1000
+        self.cnxn.stream_chunk_size = 4096
+        self.cursor.execute("create table t1(b image)")
+        self.cursor.execute("insert into t1 values (?)", io.BytesIO(value))
+        v = self.cursor.execute("select b from t1").fetchone()[0]
+        self.assertEqual(bytes(v), value)
+
+    def test_image_stream_iterator(self):
+        "An iterator of bytes chunks is streamed into the parameter"
+        chunks = [b'abc' * 1000, bytearray(b'def' * 10), b'', b'ghi']
+        self.cursor.execute("create table t1(b image)")
+        self.cursor.execute("insert into t1 values (?)", iter(chunks))
+        v = self.cursor.execute("select b from t1").fetchone()[0]
+        self.assertEqual(bytes(v), b''.join(chunks))
+
+    def test_varbinary_memoryview(self):
+        "A memoryview is bound in place and released after the execute"
+        data = bytearray(b'abcdef' * 10)
+        self.cursor.execute("create table t1(b varbinary(100))")
+        self.cursor.execute("insert into t1 values (?)", memoryview(data))
+        data.extend(b'xyz')     # BufferError if the view were still held
+        self.cursor.execute("insert into t1 values (?)", memoryview(data)[3:9])
+        rows = [bytes(row[0]) for row in self.cursor.execute("select b from t1").fetchall()]
+        self.assertEqual(sorted(rows), sorted([b'abcdef' * 10, b'defabc']))
+
+    def test_image_memoryview(self):
+        "A buffer larger than binary_maxlength is sent as data-at-execution"
+        import array
+        value = array.array('B', range(256)) * 40
+        self.cursor.execute("create table t1(b image)")
+        self.cursor.execute("insert into t1 values (?)", value)
+        v = self.cursor.execute("select b from t1").fetchone()[0]
+        self.assertEqual(bytes(v), value.tobytes())
+
     #
     # text
     #
@@ -422,6 +477,35 @@ class SqlServerTestCase(unittest.TestCase):
         result = self.cursor.execute("select * from t1").fetchone()[0]
         self.assertEqual(result, value)
 
+    def test_numeric_struct(self):
+        """Ensure Decimals and large ints bound as SQL_NUMERIC_STRUCTs keep their scale, and as strings when disabled"""
+        self.cursor.execute("create table t1(d decimal(38, 4))")
+        values = [ Decimal('1.5'), Decimal('-12345.6789'), Decimal('0.0001'), 2**70, None ]
+        for numeric_struct in (True, False):
+            self.cnxn.numeric_struct = numeric_struct
+            self.cursor.execute("delete from t1")
+            for value in values:
+                self.cursor.execute("insert into t1 values (?)", value)
+            self.cursor.fast_executemany = True
+            self.cursor.executemany("insert into t1 values (?)", [ (v,) for v in values ])
+            self.cursor.fast_executemany = False
+            rows = [ row[0] for row in self.cursor.execute("select d from t1") ]
+            self.assertEqual(rows, values + values)
+
+            # Too many digits once the exponent is applied, so this must not be bound as a (wrapped) NUMERIC.
+            self.assertRaises(pyodbc.DataError, self.cursor.execute, "insert into t1 values (?)", Decimal('99E38'))
+
+            # A large int after a small one can't reuse the small one's BIGINT binding, whether executed again or in
+            # the same fast_executemany column.
+            self.cursor.execute("delete from t1")
+            self.cursor.execute("insert into t1 values (?)", 1)
+            self.cursor.execute("insert into t1 values (?)", 2**70)
+            self.cursor.fast_executemany = True
+            self.cursor.executemany("insert into t1 values (?)", [ (1,), (2**70,) ])
+            self.cursor.fast_executemany = False
+            rows = [ row[0] for row in self.cursor.execute("select d from t1") ]
+            self.assertEqual(sorted(rows), [ 1, 1, 2**70, 2**70 ])
+
     def test_subquery_params(self):
         """Ensure parameter markers work in a subquery"""
         self.cursor.execute("create table t1(id integer, s varchar(20))")
@@ -881,6 +965,23 @@ class SqlServerTestCase(unittest.TestCase):
             self.assertEqual(param[1], row[1])
 
 
+    def test_executemany_param_memo(self):
+        self.cursor.execute("create table t1(a int, b varchar(10), c datetime)")
+
+        tenants = [ 'tenant' + str(i % 3) for i in range(30) ]  # separate but equal objects
+        batch = datetime(2020, 1, 2, 3, 4, 5)
+        params = [ (i, tenants[i], batch) for i in range(30) ]
+
+        self.cursor.fast_executemany = True
+        self.cursor.param_memo = True
+        self.cursor.executemany("insert into t1(a, b, c) values (?,?,?)", params)
+
+        # 3 distinct strings and 1 datetime are converted; the other 56 values are copied.
+        self.assertEqual(self.cursor.param_memo_info(), (56, 4))
+
+        rows = self.cursor.execute("select a, b, c from t1 order by a").fetchall()
+        self.assertEqual([ tuple(row) for row in rows ], params)
+
     def test_executemany_one(self):
         "Pass executemany a single sequence"
         self.cursor.execute("create table t1(a int, b varchar(10))")
@@ -901,6 +1002,98 @@ class SqlServerTestCase(unittest.TestCase):
             self.assertEqual(param[1], row[1])
         
 
+    def test_executemany_rebind(self):
+        "Types and sizes that change between rows are rebound"
+        self.cursor.execute("create table t1(id int identity(1, 1), a int, b varchar(100), c float)")
+
+        params = [ (1, "a", 1.5),
+                   (None, "a much longer string than the first one", None),
+                   (3, None, 2.5),
+                   (4, "x", 3) ]
+
+        self.cursor.executemany("insert into t1(a, b, c) values (?,?,?)", params)
+
+        self.cursor.execute("select a, b, c from t1 order by id")
+        rows = self.cursor.fetchall()
+        self.assertEqual(len(rows), len(params))
+
+        for param, row in zip(params, rows):
+            self.assertEqual(param[0], row[0])
+            self.assertEqual(param[1], row[1])
+            self.assertEqual(param[2], row[2])
+
+
+    def test_null_param_new_cursors(self):
+        "NULL parameters described by one cursor are bound with the right types by others"
+        self.cursor.execute("create table t1(a varbinary(10), b int, c varchar(10))")
+        sql = "insert into t1(a, b, c) values (?,?,?)"
+        for i in range(3):
+            cursor = self.cnxn.cursor()
+            cursor.execute(sql, None, None, None)
+            cursor.close()
+        self.assertEqual(self.cursor.execute("select count(*) from t1 where a is null and b is null").fetchone()[0], 3)
+
+    def test_param_arena_reuse(self):
+        "Executing the same statement again doesn't need more parameter memory"
+        self.cursor.execute("create table t1(a int, b varchar(100))")
+        sql = "insert into t1(a, b) values (?,?)"
+        for i in range(100):
+            self.cursor.execute(sql, i, "x" * i)
+        used, highwater, capacity = self.cursor.param_arena_info()
+        self.assertTrue(highwater > 0)
+
+        # The arena is reused by each execute, so running the statements again doesn't grow it.
+        for i in range(100):
+            self.cursor.execute(sql, i, "x" * i)
+            self.assertEqual(self.cursor.param_arena_info()[2], capacity)
+
+    def test_statement_cache(self):
+        "Prepared statements are reused by other cursors and after switching SQL"
+        self.cursor.execute("create table t1(a int, b varchar(20))")
+        self.cnxn.statement_cache_size = 4
+        self.assertEqual(self.cnxn.statement_cache_size, 4)
+
+        insert = "insert into t1(a, b) values (?,?)"
+        select = "select b from t1 where a = ?"
+
+        for i in range(3):
+            self.cursor.execute(insert, i, str(i))
+            self.assertEqual(self.cursor.execute(select, i).fetchone()[0], str(i))
+
+        # A new cursor, and an equal string in a different object, still find the statement.  Closing the cursor
+        # returns it to the cache.
+        cursor = self.cnxn.cursor()
+        cursor.execute("".join(list(insert)), 3, "3")
+        cursor.close()
+        self.cursor.execute(insert, 4, "4")
+        self.assertEqual(self.cursor.execute("select count(*) from t1").fetchone()[0], 5)
+
+        hits, misses, maxsize, currsize = self.cnxn.statement_cache_info()
+        self.assertEqual((hits, misses, maxsize, currsize), (6, 2, 4, 2))
+
+        self.cnxn.statement_cache_size = 0
+        hits, misses, maxsize, currsize = self.cnxn.statement_cache_info()
+        self.assertEqual((maxsize, currsize), (0, 0))
+        self.assertEqual(self.cursor.execute(select, 1).fetchone()[0], "1")
+
+    def test_statement_handle_pool(self):
+        "Cursors reuse the statement handles of closed cursors"
+        self.assertEqual(self.cnxn.statement_handle_pool_size, 8)
+        self.cursor.execute("create table t1(a int)")
+        self.cursor.execute("insert into t1 values (1)")
+
+        # A closed cursor's handle must not carry its results, bindings, or parameters to the next cursor.
+        for i in range(20):
+            cursor = self.cnxn.cursor()
+            cursor.execute("select a + ? from t1", i)
+            cursor.close()
+            self.assertEqual(self.cnxn.execute("select a from t1").fetchone()[0], 1)
+
+        self.cnxn.statement_handle_pool_size = 0
+        self.assertEqual(self.cnxn.statement_handle_pool_size, 0)
+        self.assertEqual(self.cnxn.execute("select count(*) from t1").fetchone()[0], 1)
+        self.assertRaises(ValueError, setattr, self.cnxn, "statement_handle_pool_size", -1)
+
     def test_executemany_failure(self):
         """
         Ensure that an exception is raised if one query in an executemany fails.
@@ -913,6 +1106,70 @@ class SqlServerTestCase(unittest.TestCase):
         
         self.failUnlessRaises(pyodbc.Error, self.cursor.executemany, "insert into t1(a, b) value (?, ?)", params)
 
+    def test_executemany_columns(self):
+        "Columns in array.array buffers are inserted as parameter arrays, with a null mask"
+        import array
+        count = 2500            # more than one chunk
+        a = array.array('i', range(count))
+        b = array.array('d', [i / 2.0 for i in range(count)])
+        mask = bytes(i % 3 == 0 for i in range(count))
+        self.cursor.execute("create table t1(a int, b float)")
+        self.cursor.executemany_columns("insert into t1(a, b) values (?, ?)", [a, (b, mask)])
+        self.assertEqual(self.cursor.rowcount, count)
+        rows = self.cursor.execute("select a, b from t1 order by a").fetchall()
+        self.assertEqual([tuple(row) for row in rows],
+                         [(i, None if i % 3 == 0 else i / 2.0) for i in range(count)])
+
+    def test_executemany_columns_uint64(self):
+        "Unsigned 64-bit columns are sent as NUMERIC so values above the BIGINT range are not wrapped"
+        import array
+        values = [0, 2**63 - 1, 2**63, 2**64 - 1]
+        self.cursor.execute("create table t1(n int, v decimal(20))")
+        self.cursor.executemany_columns("insert into t1(n, v) values (?, ?)",
+                                        [array.array('i', range(len(values))), array.array('Q', values)])
+        rows = self.cursor.execute("select v from t1 order by n").fetchall()
+        self.assertEqual([row[0] for row in rows], [Decimal(v) for v in values])
+
+    def test_executemany_arrow(self):
+        "The batches of an Arrow stream are bound as parameter arrays"
+        try:
+            import pyarrow
+        except ImportError:
+            self.skipTest('pyarrow is not installed')
+        from datetime import timedelta
+        count = 2500
+        table = pyarrow.table({
+            'a': pyarrow.array(range(count), pyarrow.int32()),
+            'b': pyarrow.array([None if i % 4 == 0 else 'r\xe9sum\xe9 %d' % i for i in range(count)]),
+            'c': pyarrow.array([date(2000, 1, 1) + timedelta(days=i) for i in range(count)]),
+        })
+        self.cursor.execute("create table t1(a int, b nvarchar(20), c date)")
+        self.cursor.executemany_arrow("insert into t1(a, b, c) values (?, ?, ?)", table.to_reader(max_chunksize=700))
+        self.assertEqual(self.cursor.rowcount, count)
+        rows = self.cursor.execute("select a, b, c from t1 order by a").fetchall()
+        self.assertEqual([tuple(row) for row in rows],
+                         [(i, None if i % 4 == 0 else 'r\xe9sum\xe9 %d' % i, date(2000, 1, 1) + timedelta(days=i))
+                          for i in range(count)])
+
+    def test_executemany_arrow_long(self):
+        "A long value makes executemany_arrow bind fewer rows at a time rather than allocating them all at its length"
+        try:
+            import pyarrow
+        except ImportError:
+            self.skipTest('pyarrow is not installed')
+        count = 1000
+        big = b'\x01' * (5 * 1024 * 1024)
+        values = [big if i == 500 else b'\x02' for i in range(count)]
+        table = pyarrow.table({
+            'a': pyarrow.array(range(count), pyarrow.int32()),
+            'b': pyarrow.array(values, pyarrow.binary()),
+        })
+        self.cursor.execute("create table t1(a int, b varbinary(max))")
+        self.cursor.executemany_arrow("insert into t1(a, b) values (?, ?)", table)
+        self.assertEqual(self.cursor.rowcount, count)
+        rows = self.cursor.execute("select a, datalength(b) from t1 order by a").fetchall()
+        self.assertEqual([tuple(row) for row in rows], [(i, len(values[i])) for i in range(count)])
+
         
     def test_row_slicing(self):
         self.cursor.execute("create table t1(a int, b int, c int, d int)");
@@ -1023,6 +1280,86 @@ class SqlServerTestCase(unittest.TestCase):
         # for row in self.cursor:
         #     print row.s
 
+    def test_procedure_reuse(self):
+        "A Procedure binds its parameters once and is called repeatedly with new values"
+        self.cursor.execute("drop procedure if exists pyodbctest")
+        self.cursor.execute("""
+                            create procedure pyodbctest @a varchar(30) output, @b int output
+                            as
+                            begin
+                              set @a = 'nyan nyan nyan'
+                              set @b = @b + 1
+                            end
+                            """)
+        self.cnxn.commit()
+
+        proc = self.cnxn.procedure('pyodbctest', (pyodbc.SQLParameter('', pyodbc.SQL_PARAM_OUTPUT),
+                                                  pyodbc.SQLParameter(0, pyodbc.SQL_PARAM_INPUT_OUTPUT)))
+        self.assertEqual(proc(41), ('nyan nyan nyan', 42))
+        self.assertEqual(proc(1), ('nyan nyan nyan', 2))
+
+        # A NULL and then a value again.
+        self.assertEqual(proc(None), ('nyan nyan nyan', None))
+        self.assertEqual(proc(5), ('nyan nyan nyan', 6))
+
+        # Using the cursor for something else forces the call to be bound again.
+        proc.cursor.execute("select 1")
+        self.assertEqual(proc(2), ('nyan nyan nyan', 3))
+        self.cursor.execute("drop procedure pyodbctest")
+
+    def test_callproc_output_stream(self):
+        "Streamed output parameters are read with SQLGetData, so they aren't limited to a bound buffer"
+        if not hasattr(pyodbc, 'SQL_PARAM_OUTPUT_STREAM'):
+            self.skipTest('pyodbc was built without ODBC 3.8 headers')
+        major, minor = [int(part) for part in self.cnxn.getinfo(pyodbc.SQL_DRIVER_ODBC_VER).split('.')]
+        if (major, minor) < (3, 80):
+            self.skipTest('the driver does not support streamed output parameters')
+
+        self.cursor.execute("drop procedure if exists pyodbctest")
+        self.cursor.execute("""
+                            create procedure pyodbctest @s nvarchar(max) output, @b varbinary(max) output
+                            as
+                            begin
+                              set @s = replicate(cast(N'\u00e9' as nvarchar(max)), 300000)
+                              set @b = cast(replicate(cast('x' as varchar(max)), 300000) as varbinary(max))
+                            end
+                            """)
+        self.cnxn.commit()
+
+        s = pyodbc.SQLParameter('', pyodbc.SQL_PARAM_OUTPUT_STREAM)
+        b = pyodbc.SQLParameter(b'', pyodbc.SQL_PARAM_OUTPUT_STREAM)
+        r = self.cursor.callproc('pyodbctest', s, b)
+        self.assertEqual(r[0], '\u00e9' * 300000)
+        self.assertEqual(r[1], b'x' * 300000)
+        self.cursor.execute("drop procedure pyodbctest")
+
+    def test_callproc_return_value(self):
+        "callproc with return_value=True returns the procedure's RETURN value and the parameters"
+        self.cursor.execute("drop procedure if exists pyodbctest")
+        self.cursor.execute("""
+                            create procedure pyodbctest @a int, @b int output
+                            as
+                            begin
+                              set @b = @a + 1
+                              return @a * 10
+                            end
+                            """)
+        self.cnxn.commit()
+
+        b = pyodbc.SQLParameter(0, pyodbc.SQL_PARAM_OUTPUT)
+        status, params = self.cursor.callproc('pyodbctest', 4, b, return_value=True)
+        self.assertEqual(status, 40)
+        self.assertEqual(params, (4, 5))
+
+        # Without return_value only the parameters are returned.
+        self.assertEqual(self.cursor.callproc('pyodbctest', 7, b), (7, 8))
+
+        # Keywords are case sensitive, and the error names the one that isn't known.
+        with self.assertRaises(TypeError) as cm:
+            self.cursor.callproc('pyodbctest', 4, b, Return_Value=True)
+        self.assertIn('Return_Value', str(cm.exception))
+        self.cursor.execute("drop procedure pyodbctest")
+
     def test_skip(self):
         # Insert 1, 2, and 3.  Fetch 1, skip 2, fetch 3.
 
@@ -1154,6 +1491,222 @@ class SqlServerTestCase(unittest.TestCase):
         value = self.cursor.execute("select v from t1").fetchone()[0]
         self.assertEqual(value, '123.45')
 
+    def test_input_adapter(self):
+        import uuid
+
+        class Money(object):
+            def __init__(self, cents):
+                self.cents = cents
+
+        self.cursor.execute("create table t1(g uniqueidentifier, m decimal(10, 2))")
+
+        # UUIDs are bound natively.  Money is rejected until it has an adapter.
+        g = uuid.uuid4()
+        self.assertRaises(pyodbc.ProgrammingError, self.cursor.execute, "insert into t1 values (?, ?)", g, Money(150))
+
+        self.cnxn.add_input_adapter(Money, lambda m: Decimal(m.cents) / 100)
+        self.cursor.execute("insert into t1 values (?, ?)", g, Money(150))
+        row = self.cursor.execute("select g, m from t1").fetchone()
+        self.assertEqual(row[0].lower(), str(g))
+        self.assertEqual(row[1], Decimal('1.50'))
+
+        self.cnxn.clear_input_adapters()
+        self.assertRaises(pyodbc.ProgrammingError, self.cursor.execute, "insert into t1 values (?, ?)", g, Money(150))
+
+    def test_input_adapter_numpy(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest('numpy is not installed')
+        self.cursor.execute("create table t1(n bigint, f float, b bit)")
+        self.cursor.execute("insert into t1 values (?, ?, ?)", numpy.int64(2**40), numpy.float32(1.5), numpy.bool_(True))
+        row = self.cursor.execute("select n, f, b from t1").fetchone()
+        self.assertEqual(row[0], 2**40)
+        self.assertEqual(row[1], 1.5)
+        self.assertEqual(row[2], True)
+
+    def test_inlist(self):
+        self.cursor.execute("create table t1(n int)")
+        self.cursor.executemany("insert into t1 values (?)", [(i,) for i in range(10)])
+
+        sql = "select count(*) from t1 where n in (?) and n <> ?"
+        for values in ([1], [1, 2, 3], [5, 6, 7, 8, 9], list(range(10))):
+            count = self.cursor.execute(sql, pyodbc.InList(values), 5).fetchone()[0]
+            self.assertEqual(count, len([v for v in values if v != 5]))
+
+        # Padding with the last value keeps NOT IN correct.  Padding with NULL would match nothing.
+        count = self.cursor.execute("select count(*) from t1 where n not in (?)", pyodbc.InList([1, 2, 3])).fetchone()[0]
+        self.assertEqual(count, 7)
+        count = self.cursor.execute("select count(*) from t1 where n not in (?)",
+                                    pyodbc.InList([1, 2, 3], pad_with_null=True)).fetchone()[0]
+        self.assertEqual(count, 0)
+
+        # Markers in strings and comments are not parameters.
+        count = self.cursor.execute("select count(*) from t1 where '?' = '?' /* ? */ and n in (?)",
+                                    pyodbc.InList([1, 2])).fetchone()[0]
+        self.assertEqual(count, 2)
+
+        self.assertRaises(TypeError, pyodbc.InList, 'abc')
+
+        # No list of values is right for both IN and NOT IN when empty.
+        self.assertRaises(ValueError, pyodbc.InList, [])
+        self.assertRaises(ValueError, pyodbc.InList, ())
+
+    def test_auto_parameterize(self):
+        self.cursor.execute("create table t1(n int, d decimal(10, 2), s nvarchar(20))")
+        self.cnxn.auto_parameterize = True
+        self.assertEqual(self.cnxn.auto_parameterize, True)
+
+        for i in range(3):
+            self.cursor.execute("insert into t1 values (%d, %d.25, N'it''s %d')" % (i, i, i))
+
+        # Literals in comments, escapes, type lengths, TOP, and ORDER BY are left alone.
+        row = self.cursor.execute("""
+            select top 1 n, d, cast(s as varchar(10)), {fn ucase(N'x')} -- 7
+            from t1 where n = 2 and s like N'it''s%' /* 'x' */
+            order by 1 desc
+            """).fetchone()
+        self.assertEqual(row[0], 2)
+        self.assertEqual(row[1], Decimal('2.25'))
+        self.assertEqual(row[2], "it's 2")
+        self.assertEqual(row[3], 'X')
+
+        # SQL with a GROUP BY is left alone, since the grouped expressions must match the select list's.
+        rows = self.cursor.execute("select n % 2, count(*) from t1 group by n % 2 order by 1").fetchall()
+        self.assertEqual([tuple(row) for row in rows], [(0, 2), (1, 1)])
+
+        # Statements differing only in their literals are prepared once and then found in the statement cache.
+        self.cnxn.statement_cache_size = 4
+        for i in range(3):
+            self.cursor.execute("insert into t1 values (%d, %d.5, N'x')" % (10 + i, i))
+            self.assertEqual(self.cursor.execute("select n from t1 where n = %d" % (10 + i)).fetchone()[0], 10 + i)
+        hits, misses, maxsize, currsize = self.cnxn.statement_cache_info()
+        self.assertEqual((hits, misses), (4, 2))
+        self.cnxn.statement_cache_size = 0
+
+        self.cnxn.auto_parameterize = False
+
+    def test_auto_prepare(self):
+        self.cursor.execute("create table t1(n int)")
+        self.assertEqual(self.cnxn.auto_prepare_threshold, 0)
+        self.assertRaises(ValueError, setattr, self.cnxn, 'auto_prepare_threshold', -1)
+
+        self.cnxn.auto_prepare_threshold = 3
+        for i in range(6):
+            self.cursor.execute("insert into t1 values (1)")
+            self.assertEqual(self.cursor.rowcount, 1)
+            count = self.cursor.execute("select count(*) from t1").fetchone()[0]
+            self.assertEqual(count, i + 1)
+
+        # Below the threshold the statement is executed directly.  At the threshold it is prepared, which the
+        # statement cache counts as a miss, and after that the cursor reuses it without preparing again.
+        self.cnxn.statement_cache_size = 4
+        sql = "select count(*) from t1 where n = 1"
+        for i in range(5):
+            self.assertEqual(self.cursor.execute(sql).fetchone()[0], 6)
+            self.assertEqual(self.cnxn.statement_cache_info()[:2], (0, 0 if i < 2 else 1))
+        self.cnxn.statement_cache_size = 0
+
+        self.cnxn.auto_prepare_threshold = 0
+        self.assertEqual(self.cursor.execute("select count(*) from t1").fetchone()[0], 6)
+
+    def test_prepare(self):
+        self.cursor.execute("create table t1(n int, s varchar(10))")
+
+        insert = self.cnxn.prepare("insert into t1 values (?, ?)")
+        insert.execute(1, 'one')
+        insert.executemany([(2, 'two'), (3, 'three')])
+
+        select = self.cnxn.prepare("select s from t1 where n = ?")
+        count = self.cnxn.prepare("select count(*) from t1")
+
+        # Other cursors don't disturb the prepared statements.
+        for n, s in [(1, 'one'), (2, 'two'), (3, 'three')]:
+            cursor = self.cnxn.cursor()
+            cursor.execute("select n from t1 where s = ?", s)
+            self.assertEqual(cursor.fetchone()[0], n)
+            cursor.close()
+            self.assertEqual(select.execute(n).fetchone()[0], s)
+            self.assertEqual(count.execute().fetchone()[0], 3)
+
+        self.assertEqual(select.sql, "select s from t1 where n = ?")
+        self.assertTrue(select.execute((4,)) is select.cursor)
+        self.assertEqual(select.cursor.fetchone(), None)
+
+    def test_prepare_auto_parameterize(self):
+        "A PreparedStatement's literals are not lifted by auto_parameterize, so it isn't prepared again"
+        self.cursor.execute("create table t1(n int)")
+        self.cursor.execute("insert into t1 values (5)")
+        self.cnxn.statement_cache_size = 4
+        self.cnxn.auto_parameterize = True
+
+        select = self.cnxn.prepare("select count(*) from t1 where n = 5")
+        hits_misses = self.cnxn.statement_cache_info()[:2]
+        for i in range(3):
+            self.assertEqual(select.execute().fetchone()[0], 1)
+        self.assertEqual(self.cnxn.statement_cache_info()[:2], hits_misses)
+
+        self.cnxn.auto_parameterize = False
+        self.cnxn.statement_cache_size = 0
+
+
+    def test_pool(self):
+        "Connections are reused, reset, and waited for"
+        pool = pyodbc.Pool(self.connection_string, 1, 2, acquire_timeout=0.1)
+        self.assertEqual((pool.min, pool.max, pool.size, pool.idle), (1, 2, 1, 1))
+
+        names = ['timeout', 'auto_parameterize', 'auto_prepare_threshold', 'statement_cache_size', 'numeric_struct',
+                 'stream_chunk_size', 'statement_handle_pool_size']
+        cnxn1 = pool.acquire()
+        settings = [getattr(cnxn1, name) for name in names]
+        cnxn1.autocommit = True
+        cnxn1.timeout = 30
+        cnxn1.auto_parameterize = not cnxn1.auto_parameterize
+        cnxn1.auto_prepare_threshold = 3
+        cnxn1.statement_cache_size = 7
+        cnxn1.numeric_struct = not cnxn1.numeric_struct
+        cnxn1.stream_chunk_size = 100
+        cnxn1.statement_handle_pool_size = 5
+        cnxn1.add_output_converter(pyodbc.SQL_INTEGER, lambda value: 'converted')
+        pool.release(cnxn1)
+        self.assertEqual(pool.idle, 1)
+
+        # The same connection is returned, with its settings restored.
+        cnxn1 = pool.acquire()
+        self.assertEqual(cnxn1.autocommit, False)
+        self.assertEqual([getattr(cnxn1, name) for name in names], settings)
+        self.assertEqual(cnxn1.execute("select 1").fetchone()[0], 1)
+
+        cnxn2 = pool.acquire()
+        self.assertEqual(pool.size, 2)
+        self.assertRaises(pyodbc.OperationalError, pool.acquire)
+        self.assertEqual((pool.waits, pool.timeouts), (1, 1))
+        self.assertTrue(pool.wait_time > 0)
+
+        # Closing a checked out connection frees its place.
+        cnxn2.close()
+        self.assertEqual(pool.size, 1)
+        pool.release(cnxn2)
+        pool.release(cnxn1)
+
+        self.assertEqual((pool.checkouts, pool.created, pool.discarded), (3, 2, 1))
+        pool.close()
+        self.assertEqual(pool.size, 0)
+        self.assertRaises(pyodbc.ProgrammingError, pool.acquire)
+
+    def test_is_alive(self):
+        "is_alive checks without a query by default and with one when asked"
+        self.assertEqual(self.cnxn.alive_check_interval, 1.0)
+        self.assertEqual(self.cnxn.is_alive(), True)
+        self.assertEqual(self.cnxn.is_alive(fast=False), True)
+
+        self.cnxn.alive_check_interval = 0
+        self.assertEqual(self.cnxn.is_alive(), True)
+        self.assertRaises(ValueError, setattr, self.cnxn, "alive_check_interval", -1)
+
+        othercnxn = pyodbc.connect(self.connection_string)
+        othercnxn.close()
+        self.assertEqual(othercnxn.is_alive(), False)
 
     def test_too_large(self):
         """Ensure error raised if insert fails due to truncation"""